@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+
+/**
+Monotonic arena for the short lived objects of a statement.
+
+Allocation is a pointer bump and nothing is freed one by one, the whole arena is released
+in one step once the statement is done. The first block is kept across release(), so the
+next statement reuses the same memory instead of going back to the heap.
+The pmr containers of rows, constants and schemas take their memory from it through resource().
+*/
+class QueryArena {
+  static constexpr std::size_t INITIAL_SIZE = 64 * 1024;
+  std::unique_ptr<std::byte[]> initialBuffer;
+  std::pmr::monotonic_buffer_resource resource;
+
+public:
+  QueryArena() : initialBuffer{ std::make_unique<std::byte[]>(INITIAL_SIZE) },
+    resource{ initialBuffer.get(), INITIAL_SIZE, std::pmr::new_delete_resource() } {}
+  QueryArena(const QueryArena&) = delete;
+  QueryArena& operator=(const QueryArena&) = delete;
+
+  void* allocate(std::size_t size, std::size_t alignment) {
+    return resource.allocate(size, alignment);
+  }
+
+  std::pmr::memory_resource* getResource() {
+    return &resource;
+  }
+
+  // everything allocated from the arena is gone, the objects must already be destroyed.
+  void release() {
+    resource.release();
+  }
+};
+
+// while an ArenaScope is alive, objects that support it are allocated from its arena on this thread.
+class ArenaScope {
+  inline static thread_local QueryArena* current = nullptr;
+  QueryArena* previous;
+
+public:
+  ArenaScope(QueryArena& arena) : previous{ current } {
+    current = &arena;
+  }
+  // objects that outlive the arena, like the rows a statement returns, are allocated from the heap again.
+  ArenaScope(std::nullptr_t) : previous{ current } {
+    current = nullptr;
+  }
+  ~ArenaScope() {
+    current = previous;
+  }
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+  static QueryArena* getCurrent() {
+    return current;
+  }
+
+  // the memory resource for pmr containers, the heap outside an ArenaScope.
+  static std::pmr::memory_resource* getResource() {
+    return current ? current->getResource() : std::pmr::get_default_resource();
+  }
+};
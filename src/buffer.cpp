@@ -1,5 +1,7 @@
 
+#include <algorithm>
 #include "buffer.h"
+#include "codec.h"
 
 std::fstream& FileManager::seekFile(PageId pageId) {
   long offset = pageId.pageNumber * blockSize;
@@ -75,6 +77,31 @@ u32 FileManager::append(std::string filename, int numberOfBlocksToAppend) {
     fileStream.write(emptyBufferData.data(), emptyBufferData.size());
     numberOfBlocksToAppend--;
   }
+  fileStream.flush();
+
+  if (!fileStream) {
+    throw std::runtime_error("Error appending to file");
+  }
+
+  u32 end = std::filesystem::file_size(filename);
+
+  return end / blockSize;
+}
+
+u32 FileManager::append(std::string filename, const std::vector<char>& bufferData) {
+  if (bufferData.size() % blockSize != 0) {
+    throw std::runtime_error("Appended data is not a whole number of pages");
+  }
+  if (fileMap.find(filename) == fileMap.end()) {
+    fileMap.insert({ filename, std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary) });
+  }
+
+  auto& fileStream = fileMap.at(filename);
+
+  // Seek to the end of the file and write all pages in one go
+  fileStream.seekp(0, std::ios::end);
+  fileStream.write(bufferData.data(), bufferData.size());
+  fileStream.flush();
 
   if (!fileStream) {
     throw std::runtime_error("Error appending to file");
@@ -102,123 +129,229 @@ void FileManager::createFileIfNotExists(const std::string& fileName) {
   outfile.close();
 }
 
+void FileManager::close(const std::string& fileName) {
+  fileMap.erase(fileName);
+}
+
 bool FileManager::doesFileExists(const std::string& fileName)
 {
   return std::filesystem::exists(fileName);
 }
 
-void HeapFile::createHeapFile(ResourceManager& rm, std::string filename, const u32 newPages) {
+void HeapFile::createHeapFile(ResourceManager& rm, std::string filename, const u32 newPages, const u32 fillFactor,
+  const std::vector<u32>& paxColumns) {
   auto& fm = rm.fm;
   auto& bm = rm.bm;
 
-  // create a new heap file.
-  PageId pageId{ filename, 0 };
+  if (paxColumns.size() > TableMetadata::maxPaxColumns(fm.getBlockSize())) {
+    throw std::runtime_error("Too many columns for the PAX layout");
+  }
+  if (!paxColumns.empty()) {
+    std::vector<char> page(fm.getBlockSize());
+    PaxPage::initialize(page.data(), fm.getBlockSize(), 0, paxColumns);
+    if (reinterpret_cast<PaxPage*>(page.data())->rowCapacity == 0) {
+      throw std::runtime_error("Row is too wide for a PAX page");
+    }
+  }
+
+  // create a new heap file, page 0 is the page directory root, page 1 the table metadata,
+  // page 2 the first page directory index and page 3 the first page directory.
+  PageId rootPageId{ filename, 0 };
+  PageId metadataPageId{ filename, 1 };
+  PageId indexPageId{ filename, 2 };
+  PageId pageId{ filename, 3 };
   fm.createFileIfNotExists(pageId.filename);
-  fm.append(filename, newPages + 1);
+  fm.append(filename, newPages + 4);
+
+  PageDirectoryRoot root;
+  root.numberOfDirectories = 1;
+  root.numberOfIndexPages = 1;
+  BufferFrame* rootFrame = bm.pin(fm, rootPageId);
+  rootFrame->modify(&root, sizeof(PageDirectoryRoot), 0);
+  rootFrame->modify(&indexPageId.pageNumber, sizeof(u64), sizeof(PageDirectoryRoot));
+  bm.unpin(fm, rootPageId);
+
+  TableMetadata metadata{ fillFactor, (u32)paxColumns.size() };
+  BufferFrame* metadataFrame = bm.pin(fm, metadataPageId);
+  metadataFrame->modify(&metadata, sizeof(TableMetadata), 0);
+  if (!paxColumns.empty()) {
+    metadataFrame->modify(paxColumns.data(), sizeof(u32) * paxColumns.size(), sizeof(TableMetadata));
+  }
+  bm.unpin(fm, metadataPageId);
 
-  // Add page directory header to the page directory
-  BufferFrame* bf = bm.pin(fm, pageId);
-  PageDirectory pd{ u64Max, u64Max, newPages };
-  std::strncpy(pd.tableName, filename.c_str(), 128);
+  PageDirectoryIndex pdi;
+  pdi.numberOfDirectories = 1;
+  BufferFrame* indexFrame = bm.pin(fm, indexPageId);
+  indexFrame->modify(&pdi, sizeof(PageDirectoryIndex), 0);
+  indexFrame->modify(&pageId.pageNumber, sizeof(u64), sizeof(PageDirectoryIndex));
+  bm.unpin(fm, indexPageId);
 
-  // Add page entries to the page directory
+  // Add tuple header for each page and its page entry
   std::vector<PageEntry> pe;
-  for (u64 i = 1; i <= newPages; ++i) {
-    u32 freeSpace = fm.getBlockSize() - ((u32)sizeof(TuplePage));
-    pe.push_back(PageEntry{ i, freeSpace });
+  for (u64 i = 0; i < newPages; ++i) {
+    PageId tuplePageId{ filename, i + 4 };
+    BufferFrame* tuplePageBuffer = bm.pin(fm, tuplePageId);
+    u32 freeSpace = initializeHeapPage(tuplePageBuffer, (u32)i, paxColumns);
+    bm.unpin(fm, tuplePageId);
+    pe.push_back(PageEntry{ i + 4, freeSpace });
   }
 
-  // flush into page directory
+  // Add page directory header and page entries to the page directory
+  BufferFrame* bf = bm.pin(fm, pageId);
+  PageDirectory pd{ 0, newPages };
   bf->modify(&pd, sizeof(PageDirectory), 0);
-  bf->modify(pe.data(), sizeof(PageEntry) * pe.size(), sizeof(PageDirectory));
+  // a file made for a bulk load starts without pages, pe.data() may be null then
+  if (!pe.empty()) {
+    bf->modify(pe.data(), sizeof(PageEntry) * pe.size(), sizeof(PageDirectory));
+  }
   bm.unpin(fm, pageId);
+}
 
+static u32 paxRowWidth(const std::vector<u32>& paxColumns) {
+  u32 rowWidth = 0;
+  for (u32 width : paxColumns) {
+    rowWidth += width;
+  }
+  return rowWidth;
+}
 
-  // Add tuple header for each page 
-  TuplePage tp{ 0, fm.getBlockSize(), 0, fm.getBlockSize() };
-  for (u64 i = 1; i <= newPages; ++i) {
-    PageId tuplePageId{ filename, i };
-    BufferFrame* tuplePageBuffer = bm.pin(fm, tuplePageId);
-    tuplePageBuffer->modify(&tp, sizeof(TuplePage), 0);
-    bm.unpin(fm, tuplePageId);
+u32 HeapFile::initializeHeapPage(BufferFrame* frame, u32 pageIndex, const std::vector<u32>& paxColumns) {
+  u32 pageSize = (u32)frame->bufferSize;
+  frame->dirty = true;
+  if (paxColumns.empty()) {
+    TuplePage tp{ 0, pageSize, 0, pageSize, pageIndex };
+    std::memcpy(frame->bufferData.data(), &tp, sizeof(TuplePage));
+    return pageSize - TuplePage::headerSize(pageSize);
   }
+
+  // the free space of a PAX page is the space of its free rows
+  PaxPage::initialize(frame->bufferData.data(), pageSize, pageIndex, paxColumns);
+  return reinterpret_cast<PaxPage*>(frame->bufferData.data())->rowCapacity * paxRowWidth(paxColumns);
 }
 
-PageId HeapFile::appendHeapFilePageDirectory(ResourceManager& rm, std::string filename) {
-  auto& fm = rm.fm;
-  auto& bm = rm.bm;
+std::vector<u32> HeapFile::getPaxColumns(ResourceManager& rm, const std::string& filename) {
+  PageId metadataPageId{ filename, 1 };
+  BufferFrame* metadataFrame = rm.bm.pin(rm.fm, metadataPageId);
+  TableMetadata* metadata = reinterpret_cast<TableMetadata*>(metadataFrame->bufferData.data());
+  std::vector<u32> paxColumns(metadata->paxColumnWidths(), metadata->paxColumnWidths() + metadata->numberOfPaxColumns);
+  rm.bm.unpin(rm.fm, metadataPageId);
+  return paxColumns;
+}
+
+std::vector<u32> HeapFile::paxColumnsOf(Schema& schema) {
+  std::vector<u32> paxColumns;
+  for (auto& fieldName : schema.fieldList) {
+    u32 width = schema.fieldMap.at(fieldName)->getFixedWidth();
+    if (width == 0) {
+      return {};
+    }
+    paxColumns.push_back(width);
+  }
+  return paxColumns;
+}
 
-  // create a new heap file.
-  PageId currentPageId{ filename, 0 };
+u32 HeapFile::getFillFactor(ResourceManager& rm, const std::string& filename) {
+  PageId metadataPageId{ filename, 1 };
+  BufferFrame* metadataFrame = rm.bm.pin(rm.fm, metadataPageId);
+  u32 fillFactor = reinterpret_cast<TableMetadata*>(metadataFrame->bufferData.data())->fillFactor;
+  rm.bm.unpin(rm.fm, metadataPageId);
+  return fillFactor;
+}
 
-  // Add page directory header to the page directory
-  BufferFrame* bf = bm.pin(fm, currentPageId);
-  PageDirectory* pd = (PageDirectory*)bf->bufferData.data();
-  while (pd->nextPage != u64Max) {// Find the last page directory
-    u64 nextPageIdPageNum = pd->nextPage;
-    PageId nextPageId{ filename, nextPageIdPageNum };
-    bm.unpin(fm, currentPageId);
+u32 HeapFile::reservedSpace(u32 pageSize, u32 fillFactor) {
+  return (pageSize - TuplePage::headerSize(pageSize)) * (100 - fillFactor) / 100;
+}
 
-    currentPageId = nextPageId;
-    bf = bm.pin(fm, currentPageId);
-    pd = (PageDirectory*)bf->bufferData.data();
+u64 HeapFile::getPageDirectory(ResourceManager& rm, const std::string& filename, u64 directoryIndex) {
+  PageId rootPageId{ filename, 0 };
+  BufferFrame* rootFrame = rm.bm.pin(rm.fm, rootPageId);
+  PageDirectoryRoot* root = reinterpret_cast<PageDirectoryRoot*>(rootFrame->bufferData.data());
+  if (directoryIndex >= root->numberOfDirectories) {
+    rm.bm.unpin(rm.fm, rootPageId);
+    return u64Max;
   }
+  u64 indexCapacity = PageDirectoryIndex::capacity(rm.fm.getBlockSize());
+  PageId indexPageId{ filename, root->indexPages()[directoryIndex / indexCapacity] };
+  rm.bm.unpin(rm.fm, rootPageId);
+
+  BufferFrame* indexFrame = rm.bm.pin(rm.fm, indexPageId);
+  u64 directoryPageNumber = reinterpret_cast<PageDirectoryIndex*>(indexFrame->bufferData.data())->directories()[directoryIndex % indexCapacity];
+  rm.bm.unpin(rm.fm, indexPageId);
+  return directoryPageNumber;
+}
 
-  // previous last page directory
-  // set next pointer to the new page id created.
-  u32 lastPageNumber = fm.append(currentPageId.filename) - 1;
-  pd->nextPage = lastPageNumber;
-  bf->modify(&pd, sizeof(PageDirectory), 0);
-  bm.unpin(fm, currentPageId);
+u64 HeapFile::numberOfPageDirectories(ResourceManager& rm, const std::string& filename) {
+  PageId rootPageId{ filename, 0 };
+  BufferFrame* rootFrame = rm.bm.pin(rm.fm, rootPageId);
+  u64 numberOfDirectories = reinterpret_cast<PageDirectoryRoot*>(rootFrame->bufferData.data())->numberOfDirectories;
+  rm.bm.unpin(rm.fm, rootPageId);
+  return numberOfDirectories;
+}
+
+u64 HeapFile::addPageDirectory(ResourceManager& rm, const std::string& filename, u64 directoryPageNumber) {
+  auto& fm = rm.fm;
+  auto& bm = rm.bm;
+  PageId rootPageId{ filename, 0 };
+  BufferFrame* rootFrame = bm.pin(fm, rootPageId);
+  PageDirectoryRoot* root = reinterpret_cast<PageDirectoryRoot*>(rootFrame->bufferData.data());
+  u64 directoryIndex = root->numberOfDirectories;
+  u64 indexCapacity = PageDirectoryIndex::capacity(fm.getBlockSize());
+
+  // the last page directory index is full, start a new one at the end of the file
+  if (directoryIndex / indexCapacity >= root->numberOfIndexPages) {
+    if (root->numberOfIndexPages >= PageDirectoryRoot::capacity(fm.getBlockSize())) {
+      bm.unpin(fm, rootPageId);
+      throw std::runtime_error("Page directory root is full");
+    }
+    PageId newIndexPageId{ filename, fm.append(filename) - 1 };
+    PageDirectoryIndex pdi;
+    BufferFrame* newIndexFrame = bm.pin(fm, newIndexPageId);
+    newIndexFrame->modify(&pdi, sizeof(PageDirectoryIndex), 0);
+    bm.unpin(fm, newIndexPageId);
+    root->indexPages()[root->numberOfIndexPages] = newIndexPageId.pageNumber;
+    root->numberOfIndexPages += 1;
+  }
+
+  PageId indexPageId{ filename, root->indexPages()[directoryIndex / indexCapacity] };
+  BufferFrame* indexFrame = bm.pin(fm, indexPageId);
+  PageDirectoryIndex* pdi = reinterpret_cast<PageDirectoryIndex*>(indexFrame->bufferData.data());
+  pdi->directories()[directoryIndex % indexCapacity] = directoryPageNumber;
+  pdi->numberOfDirectories += 1;
+  indexFrame->dirty = true;
+  bm.unpin(fm, indexPageId);
+
+  root->numberOfDirectories += 1;
+  rootFrame->dirty = true;
+  bm.unpin(fm, rootPageId);
+  return directoryIndex;
+}
 
-  // create a new page directory
-  PageDirectory newPd{ currentPageId.pageNumber, u64Max, 0 };
-  std::strncpy(newPd.tableName, filename.c_str(), 128);
-  BufferFrame* newFrame = bm.pin(fm, currentPageId);
+PageId HeapFile::appendHeapFilePageDirectory(ResourceManager& rm, std::string filename) {
+  auto& fm = rm.fm;
+  auto& bm = rm.bm;
+
+  // the new page directory goes to the end of the file and the end of the page directory index
+  u32 lastPageNumber = fm.append(filename) - 1;
+  PageId newPageId{ filename, lastPageNumber };
+  PageDirectory newPd{ addPageDirectory(rm, filename, lastPageNumber), 0 };
+  BufferFrame* newFrame = bm.pin(fm, newPageId);
   newFrame->modify(&newPd, sizeof(PageDirectory), 0);
-  bm.unpin(fm, currentPageId);
+  bm.unpin(fm, newPageId);
 
-  return PageId{ filename, lastPageNumber };
+  return newPageId;
 }
 
 PageId HeapFile::appendNewHeapPage(ResourceManager& rm, std::string filename) {
   auto& fm = rm.fm;
   auto& bm = rm.bm;
 
-  // create a new heap file.
-  PageId currentPageId{ filename, 0 };
-
-  // Add page directory header to the page directory
+  // only the last page directory can have space for a page entry
+  u64 directoryIndex = numberOfPageDirectories(rm, filename) - 1;
+  PageId currentPageId{ filename, getPageDirectory(rm, filename, directoryIndex) };
   BufferFrame* bf = bm.pin(fm, currentPageId);
   PageDirectory* pd = (PageDirectory*)bf->bufferData.data();
-  bool shouldCreateNewHeapDir = false;
-  while (true) {
-    u64 numEntries = pd->numberOfEntries;
-    u32 blockSize = fm.getBlockSize();
-    u32 remainingSize = blockSize - sizeof(PageDirectory) - (numEntries * sizeof(PageEntry));
-
-    // current page directory has enough space for page entry
-    if (sizeof(PageEntry) <= remainingSize) {
-      break;
-    }
-    // need a new page directory since all current directories do not have enough space.
-    else if (pd->nextPage == u64Max) {
-      shouldCreateNewHeapDir = true;
-      break;
-    }
-    // go to next page directory
-    else {
-      u64 nextPageIdPageNum = pd->nextPage;
-      PageId nextPageId{ filename, nextPageIdPageNum };
-      bm.unpin(fm, currentPageId);
-
-      currentPageId = nextPageId;
-      bf = bm.pin(fm, currentPageId);
-      pd = (PageDirectory*)bf->bufferData.data();
-    }
-  };
-
-  if (shouldCreateNewHeapDir) {
+  u32 blockSize = fm.getBlockSize();
+  if (pd->numberOfEntries >= PageDirectory::entriesPerDirectory(blockSize)) {
     PageId newPageId = appendHeapFilePageDirectory(rm, filename);
     bm.unpin(fm, currentPageId);
     currentPageId = newPageId;
@@ -228,147 +361,961 @@ PageId HeapFile::appendNewHeapPage(ResourceManager& rm, std::string filename) {
 
   u32 lastPageNumber = fm.append(currentPageId.filename) - 1;
 
+  // Add tuple header to page
+  PageId tuplePageId{ filename, lastPageNumber };
+  u32 pageIndex = pd->directoryIndex * PageDirectory::entriesPerDirectory(blockSize) + pd->numberOfEntries;
+  BufferFrame* tuplePageBuffer = bm.pin(fm, tuplePageId);
+  u32 freeSpace = initializeHeapPage(tuplePageBuffer, pageIndex, getPaxColumns(rm, filename));
+  bm.unpin(fm, tuplePageId);
+
   // Add page entry to the page directory
-  u32 freeSpace = fm.getBlockSize() - ((u32)sizeof(TuplePage));
   PageEntry newPageEntry{ lastPageNumber, freeSpace };
   u32 offset = sizeof(PageDirectory) + pd->numberOfEntries * sizeof(PageEntry);
   pd->numberOfEntries++;
   bf->modify(&newPageEntry, sizeof(PageEntry), offset);
   bm.unpin(fm, currentPageId);
 
-  // Add tuple header to page
-  PageId tuplePageId{ filename, lastPageNumber };
-  TuplePage tp{ 0, fm.getBlockSize(), 0, fm.getBlockSize() };
-  BufferFrame* tuplePageBuffer = bm.pin(fm, PageId{ filename, lastPageNumber });
-  tuplePageBuffer->modify(&tp, sizeof(TuplePage), 0);
-  bm.unpin(fm, tuplePageId);
-
   return tuplePageId;
 }
 
-void HeapFile::insertTuples(HeapFile::HeapFileIterator& iter, std::vector<Tuple>& tuples) {
-  std::sort(begin(tuples), end(tuples), [](auto& lhs, auto& rhs) {
-    return lhs.recordSize < rhs.recordSize;
-    });
+void HeapFile::replaceHeapFile(ResourceManager& rm, const std::string& filename, const std::string& newFilename) {
+  auto& fm = rm.fm;
+  auto& bm = rm.bm;
 
-  for (auto& tuple : tuples) {
-    iter.traverseFromStartTilFindSpace(tuple.recordSize);
-    // Decrease page entry free space size
-    BufferFrame* directoryFrame = iter.getPageDirBuffer();
-    PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(directoryFrame->bufferData.data() + sizeof(PageDirectory));
-    pageEntryList[iter.getPageEntryIndex()].freeSpace -= tuple.recordSize;
-    directoryFrame->dirty = true;
-
-    // Get the tuple page headers.
-    BufferFrame* tupleFrame = iter.getPageBuffer();
-    TuplePage* pe = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
-    Slot* slot = reinterpret_cast<Slot*>(tupleFrame->bufferData.data() + sizeof(TuplePage));
-    u32 numberOfSlots = pe->numberOfSlots;
-
-    // find an empty slot
-    u32 emptySlotIdx = u32Max;
-    for (u32 i = 0; i < numberOfSlots; ++i) {
-      if (!slot[i].isOccupied()) {
-        emptySlotIdx = i;
-        break;
-      }
-    }
+  // the new file must be complete on disk before it is swapped in
+  bm.flush(fm, newFilename);
+  bm.discard(newFilename);
+  bm.discard(filename);
+  fm.close(newFilename);
+  fm.close(filename);
+
+  std::filesystem::rename(newFilename, filename);
+  rm.invalidateInsertHint(filename);
+  rm.invalidateInsertHint(newFilename);
+
+  // the overflow values of the new file replace the old ones
+  std::string overflowFile = overflowFilename(filename);
+  std::string newOverflowFile = overflowFilename(newFilename);
+  bm.flush(fm, newOverflowFile);
+  bm.discard(newOverflowFile);
+  bm.discard(overflowFile);
+  fm.close(newOverflowFile);
+  fm.close(overflowFile);
+  if (fm.doesFileExists(newOverflowFile)) {
+    std::filesystem::rename(newOverflowFile, overflowFile);
+  }
+  else if (fm.doesFileExists(overflowFile)) {
+    std::filesystem::remove(overflowFile);
+  }
 
-    if (emptySlotIdx == u32Max) {
-      emptySlotIdx = numberOfSlots;
-      pe->numberOfSlots += 1;
-      pageEntryList[iter.getPageEntryIndex()].freeSpace -= sizeof(Slot);
+  // so do the dictionary values, the rows of the new file hold codes of its own dictionary
+  std::string dictionaryFile = dictionaryFilename(filename);
+  std::string newDictionaryFile = dictionaryFilename(newFilename);
+  bm.flush(fm, newDictionaryFile);
+  bm.discard(newDictionaryFile);
+  bm.discard(dictionaryFile);
+  fm.close(newDictionaryFile);
+  fm.close(dictionaryFile);
+  rm.dictionaries.erase(filename);
+  rm.dictionaries.erase(newFilename);
+  if (fm.doesFileExists(newDictionaryFile)) {
+    std::filesystem::rename(newDictionaryFile, dictionaryFile);
+  }
+  else if (fm.doesFileExists(dictionaryFile)) {
+    std::filesystem::remove(dictionaryFile);
+  }
+}
+
+void HeapFile::truncateHeapFile(ResourceManager& rm, const std::string& filename) {
+  auto& fm = rm.fm;
+  auto& bm = rm.bm;
+  u32 fillFactor = getFillFactor(rm, filename);
+  std::vector<u32> paxColumns = getPaxColumns(rm, filename);
+
+  bm.discard(filename);
+  fm.close(filename);
+  std::filesystem::resize_file(filename, 0);
+  createHeapFile(rm, filename, 8, fillFactor, paxColumns);
+  rm.invalidateInsertHint(filename);
+
+  for (auto& sideFile : { overflowFilename(filename), dictionaryFilename(filename) }) {
+    bm.discard(sideFile);
+    fm.close(sideFile);
+    if (fm.doesFileExists(sideFile)) {
+      std::filesystem::remove(sideFile);
     }
+  }
+  rm.dictionaries.erase(filename);
+}
 
-    // Set current slot to be occupied
-    auto& currSlot = slot[emptySlotIdx];
-    u32 offset = pe->lastOccupiedPosition - tuple.recordSize;
-    pe->lastOccupiedPosition -= tuple.recordSize;
-    currSlot.setOccupied(true);
-    currSlot.setOffset(offset);
+u32 HeapFile::compactTuplePage(BufferFrame* tupleFrame) {
+  TuplePage* tp = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
+  Slot* slot = tp->slots();
+
+  // Live slots ordered from the end of the page to the start
+  std::vector<u32> liveSlots;
+  liveSlots.reserve(tp->numberOfOccupiedSlots());
+  for (u32 i = tp->nextOccupiedSlot(0); i < tp->numberOfSlots; i = tp->nextOccupiedSlot(i + 1)) {
+    // forwarding slots have no data on this page
+    if (!slot[i].isForwarded()) {
+      liveSlots.push_back(i);
+    }
+  }
+  std::sort(begin(liveSlots), end(liveSlots), [&slot](u32 lhs, u32 rhs) {
+    return slot[lhs].getOffset() > slot[rhs].getOffset();
+    });
 
-    // Write the tuple to the buffer
-    for (auto& field : tuple.fields) {
-      field->write(tupleFrame->bufferData.data(), offset);
-      offset += field->getLength();
+  // Tuples only ever move towards the end of the page, so they can be moved in place
+  u32 position = tp->pageSize;
+  for (u32 slotIdx : liveSlots) {
+    auto& currSlot = slot[slotIdx];
+    position -= currSlot.getLength();
+    if (position != currSlot.getOffset()) {
+      std::memmove(tupleFrame->bufferData.data() + position, tupleFrame->bufferData.data() + currSlot.getOffset(), currSlot.getLength());
+      currSlot.setOffset(position);
     }
-    tupleFrame->dirty = true;
   }
+  tp->lastOccupiedPosition = position;
+  tupleFrame->dirty = true;
+
+  return tp->contiguousFreeSpace();
 }
 
-void HeapFile::insertTuples(std::shared_ptr<ResourceManager>& rm, const std::string& filename, std::vector<Tuple>& tuples) {
-  HeapFile::HeapFileIterator iter(filename, rm);
-  iter.findFirstDir();
-  insertTuples(iter, tuples);
+std::string HeapFile::overflowFilename(const std::string& filename) {
+  return filename + ".overflow";
 }
 
+u64 HeapFile::writeOverflow(ResourceManager& rm, const std::string& filename, const std::string& value) {
+  auto& fm = rm.fm;
+  auto& bm = rm.bm;
+  std::string overflowFile = overflowFilename(filename);
+  fm.createFileIfNotExists(overflowFile);
+  const u32 blockSize = fm.getBlockSize();
+  if (fm.getNumberOfPages(overflowFile) == 0) {
+    std::vector<char> headerPage(blockSize, 0);
+    OverflowFileHeader header;
+    std::memcpy(headerPage.data(), &header, sizeof(OverflowFileHeader));
+    fm.append(overflowFile, headerPage);
+  }
 
+  const u32 dataPerPage = blockSize - sizeof(OverflowPage);
+  u32 numberOfPages = std::max<u32>(1, (value.size() + dataPerPage - 1) / dataPerPage);
+
+  // take the free pages first
+  std::vector<u64> pageNumbers;
+  PageId headerId{ overflowFile, 0 };
+  BufferFrame* headerFrame = bm.pin(fm, headerId);
+  OverflowFileHeader* header = reinterpret_cast<OverflowFileHeader*>(headerFrame->bufferData.data());
+  while (pageNumbers.size() < numberOfPages && header->freePageHead != u64Max) {
+    PageId freeId{ overflowFile, header->freePageHead };
+    BufferFrame* freeFrame = bm.pin(fm, freeId);
+    pageNumbers.push_back(freeId.pageNumber);
+    header->freePageHead = reinterpret_cast<OverflowPage*>(freeFrame->bufferData.data())->nextPage;
+    bm.unpin(fm, freeId);
+    headerFrame->dirty = true;
+  }
+  bm.unpin(fm, headerId);
+  u32 numberOfReusedPages = (u32)pageNumbers.size();
+  u64 firstAppendedPage = fm.getNumberOfPages(overflowFile);
+  for (u32 i = numberOfReusedPages; i < numberOfPages; ++i) {
+    pageNumbers.push_back(firstAppendedPage + i - numberOfReusedPages);
+  }
 
-void HeapFile::insertTuple(ResourceManager& rm, const std::string& filename, Tuple& tuple) {
+  // the appended pages of the chain are written together, the reused ones through the buffer pool
+  std::vector<char> pages((numberOfPages - numberOfReusedPages) * blockSize, 0);
+  std::vector<char> reusedPage(blockSize);
+  for (u32 i = 0; i < numberOfPages; ++i) {
+    u32 dataOffset = i * dataPerPage;
+    u32 dataLength = std::min<u32>(dataPerPage, value.size() - dataOffset);
+    u64 nextPage = i + 1 < numberOfPages ? pageNumbers[i + 1] : u64Max;
+
+    char* page = i < numberOfReusedPages ? reusedPage.data() : pages.data() + (i - numberOfReusedPages) * blockSize;
+    std::fill(page, page + blockSize, 0);
+    OverflowPage pageHeader{ nextPage, dataLength };
+    std::memcpy(page, &pageHeader, sizeof(OverflowPage));
+    std::memcpy(page + sizeof(OverflowPage), value.data() + dataOffset, dataLength);
+    if (i < numberOfReusedPages) {
+      PageId pageId{ overflowFile, pageNumbers[i] };
+      BufferFrame* bf = bm.pin(fm, pageId);
+      bf->modify(page, blockSize, 0);
+      bm.unpin(fm, pageId);
+    }
+  }
+  if (!pages.empty()) {
+    fm.append(overflowFile, pages);
+  }
+
+  return pageNumbers[0];
+}
+
+void HeapFile::freeOverflow(ResourceManager& rm, const std::string& filename, u64 firstPage) {
   auto& fm = rm.fm;
   auto& bm = rm.bm;
+  std::string overflowFile = overflowFilename(filename);
 
-  PageId pageId{ filename, 0 };
+  // the whole chain goes to the front of the free pages, its last page links to the old front
+  PageId pageId{ overflowFile, firstPage };
   BufferFrame* bf = bm.pin(fm, pageId);
+  while (reinterpret_cast<OverflowPage*>(bf->bufferData.data())->nextPage != u64Max) {
+    u64 nextPage = reinterpret_cast<OverflowPage*>(bf->bufferData.data())->nextPage;
+    bm.unpin(fm, pageId);
+    pageId.pageNumber = nextPage;
+    bf = bm.pin(fm, pageId);
+  }
 
-  PageDirectory* pd = (PageDirectory*)bf->bufferData.data();
-  u64 numberOfEntries = pd->numberOfEntries;
-
-  // Choose a page that has sufficient space.
-  u64 pageNumberChosen = -1;
-  const PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(bf->bufferData.data() + sizeof(PageDirectory));
-  for (int i = 0; i < numberOfEntries; ++i)
-  {
-    auto& pageEntry = pageEntryList[i];
-    // if the page has enough space for the tuple
-    if (pageEntry.freeSpace >= tuple.recordSize + sizeof(Slot))
-    {
-      pageNumberChosen = pageEntry.pageNumber;
-      break;
+  PageId headerId{ overflowFile, 0 };
+  BufferFrame* headerFrame = bm.pin(fm, headerId);
+  OverflowFileHeader* header = reinterpret_cast<OverflowFileHeader*>(headerFrame->bufferData.data());
+  reinterpret_cast<OverflowPage*>(bf->bufferData.data())->nextPage = header->freePageHead;
+  bf->dirty = true;
+  header->freePageHead = firstPage;
+  headerFrame->dirty = true;
+  bm.unpin(fm, headerId);
+  bm.unpin(fm, pageId);
+}
+
+std::string HeapFile::readOverflow(ResourceManager& rm, const std::string& filename, u64 firstPage, u32 valueLength) {
+  auto& fm = rm.fm;
+  auto& bm = rm.bm;
+
+  std::string value;
+  value.reserve(valueLength);
+  PageId pageId{ overflowFilename(filename), firstPage };
+  while (pageId.pageNumber != u64Max && value.size() < valueLength) {
+    BufferFrame* bf = bm.pin(fm, pageId);
+    if (!bf) {
+      throw std::runtime_error("Overflow page does not exist");
+    }
+    const OverflowPage* op = reinterpret_cast<OverflowPage*>(bf->bufferData.data());
+    value.append(bf->bufferData.data() + sizeof(OverflowPage), op->dataLength);
+    u64 nextPage = op->nextPage;
+    bm.unpin(fm, pageId);
+    pageId.pageNumber = nextPage;
+  }
+
+  if (value.size() != valueLength) {
+    throw std::runtime_error("Overflow chain is shorter than its value");
+  }
+  return value;
+}
+
+std::string HeapFile::dictionaryFilename(const std::string& filename) {
+  return filename + ".dict";
+}
+
+std::shared_ptr<Dictionary> HeapFile::getDictionary(ResourceManager& rm, const std::string& filename) {
+  auto cached = rm.dictionaries.find(filename);
+  if (cached != rm.dictionaries.end()) {
+    return cached->second;
+  }
+
+  auto dictionary = std::make_shared<Dictionary>();
+  std::string dictionaryFile = dictionaryFilename(filename);
+  if (rm.fm.doesFileExists(dictionaryFile)) {
+    u32 numberOfPages = rm.fm.getNumberOfPages(dictionaryFile);
+    for (u64 pageNumber = 0; pageNumber < numberOfPages; ++pageNumber) {
+      PageId pageId{ dictionaryFile, pageNumber };
+      BufferFrame* bf = rm.bm.pin(rm.fm, pageId);
+      const DictionaryPage* dp = reinterpret_cast<DictionaryPage*>(bf->bufferData.data());
+      u32 offset = sizeof(DictionaryPage);
+      for (u32 i = 0; i < dp->numberOfEntries; ++i) {
+        u16 length;
+        std::memcpy(&length, bf->bufferData.data() + offset, sizeof(u16));
+        dictionary->add(std::string(bf->bufferData.data() + offset + sizeof(u16), length));
+        offset += sizeof(u16) + length;
+      }
+      rm.bm.unpin(rm.fm, pageId);
+    }
+  }
+  rm.dictionaries[filename] = dictionary;
+  return dictionary;
+}
+
+// add the value to the dictionary and append it to the last page of the dictionary file.
+static u32 addDictionaryValue(ResourceManager& rm, const std::string& filename, Dictionary& dictionary, const std::string& value) {
+  auto& fm = rm.fm;
+  const u32 blockSize = fm.getBlockSize();
+  u32 entrySize = sizeof(u16) + (u32)value.size();
+  if (sizeof(DictionaryPage) + entrySize > blockSize) {
+    throw std::runtime_error("Dictionary value is too large");
+  }
+  u32 code = dictionary.add(value);
+
+  std::string dictionaryFile = HeapFile::dictionaryFilename(filename);
+  fm.createFileIfNotExists(dictionaryFile);
+  u32 numberOfPages = fm.getNumberOfPages(dictionaryFile);
+  PageId pageId{ dictionaryFile, numberOfPages == 0 ? 0 : numberOfPages - 1u };
+  BufferFrame* bf = numberOfPages == 0 ? nullptr : rm.bm.pin(fm, pageId);
+  if (!bf || reinterpret_cast<DictionaryPage*>(bf->bufferData.data())->usedSize + entrySize > blockSize) {
+    if (bf) {
+      rm.bm.unpin(fm, pageId);
+    }
+    pageId.pageNumber = fm.append(dictionaryFile) - 1;
+    bf = rm.bm.pin(fm, pageId);
+    DictionaryPage header;
+    bf->modify(&header, sizeof(DictionaryPage), 0);
+  }
+
+  DictionaryPage* dp = reinterpret_cast<DictionaryPage*>(bf->bufferData.data());
+  u16 length = (u16)value.size();
+  bf->modify(&length, sizeof(u16), dp->usedSize);
+  bf->modify(value.data(), value.size(), dp->usedSize + sizeof(u16));
+  dp->usedSize += entrySize;
+  dp->numberOfEntries += 1;
+  rm.bm.unpin(fm, pageId);
+  return code;
+}
+
+void HeapFile::encodeDictionaryFields(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Tuple& tuple) {
+  std::shared_ptr<Dictionary> dictionary;
+  for (auto& field : tuple.fields) {
+    auto dictField = dynamic_cast<DictField*>(field.get());
+    if (!dictField) {
+      continue;
+    }
+    if (!dictionary) {
+      dictionary = getDictionary(*rm, filename);
+    }
+    // values read from another table, e.g. rows copied by VACUUM, carry codes of its dictionary
+    if (dictField->getDictionary() != dictionary.get()) {
+      u32 code = dictionary->find(dictField->getString());
+      if (code == Dictionary::NO_CODE) {
+        code = addDictionaryValue(*rm, filename, *dictionary, dictField->getString());
+      }
+      dictField->setCode(code, dictionary);
+    }
+  }
+}
+
+void HeapFile::moveLargeFieldsOutOfLine(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Tuple& tuple) {
+  const u32 blockSize = rm->fm.getBlockSize();
+  const u32 capacity = blockSize - TuplePage::headerSize(blockSize) - sizeof(Slot);
+  const u32 largeValueSize = capacity / 4;
+  std::shared_ptr<HeapFileSource> source;
+
+  auto moveOutOfLine = [&](u32 idx, std::string value) {
+    if (!source) {
+      source = std::make_shared<HeapFileSource>(HeapFileSource{ rm, filename });
     }
+    u64 firstPage = writeOverflow(*rm, filename, value);
+    tuple.set(idx, std::make_unique<OverflowVarCharField>(source, firstPage, std::move(value)));
   };
 
-  if (pageNumberChosen == -1)
-  {
-    // if no space for tuple
-    PageId newPage = appendNewHeapPage(rm, filename);
-    pageNumberChosen = newPage.pageNumber;
+  // Overflow values of another heap file, e.g. rows copied by VACUUM, are written again below
+  for (u32 i = 0; i < tuple.fields.size(); ++i) {
+    auto overflowField = dynamic_cast<OverflowVarCharField*>(tuple.fields[i].get());
+    if (overflowField && overflowField->getFilename() != filename) {
+      tuple.set(i, std::make_unique<VarCharField>(overflowField->getString()));
+    }
   }
 
-  bm.unpin(fm, pageId);
+  for (u32 i = 0; i < tuple.fields.size(); ++i) {
+    auto varCharField = dynamic_cast<VarCharField*>(tuple.fields[i].get());
+    if (varCharField && varCharField->getLength() > largeValueSize && varCharField->getLength() > VARCHAR_OVERFLOW_SIZE) {
+      moveOutOfLine(i, varCharField->getString());
+    }
+  }
 
-  // Get the headers
-  PageId tuplePageId{ filename, pageNumberChosen };
-  BufferFrame* tupleFrame = bm.pin(fm, tuplePageId);
-  TuplePage* pe = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
-  Slot* slot = reinterpret_cast<Slot*>(tupleFrame->bufferData.data() + sizeof(TuplePage));
-  u32 numberOfSlots = pe->numberOfSlots;
+  // Then the largest remaining values until the tuple fits
+  while (tuple.recordSize > capacity) {
+    u32 largestIdx = u32Max;
+    u32 largestSize = VARCHAR_OVERFLOW_SIZE;
+    for (u32 i = 0; i < tuple.fields.size(); ++i) {
+      auto varCharField = dynamic_cast<VarCharField*>(tuple.fields[i].get());
+      if (varCharField && varCharField->getLength() > largestSize) {
+        largestIdx = i;
+        largestSize = varCharField->getLength();
+      }
+    }
+    if (largestIdx == u32Max) {
+      throw std::runtime_error("Tuple is too large to fit in a page");
+    }
+    moveOutOfLine(largestIdx, dynamic_cast<VarCharField*>(tuple.fields[largestIdx].get())->getString());
+  }
+}
 
-  u32 emptySlotIdx = u32Max;
-  for (u32 i = 0; i < numberOfSlots; ++i) {
-    if (!slot[i].isOccupied()) {
-      emptySlotIdx = i;
-      break;
+static void checkPaxRow(const std::vector<u32>& paxColumns, Tuple& tuple) {
+  if (tuple.fields.size() != paxColumns.size()) {
+    throw std::runtime_error("Row does not match the PAX columns of the table");
+  }
+  for (u32 i = 0; i < paxColumns.size(); ++i) {
+    if (tuple.fields[i]->getLength() != paxColumns[i]) {
+      throw std::runtime_error("Row does not match the PAX columns of the table");
     }
   }
+}
 
-  if (emptySlotIdx == u32Max) {
-    emptySlotIdx = numberOfSlots;
-    pe->numberOfSlots += 1;
+// write the columns of the row to their minipages.
+static void writePaxRow(PaxPage* pp, u32 row, Tuple& tuple) {
+  for (u32 i = 0; i < pp->numberOfColumns; ++i) {
+    tuple.fields[i]->write(pp->value(i, row), 0);
   }
+}
+
+// rows of a PAX page all have the same width, the fill factor does not apply.
+static RID insertPaxRow(HeapFile::HeapFileIterator& iter, Tuple& tuple) {
+  checkPaxRow(iter.getPaxColumns(), tuple);
+  u32 rowWidth = paxRowWidth(iter.getPaxColumns());
+  u32 startEntryIndex = iter.getPageEntryIndex() == u32Max ? 0 : iter.getPageEntryIndex();
+  iter.traverseFromStartTilFindSpace(rowWidth, startEntryIndex);
+
+  BufferFrame* tupleFrame = iter.getPageBuffer();
+  PaxPage* pp = reinterpret_cast<PaxPage*>(tupleFrame->bufferData.data());
+  u32 row = pp->allocateRow();
+  writePaxRow(pp, row, tuple);
+  tupleFrame->dirty = true;
+
+  BufferFrame* directoryFrame = iter.getPageDirBuffer();
+  reinterpret_cast<PageEntry*>(directoryFrame->bufferData.data() + sizeof(PageDirectory))[iter.getPageEntryIndex()].freeSpace -= rowWidth;
+  directoryFrame->dirty = true;
 
-  // Set current slot to be occupied
-  auto& currSlot = slot[emptySlotIdx];
+  return RID{ tupleFrame->pageId.pageNumber, row };
+}
+
+RID HeapFile::insertTuple(HeapFile::HeapFileIterator& iter, Tuple& tuple, RowCodec* codec) {
+  if (!codec) {
+    encodeDictionaryFields(iter.getResourceManager(), iter.getFilename(), tuple);
+  }
+  if (iter.isPax()) {
+    return insertPaxRow(iter, tuple);
+  }
+  if (!codec) {
+    moveLargeFieldsOutOfLine(iter.getResourceManager(), iter.getFilename(), tuple);
+  }
+
+  // pages before the current one did not have space for a smaller tuple
+  // and the space reserved by the fill factor is kept for rows that grow
+  u32 startEntryIndex = iter.getPageEntryIndex() == u32Max ? 0 : iter.getPageEntryIndex();
+  iter.traverseFromStartTilFindSpace(tuple.recordSize, startEntryIndex, iter.getReservedSpace());
+  BufferFrame* directoryFrame = iter.getPageDirBuffer();
+  PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(directoryFrame->bufferData.data() + sizeof(PageDirectory));
+
+  // Get the tuple page headers.
+  BufferFrame* tupleFrame = iter.getPageBuffer();
+  TuplePage* pe = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
+  bool needsNewSlot = pe->freeSlotHead == u32Max;
+
+  // The directory says there is space, but it may be scattered between the tuples.
+  // Compact the page so the free space is contiguous and matches the page entry again.
+  u32 requiredSize = tuple.recordSize + (needsNewSlot ? (u32)sizeof(Slot) : 0);
+  if (pe->contiguousFreeSpace() < requiredSize) {
+    pageEntryList[iter.getPageEntryIndex()].freeSpace = compactTuplePage(tupleFrame);
+  }
+
+  // Decrease page entry free space size
+  pageEntryList[iter.getPageEntryIndex()].freeSpace -= tuple.recordSize;
+  if (needsNewSlot) {
+    pageEntryList[iter.getPageEntryIndex()].freeSpace -= sizeof(Slot);
+  }
+  directoryFrame->dirty = true;
+
+  // Take a free slot, or a new one
+  u32 slotIdx = pe->allocateSlot();
+  auto& currSlot = pe->slots()[slotIdx];
   u32 offset = pe->lastOccupiedPosition - tuple.recordSize;
-  currSlot.setOccupied(true);
+  pe->lastOccupiedPosition -= tuple.recordSize;
   currSlot.setOffset(offset);
+  currSlot.setLength(tuple.recordSize);
 
   // Write the tuple to the buffer
-  for (auto& field : tuple.fields) {
-    field->write(tupleFrame->bufferData.data(), offset);
-    offset += field->getLength();
+  if (codec) {
+    codec->encode(tuple, tupleFrame->bufferData.data(), offset);
+  }
+  else {
+    tuple.write(tupleFrame->bufferData.data(), offset);
   }
-  pe->lastOccupiedPosition = offset;
   tupleFrame->dirty = true;
-  bm.unpin(fm, tuplePageId);
-}
\ No newline at end of file
+
+  return RID{ tupleFrame->pageId.pageNumber, slotIdx };
+}
+
+void HeapFile::insertTuples(HeapFile::HeapFileIterator& iter, std::vector<Tuple>& tuples, RowCodec* codec) {
+  // rows of a fixed width schema all have the same size, there is nothing to move or sort
+  if (codec || iter.isPax()) {
+    for (auto& tuple : tuples) {
+      insertTuple(iter, tuple, codec);
+    }
+    return;
+  }
+
+  // sort by the size tuples will have in the page
+  for (auto& tuple : tuples) {
+    moveLargeFieldsOutOfLine(iter.getResourceManager(), iter.getFilename(), tuple);
+  }
+  std::sort(begin(tuples), end(tuples), [](auto& lhs, auto& rhs) {
+    return lhs.recordSize < rhs.recordSize;
+    });
+
+  for (auto& tuple : tuples) {
+    insertTuple(iter, tuple);
+  }
+}
+
+void HeapFile::insertTuples(std::shared_ptr<ResourceManager>& rm, const std::string& filename, std::vector<Tuple>& tuples, RowCodec* codec) {
+  if (tuples.empty()) {
+    return;
+  }
+
+  // continue from where the last insert into this table found space
+  auto hint = rm->insertHints.find(filename);
+  std::unique_ptr<HeapFile::HeapFileIterator> iter;
+  if (hint != rm->insertHints.end()) {
+    iter = std::make_unique<HeapFile::HeapFileIterator>(filename, rm, hint->second);
+  }
+  else {
+    iter = std::make_unique<HeapFile::HeapFileIterator>(filename, rm);
+    iter->findFirstDir();
+  }
+
+  insertTuples(*iter, tuples, codec);
+  rm->insertHints[filename] = InsertHint{ iter->getDirectoryIndex(), iter->getPageEntryIndex() };
+}
+
+
+
+// the columns of a row of a PAX page are read from their minipages.
+static Tuple readPaxRow(Schema& schema, const std::shared_ptr<HeapFileSource>& source, PaxPage* pp, u32 row) {
+  Tuple::Fields output(ArenaScope::getResource());
+  for (u32 i = 0; i < schema.fieldList.size(); ++i) {
+    output.push_back(schema.fieldMap[schema.fieldList[i]]->get(pp->value(i, row), 0, source));
+  }
+  return Tuple(std::move(output));
+}
+
+Tuple HeapFile::readTuple(std::shared_ptr<ResourceManager>& rm, Schema& schema, const std::shared_ptr<HeapFileSource>& source,
+  BufferFrame* tupleFrame, u32 slotIdx) {
+  PaxPage* pp = reinterpret_cast<PaxPage*>(tupleFrame->bufferData.data());
+  if (pp->pageType == PageType::PaxPage) {
+    return readPaxRow(schema, source, pp, slotIdx);
+  }
+
+  Slot slot = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data())->slots()[slotIdx];
+  PageId forwardPageId = emptyPageId;
+  if (slot.isForwarded()) {
+    RID rid = slot.getForward();
+    forwardPageId = PageId{ tupleFrame->pageId.filename, rid.pageNumber };
+    tupleFrame = rm->bm.pin(rm->fm, forwardPageId);
+    slot = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data())->slots()[rid.slotNumber];
+  }
+
+  TuplePage* tp = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
+  if (tp->rowFormat != TuplePage::ROW_FORMAT) {
+    throw std::runtime_error("Unsupported row format");
+  }
+  Tuple::Fields output(ArenaScope::getResource());
+  const char* row = tupleFrame->bufferData.data() + slot.getOffset();
+  for (u32 i = 0; i < schema.fieldList.size(); ++i) {
+    auto wf = schema.fieldMap[schema.fieldList[i]]->get(row, RowHeader::columnOffset(row, i), source);
+    output.push_back(std::move(wf));
+  }
+
+  if (forwardPageId.pageNumber != u64Max) {
+    rm->bm.unpin(rm->fm, forwardPageId);
+  }
+  return Tuple(std::move(output));
+}
+
+TupleView HeapFile::viewTuple(std::shared_ptr<ResourceManager>& rm, Schema& schema, const std::vector<ReadField*>& readFields,
+  const std::shared_ptr<HeapFileSource>& source, BufferFrame* tupleFrame, u32 slotIdx) {
+  PaxPage* pp = reinterpret_cast<PaxPage*>(tupleFrame->bufferData.data());
+  if (pp->pageType == PageType::PaxPage) {
+    return TupleView(tupleFrame->bufferData.data(), pp->minipages(), slotIdx, readFields, source);
+  }
+  TuplePage* tp = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
+  Slot& slot = tp->slots()[slotIdx];
+  if (slot.isForwarded()) {
+    return TupleView(readTuple(rm, schema, source, tupleFrame, slotIdx));
+  }
+  if (tp->rowFormat != TuplePage::ROW_FORMAT) {
+    throw std::runtime_error("Unsupported row format");
+  }
+  return TupleView(tupleFrame->bufferData.data(), slot.getOffset(), readFields, source);
+}
+
+// a RID names a row if its slot is in use and is not the moved copy of a forwarded row.
+static bool isRow(BufferFrame* tupleFrame, u32 slotIdx) {
+  PaxPage* pp = reinterpret_cast<PaxPage*>(tupleFrame->bufferData.data());
+  if (pp->pageType == PageType::PaxPage) {
+    return pp->isOccupied(slotIdx);
+  }
+  TuplePage* tp = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
+  if (tp->pageType != PageType::TuplePage || slotIdx >= tp->numberOfSlots) {
+    return false;
+  }
+  Slot& slot = tp->slots()[slotIdx];
+  return slot.isOccupied() && !slot.isRelocated();
+}
+
+// first pages of the overflow chains of the row in the slot, its VARCHAR columns are found through the schema.
+// a forwarding slot is followed to the page the row was moved to.
+static std::vector<u64> overflowChainsOf(std::shared_ptr<ResourceManager>& rm, Schema& schema, BufferFrame* tupleFrame, u32 slotIdx) {
+  std::vector<u64> chains;
+  TuplePage* tp = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data());
+  if (tp->pageType != PageType::TuplePage) {
+    return chains;
+  }
+  Slot slot = tp->slots()[slotIdx];
+  PageId forwardPageId = emptyPageId;
+  if (slot.isForwarded()) {
+    RID rid = slot.getForward();
+    forwardPageId = PageId{ tupleFrame->pageId.filename, rid.pageNumber };
+    tupleFrame = rm->bm.pin(rm->fm, forwardPageId);
+    slot = reinterpret_cast<TuplePage*>(tupleFrame->bufferData.data())->slots()[rid.slotNumber];
+  }
+
+  const char* row = tupleFrame->bufferData.data() + slot.getOffset();
+  for (u32 i = 0; i < schema.fieldList.size(); ++i) {
+    if (!dynamic_cast<ReadVarCharField*>(schema.fieldMap.at(schema.fieldList[i]).get())) {
+      continue;
+    }
+    u32 offset = RowHeader::columnOffset(row, i);
+    u16 length, physicalSize;
+    std::memcpy(&length, row + offset, sizeof(u16));
+    std::memcpy(&physicalSize, row + offset + sizeof(u16), sizeof(u16));
+    if (length == VARCHAR_OVERFLOW && physicalSize == VARCHAR_OVERFLOW) {
+      u64 firstPage;
+      std::memcpy(&firstPage, row + offset + sizeof(u16) + sizeof(u16) + sizeof(u32), sizeof(u64));
+      chains.push_back(firstPage);
+    }
+  }
+
+  if (forwardPageId.pageNumber != u64Max) {
+    rm->bm.unpin(rm->fm, forwardPageId);
+  }
+  return chains;
+}
+
+// free the overflow chains of the old row that the new tuple does not point to any more.
+static void freeReplacedOverflow(std::shared_ptr<ResourceManager>& rm, const std::string& filename, const std::vector<u64>& oldChains, Tuple& tuple) {
+  for (u64 firstPage : oldChains) {
+    bool isKept = false;
+    for (auto& field : tuple.fields) {
+      auto overflowField = dynamic_cast<OverflowVarCharField*>(field.get());
+      isKept = isKept || (overflowField && overflowField->getFilename() == filename && overflowField->getFirstPage() == firstPage);
+    }
+    if (!isKept) {
+      HeapFile::freeOverflow(*rm, filename, firstPage);
+    }
+  }
+}
+
+// free space of a tuple page counted from its slots, it is what the page entry of the page says.
+static u32 freeSpaceOf(TuplePage* tp) {
+  u32 used = 0;
+  Slot* slot = tp->slots();
+  for (u32 i = tp->nextOccupiedSlot(0); i < tp->numberOfSlots; i = tp->nextOccupiedSlot(i + 1)) {
+    // forwarding slots have no data on this page
+    if (!slot[i].isForwarded()) {
+      used += slot[i].getLength();
+    }
+  }
+  return tp->pageSize - TuplePage::headerSize(tp->pageSize) - tp->numberOfSlots * (u32)sizeof(Slot) - used;
+}
+
+// change the free space in the page entry of a page, the page directory is found from the page index
+// and is only pinned for the change.
+static void changeFreeSpace(std::shared_ptr<ResourceManager>& rm, const std::string& filename, u32 pageIndex, i64 delta) {
+  if (delta == 0) {
+    return;
+  }
+  u32 entriesPerDirectory = PageDirectory::entriesPerDirectory(rm->fm.getBlockSize());
+  PageId directoryId{ filename, HeapFile::getPageDirectory(*rm, filename, pageIndex / entriesPerDirectory) };
+  BufferFrame* directoryFrame = rm->bm.pin(rm->fm, directoryId);
+  PageEntry& pageEntry = reinterpret_cast<PageEntry*>(directoryFrame->bufferData.data() + sizeof(PageDirectory))[pageIndex % entriesPerDirectory];
+  pageEntry.freeSpace = (u32)((i64)pageEntry.freeSpace + delta);
+  directoryFrame->dirty = true;
+  rm->bm.unpin(rm->fm, directoryId);
+  rm->invalidateInsertHint(filename);
+}
+
+// pin the page of a RID, throws if the RID does not name a row.
+static BufferFrame* pinRow(std::shared_ptr<ResourceManager>& rm, const std::string& filename, RID rid) {
+  PageId pageId{ filename, rid.pageNumber };
+  if (rid.pageNumber >= rm->fm.getNumberOfPages(filename)) {
+    throw std::runtime_error("RID does not point to a row");
+  }
+  BufferFrame* tupleFrame = rm->bm.pin(rm->fm, pageId);
+  if (!isRow(tupleFrame, rid.slotNumber)) {
+    rm->bm.unpin(rm->fm, pageId);
+    throw std::runtime_error("RID does not point to a row");
+  }
+  return tupleFrame;
+}
+
+Tuple HeapFile::fetch(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Schema& schema, RID rid) {
+  BufferFrame* tupleFrame = pinRow(rm, filename, rid);
+  auto source = std::make_shared<HeapFileSource>(HeapFileSource{ rm, filename });
+  Tuple tuple = readTuple(rm, schema, source, tupleFrame, rid.slotNumber);
+  rm->bm.unpin(rm->fm, tupleFrame->pageId);
+  return tuple;
+}
+
+// widths of the columns of a PAX page, read from its minipages.
+static std::vector<u32> paxColumnsOf(PaxPage* pp) {
+  std::vector<u32> paxColumns;
+  for (u32 i = 0; i < pp->numberOfColumns; ++i) {
+    paxColumns.push_back(pp->minipages()[i].width);
+  }
+  return paxColumns;
+}
+
+/**
+Update and erase of the row in a slot of a pinned page, for the rows of a scan and for the rows of a RID.
+
+The page stays pinned, the free space of the pages that change is corrected in their page entries.
+A row that no longer fits on its page moves to a page pushIter finds, and a forwarding slot is left
+behind so the row keeps its RID. Without pushIter a new iterator walks the page directories, only then.
+*/
+static void updateRow(std::shared_ptr<ResourceManager>& rm, const std::string& filename, BufferFrame* pageBuffer,
+  u32 slotIdx, Tuple& tuple, HeapFile::HeapFileIterator* pushIter) {
+  HeapFile::encodeDictionaryFields(rm, filename, tuple);
+  pageBuffer->dirty = true;
+
+  // a row of a PAX page never changes its width
+  PaxPage* pp = reinterpret_cast<PaxPage*>(pageBuffer->bufferData.data());
+  if (pp->pageType == PageType::PaxPage) {
+    checkPaxRow(paxColumnsOf(pp), tuple);
+    writePaxRow(pp, slotIdx, tuple);
+    return;
+  }
+  HeapFile::moveLargeFieldsOutOfLine(rm, filename, tuple);
+
+  TuplePage* pe = reinterpret_cast<TuplePage*>(pageBuffer->bufferData.data());
+  Slot& currSlot = pe->slots()[slotIdx];
+  u32 pageIndex = pe->pageIndex;
+
+  // bytes of the old tuple stored on this page
+  u32 oldSizeOnPage = currSlot.getLength();
+  if (currSlot.isForwarded()) {
+    RID forward = currSlot.getForward();
+    PageId forwardId{ filename, forward.pageNumber };
+    BufferFrame* forwardBuffer = rm->bm.pin(rm->fm, forwardId);
+    if (!forwardBuffer) {
+      throw std::runtime_error("Forwarded tuple page does not exist");
+    }
+    TuplePage* forwardPage = reinterpret_cast<TuplePage*>(forwardBuffer->bufferData.data());
+    Slot& forwardSlot = forwardPage->slots()[forward.slotNumber];
+    u32 forwardIndex = forwardPage->pageIndex;
+    u32 forwardLength = forwardSlot.getLength();
+    forwardBuffer->dirty = true;
+    if (tuple.recordSize <= forwardLength) {
+      // still fits where it was moved to, the shrunk tail is reclaimed when the page is compacted
+      tuple.write(forwardBuffer->bufferData.data(), forwardSlot.getOffset());
+      forwardSlot.setLength(tuple.recordSize);
+      rm->bm.unpin(rm->fm, forwardId);
+      changeFreeSpace(rm, filename, forwardIndex, (i64)forwardLength - tuple.recordSize);
+      return;
+    }
+    forwardPage->freeSlot(forward.slotNumber);
+    rm->bm.unpin(rm->fm, forwardId);
+    changeFreeSpace(rm, filename, forwardIndex, forwardLength);
+    oldSizeOnPage = 0;
+  }
+  else if (tuple.recordSize <= oldSizeOnPage) {
+    // the shrunk tail of the old tuple is reclaimed when the page is compacted
+    tuple.write(pageBuffer->bufferData.data(), currSlot.getOffset());
+    currSlot.setLength(tuple.recordSize);
+    changeFreeSpace(rm, filename, pageIndex, (i64)oldSizeOnPage - tuple.recordSize);
+    return;
+  }
+
+  // the page itself knows its free space, its page entry does not have to be read
+  u32 freeSpace = freeSpaceOf(pe) + (currSlot.isForwarded() ? 0 : oldSizeOnPage);
+  if (freeSpace >= tuple.recordSize) {
+    // grow on the same page, the old bytes are dropped and the page is compacted around them
+    currSlot.clearForward();
+    currSlot.setLength(0);
+    if (pe->contiguousFreeSpace() < tuple.recordSize) {
+      HeapFile::compactTuplePage(pageBuffer);
+    }
+    u32 offset = pe->lastOccupiedPosition - tuple.recordSize;
+    pe->lastOccupiedPosition = offset;
+    currSlot.setOffset(offset);
+    currSlot.setLength(tuple.recordSize);
+    tuple.write(pageBuffer->bufferData.data(), offset);
+    changeFreeSpace(rm, filename, pageIndex, (i64)oldSizeOnPage - tuple.recordSize);
+    return;
+  }
+
+  // move the tuple to another page and leave a forwarding slot behind, so the tuple keeps its RID
+  std::optional<HeapFile::HeapFileIterator> ownIter;
+  if (!pushIter) {
+    pushIter = &ownIter.emplace(filename, rm);
+  }
+  RID forward = HeapFile::insertTuple(*pushIter, tuple);
+  reinterpret_cast<TuplePage*>(pushIter->getPageBuffer()->bufferData.data())->slots()[forward.slotNumber].setRelocated(true);
+  currSlot.setForward(forward);
+  changeFreeSpace(rm, filename, pageIndex, oldSizeOnPage);
+}
+
+// a forwarding slot frees the tuple it points to as well. false if the slot holds no row.
+static bool eraseRow(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Schema& schema, BufferFrame* pageBuffer, u32 slotIdx) {
+  if (!isRow(pageBuffer, slotIdx)) {
+    return false;
+  }
+  for (u64 firstPage : overflowChainsOf(rm, schema, pageBuffer, slotIdx)) {
+    HeapFile::freeOverflow(*rm, filename, firstPage);
+  }
+  pageBuffer->dirty = true;
+  PaxPage* pp = reinterpret_cast<PaxPage*>(pageBuffer->bufferData.data());
+  if (pp->pageType == PageType::PaxPage) {
+    pp->freeRow(slotIdx);
+    changeFreeSpace(rm, filename, pp->pageIndex, paxRowWidth(paxColumnsOf(pp)));
+    return true;
+  }
+
+  TuplePage* pe = reinterpret_cast<TuplePage*>(pageBuffer->bufferData.data());
+  Slot& slot = pe->slots()[slotIdx];
+  if (slot.isForwarded()) {
+    RID forward = slot.getForward();
+    PageId forwardId{ filename, forward.pageNumber };
+    BufferFrame* forwardBuffer = rm->bm.pin(rm->fm, forwardId);
+    if (!forwardBuffer) {
+      throw std::runtime_error("Forwarded tuple page does not exist");
+    }
+    TuplePage* forwardPage = reinterpret_cast<TuplePage*>(forwardBuffer->bufferData.data());
+    u32 forwardLength = forwardPage->slots()[forward.slotNumber].getLength();
+    u32 forwardIndex = forwardPage->pageIndex;
+    forwardPage->freeSlot(forward.slotNumber);
+    forwardBuffer->dirty = true;
+    rm->bm.unpin(rm->fm, forwardId);
+    changeFreeSpace(rm, filename, forwardIndex, forwardLength);
+  }
+  else {
+    changeFreeSpace(rm, filename, pe->pageIndex, slot.getLength());
+  }
+  pe->freeSlot(slotIdx);
+  return true;
+}
+
+void HeapFile::updateTuple(HeapFile::HeapFileIterator& iter, HeapFile::HeapFileIterator& pushIter, Schema& schema, u32 slotIdx, Tuple& tuple) {
+  auto& rm = iter.getResourceManager();
+  std::vector<u64> oldChains = overflowChainsOf(rm, schema, iter.getPageBuffer(), slotIdx);
+  updateRow(rm, iter.getFilename(), iter.getPageBuffer(), slotIdx, tuple, &pushIter);
+  freeReplacedOverflow(rm, iter.getFilename(), oldChains, tuple);
+}
+
+bool HeapFile::eraseTuple(HeapFile::HeapFileIterator& iter, Schema& schema, u32 slotIdx) {
+  return eraseRow(iter.getResourceManager(), iter.getFilename(), schema, iter.getPageBuffer(), slotIdx);
+}
+
+void HeapFile::update(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Schema& schema, RID rid, Tuple& tuple) {
+  BufferFrame* pageBuffer = pinRow(rm, filename, rid);
+  PageId pageId = pageBuffer->pageId;
+  std::vector<u64> oldChains = overflowChainsOf(rm, schema, pageBuffer, rid.slotNumber);
+  updateRow(rm, filename, pageBuffer, rid.slotNumber, tuple, nullptr);
+  rm->bm.unpin(rm->fm, pageId);
+  freeReplacedOverflow(rm, filename, oldChains, tuple);
+}
+
+void HeapFile::erase(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Schema& schema, RID rid) {
+  BufferFrame* pageBuffer = pinRow(rm, filename, rid);
+  PageId pageId = pageBuffer->pageId;
+  eraseRow(rm, filename, schema, pageBuffer, rid.slotNumber);
+  rm->bm.unpin(rm->fm, pageId);
+}
+
+void HeapFile::bulkLoad(std::shared_ptr<ResourceManager>& rm, const std::string& filename, std::vector<Tuple>& tuples) {
+  auto& fm = rm->fm;
+
+  if (tuples.empty()) {
+    return;
+  }
+
+  // PAX pages are filled through the buffer pool
+  if (!getPaxColumns(*rm, filename).empty()) {
+    insertTuples(rm, filename, tuples);
+    return;
+  }
+
+  for (auto& tuple : tuples) {
+    encodeDictionaryFields(rm, filename, tuple);
+    moveLargeFieldsOutOfLine(rm, filename, tuple);
+  }
+
+  const u32 blockSize = fm.getBlockSize();
+  const u32 entriesPerDir = PageDirectory::entriesPerDirectory(blockSize);
+  const u32 reserved = reservedSpace(blockSize, getFillFactor(*rm, filename));
+
+  // the last page directory is filled before a new one is added
+  u64 directoryIndex = numberOfPageDirectories(*rm, filename) - 1;
+  PageId directoryId{ filename, getPageDirectory(*rm, filename, directoryIndex) };
+  BufferFrame* directoryFrame = rm->bm.pin(fm, directoryId);
+  u64 entriesInDirectory = reinterpret_cast<PageDirectory*>(directoryFrame->bufferData.data())->numberOfEntries;
+  rm->bm.unpin(fm, directoryId);
+
+  // Each batch is the tuple pages of one page directory, preceded by the page directory if it is new
+  size_t tupleIdx = 0;
+  std::vector<char> batch;
+  std::vector<PageEntry> pe;
+  while (tupleIdx < tuples.size()) {
+    bool isNewDirectory = entriesInDirectory >= entriesPerDir;
+    if (isNewDirectory) {
+      directoryIndex++;
+      entriesInDirectory = 0;
+      if (directoryIndex >= PageDirectoryRoot::maxDirectories(blockSize)) {
+        throw std::runtime_error("Page directory root is full");
+      }
+    }
+    u64 firstPageNumber = fm.getNumberOfPages(filename);
+    batch.assign(isNewDirectory ? blockSize : 0, 0);
+    pe.clear();
+
+    while (tupleIdx < tuples.size() && entriesInDirectory + pe.size() < entriesPerDir) {
+      size_t pageOffset = batch.size();
+      batch.resize(pageOffset + blockSize, 0);
+      char* page = batch.data() + pageOffset;
+
+      // Fill the tuple page until the next tuple does not fit
+      TuplePage header{ 0, blockSize, 0, blockSize, (u32)(directoryIndex * entriesPerDir + entriesInDirectory + pe.size()) };
+      std::memcpy(page, &header, sizeof(TuplePage));
+      TuplePage* tp = reinterpret_cast<TuplePage*>(page);
+      u32 freeSpace = blockSize - TuplePage::headerSize(blockSize);
+      while (tupleIdx < tuples.size()) {
+        auto& tuple = tuples[tupleIdx];
+        if (tuple.recordSize + sizeof(Slot) > freeSpace) {
+          break;
+        }
+        // an empty page always takes a tuple, even if it goes into the reserved space
+        if (tp->numberOfSlots > 0 && tuple.recordSize + sizeof(Slot) + reserved > freeSpace) {
+          break;
+        }
+
+        u32 offset = tp->lastOccupiedPosition - tuple.recordSize;
+        auto& slot = tp->slots()[tp->allocateSlot()];
+        slot.setOffset(offset);
+        slot.setLength(tuple.recordSize);
+        tp->lastOccupiedPosition = offset;
+        freeSpace -= tuple.recordSize + sizeof(Slot);
+
+        tuple.write(page, offset);
+        tupleIdx++;
+      }
+
+      if (tp->numberOfSlots == 0) {
+        throw std::runtime_error("Tuple is too large to fit in a page");
+      }
+
+      pe.push_back(PageEntry{ firstPageNumber + pageOffset / blockSize, freeSpace });
+    }
+
+    if (isNewDirectory) {
+      PageDirectory newPd{ directoryIndex, pe.size() };
+      std::memcpy(batch.data(), &newPd, sizeof(PageDirectory));
+      std::memcpy(batch.data() + sizeof(PageDirectory), pe.data(), sizeof(PageEntry) * pe.size());
+
+      // The page directory is only registered once all of its pages are written
+      fm.append(filename, batch);
+      addPageDirectory(*rm, filename, firstPageNumber);
+    }
+    else {
+      // the page entries are added to the last page directory once its pages are written
+      fm.append(filename, batch);
+      directoryFrame = rm->bm.pin(fm, directoryId);
+      directoryFrame->modify(pe.data(), sizeof(PageEntry) * pe.size(), sizeof(PageDirectory) + entriesInDirectory * sizeof(PageEntry));
+      reinterpret_cast<PageDirectory*>(directoryFrame->bufferData.data())->numberOfEntries += pe.size();
+      rm->bm.unpin(fm, directoryId);
+    }
+    entriesInDirectory += pe.size();
+  }
+}
@@ -8,10 +8,15 @@
 #include <stdexcept>
 #include <unordered_map>
 #include <filesystem>
+#include <bit>
+#include <optional>
+#include <algorithm>
 
 #include "common.h"
 #include "query.h"
 
+class RowCodec;
+
 // this page stores the storage engine.
 
 // strategy -> store everything on one file and use it as a disk...
@@ -37,6 +42,9 @@ const static size_t PAGE_SIZE_L = 16384;
 
 const static size_t FIRST_BIT = 0x80000000;
 const static size_t ALL_OTHER_BITS = 0x7FFFFFFF;
+const static size_t FORWARDED_BIT = 0x40000000;
+const static size_t RELOCATED_BIT = 0x20000000;
+const static size_t OFFSET_BITS = 0x1FFFFFFF;
 
 // one header page contains 4mb
 struct RID {
@@ -45,40 +53,148 @@ struct RID {
 };
 
 enum class PageType {
-  TuplePage, IndexPage, DirectoryPage
+  TuplePage, IndexPage, DirectoryPage, OverflowPage, DirectoryIndexPage, PaxPage, DictionaryPage, DirectoryRootPage, TableMetadataPage, OverflowHeaderPage
+};
+
+struct PageEntry {
+  u64 pageNumber;
+  u32 freeSpace;
+};
+
+/**
+Page 0 of a heap file is the page directory root, an array with the page number of every page directory index.
+Page directory index i holds the page numbers of page directories [i * capacity, (i + 1) * capacity).
+
+Page directory i holds the page entries of the tuple pages with page index
+[i * entriesPerDirectory, (i + 1) * entriesPerDirectory), so the page entry of any tuple page
+is reached by pinning the root, one page directory index and one page directory.
+*/
+struct PageDirectoryRoot {
+  PageType pageType;
+  u64 numberOfDirectories;
+  u64 numberOfIndexPages;
+
+  PageDirectoryRoot() : pageType{ PageType::DirectoryRootPage }, numberOfDirectories{ 0 }, numberOfIndexPages{ 0 } {}
+
+  static u64 capacity(u32 pageSize) {
+    return (pageSize - sizeof(PageDirectoryRoot)) / sizeof(u64);
+  }
+
+  // most page directories a heap file can have.
+  static u64 maxDirectories(u32 pageSize);
+
+  // only works on a header that lives inside of a page.
+  u64* indexPages() {
+    return reinterpret_cast<u64*>(reinterpret_cast<char*>(this) + sizeof(PageDirectoryRoot));
+  }
+};
+
+struct PageDirectoryIndex {
+  PageType pageType;
+  u64 numberOfDirectories;
+
+  PageDirectoryIndex() : pageType{ PageType::DirectoryIndexPage }, numberOfDirectories{ 0 } {}
+
+  static u64 capacity(u32 pageSize) {
+    return (pageSize - sizeof(PageDirectoryIndex)) / sizeof(u64);
+  }
+
+  // only works on a header that lives inside of a page.
+  u64* directories() {
+    return reinterpret_cast<u64*>(reinterpret_cast<char*>(this) + sizeof(PageDirectoryIndex));
+  }
+};
+
+inline u64 PageDirectoryRoot::maxDirectories(u32 pageSize) {
+  return capacity(pageSize) * PageDirectoryIndex::capacity(pageSize);
+}
+
+/**
+Page 1 of a heap file holds the metadata of the table, the options it was created with.
+
+Inserts leave (100 - fillFactor)% of every tuple page free. The header is followed by the column widths
+of a table with the PAX layout, a table with the row layout has no PAX columns.
+*/
+struct TableMetadata {
+  PageType pageType;
+  u32 fillFactor;
+  u32 numberOfPaxColumns;
+
+  TableMetadata(u32 fillFactor = 100, u32 numberOfPaxColumns = 0) :
+    pageType{ PageType::TableMetadataPage }, fillFactor{ fillFactor }, numberOfPaxColumns{ numberOfPaxColumns } {}
+
+  static u32 maxPaxColumns(u32 pageSize) {
+    return (pageSize - sizeof(TableMetadata)) / sizeof(u32);
+  }
+
+  // only works on a header that lives inside of a page.
+  u32* paxColumnWidths() {
+    return reinterpret_cast<u32*>(reinterpret_cast<char*>(this) + sizeof(TableMetadata));
+  }
 };
 
 struct PageDirectory {
   PageType pageType;
-  u64 nextPage;
-  u64 prevPage;
+  u64 directoryIndex;
   u64 numberOfEntries;
-  char tableName[128];
 
-  PageDirectory(u64 nextPage, u64 prevPage, u64 numberOfEntries) :
+  PageDirectory(u64 directoryIndex, u64 numberOfEntries) :
     pageType{ PageType::DirectoryPage },
-    nextPage{ nextPage }, prevPage{ prevPage }, numberOfEntries{ numberOfEntries } {}
+    directoryIndex{ directoryIndex }, numberOfEntries{ numberOfEntries } {}
+
+  static u32 entriesPerDirectory(u32 pageSize) {
+    return (pageSize - sizeof(PageDirectory)) / sizeof(PageEntry);
+  }
 };
 
-struct PageEntry {
-  u64 pageNumber;
-  u32 freeSpace;
+/**
+Values that are too large to be stored in a tuple page are moved to the overflow file of the table.
+The value is split over a chain of overflow pages, each page holds dataLength bytes right after the header.
+*/
+struct OverflowPage {
+  PageType pageType;
+  u64 nextPage;
+  u32 dataLength;
+
+  OverflowPage(u64 nextPage, u32 dataLength) :
+    pageType{ PageType::OverflowPage }, nextPage{ nextPage }, dataLength{ dataLength } {}
 };
 
-struct TuplePage {
+/**
+Page 0 of the overflow file heads the list of free overflow pages. The chains of values that were erased or
+replaced are linked into it through nextPage, and new chains take their pages from it before the file grows.
+*/
+struct OverflowFileHeader {
   PageType pageType;
-  u64 checkSum;
-  u32 pageSize;
-  u32 numberOfSlots;
-  u32 lastOccupiedPosition;
+  u64 freePageHead;
 
-  TuplePage(u64 checkSum, u32 pageSize, u32 numberOfSlots, u32 lastOccupiedPosition) :
-    pageType{ PageType::TuplePage },
-    checkSum{ checkSum }, pageSize{ pageSize }, numberOfSlots{ numberOfSlots }, lastOccupiedPosition{ lastOccupiedPosition } {}
+  OverflowFileHeader() : pageType{ PageType::OverflowHeaderPage }, freePageHead{ u64Max } {}
 };
 
+/**
+The dictionary file of a table holds the values of its DICT columns, the code of a value is its position
+in the file. Each page holds numberOfEntries values, each value is a u16 length followed by its characters.
+*/
+struct DictionaryPage {
+  PageType pageType;
+  u32 numberOfEntries;
+  // bytes used by the header and the values
+  u32 usedSize;
+
+  DictionaryPage() : pageType{ PageType::DictionaryPage }, numberOfEntries{ 0 }, usedSize{ sizeof(DictionaryPage) } {}
+};
+
+/**
+data holds the occupied bit, the forwarded and relocated bits and the offset, length is the record size of the tuple.
+
+A tuple that outgrew its page is moved to another page and its slot becomes a forwarding slot, so the
+tuple keeps its RID. A forwarding slot has no data, the offset holds the page number and the length holds
+the slot number of the moved tuple. The moved tuple is marked as relocated, scans reach it through its
+forwarding slot only. Forwarding is only ever one hop, a tuple that moves again updates its forwarding slot.
+*/
 struct Slot {
   u32 data;
+  u32 length;
   bool isOccupied() const {
     return (data & FIRST_BIT) != 0;
   }
@@ -90,14 +206,263 @@ struct Slot {
       data &= ALL_OTHER_BITS;
     }
   }
+  bool isForwarded() const {
+    return (data & FORWARDED_BIT) != 0;
+  }
+  bool isRelocated() const {
+    return (data & RELOCATED_BIT) != 0;
+  }
+  void setRelocated(bool relocated) {
+    if (relocated) {
+      data |= RELOCATED_BIT;
+    }
+    else {
+      data &= ~RELOCATED_BIT;
+    }
+  }
+  RID getForward() const {
+    return RID{ data & OFFSET_BITS, length };
+  }
+  void setForward(RID rid) {
+    if (rid.pageNumber > OFFSET_BITS) {
+      throw std::runtime_error("Page number is too large to forward to");
+    }
+    data = (data & (FIRST_BIT | RELOCATED_BIT)) | FORWARDED_BIT | (u32)rid.pageNumber;
+    length = rid.slotNumber;
+  }
+  // the slot holds the tuple data itself again.
+  void clearForward() {
+    data &= ~FORWARDED_BIT;
+  }
   u32 getOffset() const {
-    return data & ALL_OTHER_BITS;
+    return data & OFFSET_BITS;
   }
   void setOffset(u32 offset) {
-    if (offset >= FIRST_BIT) {
+    if (offset > OFFSET_BITS) {
       throw std::runtime_error("Offset is too large");
     }
-    data = (data & FIRST_BIT) | (offset & ALL_OTHER_BITS);
+    data = (data & ~OFFSET_BITS) | offset;
+  }
+  u32 getLength() const {
+    return length;
+  }
+  void setLength(u32 recordSize) {
+    length = recordSize;
+  }
+};
+
+/**
+The tuple page header is followed by an occupancy bitmap with one bit for every slot the page
+could ever hold, then the slots. Free slots form a linked list through their length field,
+starting at freeSlotHead. pageIndex is the position of the page entry of the page in the page directories.
+*/
+struct TuplePage {
+  PageType pageType;
+  u32 pageIndex;
+  u64 checkSum;
+  u32 pageSize;
+  u32 numberOfSlots;
+  u32 lastOccupiedPosition;
+  u32 freeSlotHead;
+  // version of the layout of the rows in the page, see RowHeader
+  u32 rowFormat;
+
+  // rows start with a column offset table and a null bitmap
+  static constexpr u32 ROW_FORMAT = 1;
+
+  TuplePage(u64 checkSum, u32 pageSize, u32 numberOfSlots, u32 lastOccupiedPosition, u32 pageIndex = u32Max) :
+    pageType{ PageType::TuplePage }, pageIndex{ pageIndex },
+    checkSum{ checkSum }, pageSize{ pageSize }, numberOfSlots{ numberOfSlots }, lastOccupiedPosition{ lastOccupiedPosition },
+    freeSlotHead{ u32Max }, rowFormat{ ROW_FORMAT } {}
+
+  static u32 bitmapWords(u32 pageSize) {
+    u32 maxSlots = (pageSize - sizeof(TuplePage)) / sizeof(Slot);
+    return (maxSlots + 63) / 64;
+  }
+
+  // size of the header and the occupancy bitmap, the slots start right after it.
+  static u32 headerSize(u32 pageSize) {
+    return sizeof(TuplePage) + bitmapWords(pageSize) * sizeof(u64);
+  }
+
+  // everything below only works on a header that lives inside of a page.
+  u64* occupancy() {
+    return reinterpret_cast<u64*>(reinterpret_cast<char*>(this) + sizeof(TuplePage));
+  }
+
+  Slot* slots() {
+    return reinterpret_cast<Slot*>(reinterpret_cast<char*>(this) + headerSize(pageSize));
+  }
+
+  // free space between the end of the slots and the first tuple.
+  u32 contiguousFreeSpace() {
+    return lastOccupiedPosition - headerSize(pageSize) - numberOfSlots * ((u32)sizeof(Slot));
+  }
+
+  // pop a slot off the free list, or add a new slot if there is none.
+  u32 allocateSlot() {
+    Slot* slot = slots();
+    u32 slotIdx;
+    if (freeSlotHead != u32Max) {
+      slotIdx = freeSlotHead;
+      freeSlotHead = slot[slotIdx].getLength();
+    }
+    else {
+      if (numberOfSlots >= bitmapWords(pageSize) * 64) {
+        throw std::runtime_error("No slots left in tuple page");
+      }
+      slotIdx = numberOfSlots;
+      numberOfSlots += 1;
+    }
+    slot[slotIdx].setOccupied(true);
+    occupancy()[slotIdx / 64] |= u64(1) << (slotIdx % 64);
+    return slotIdx;
+  }
+
+  // the offset of a freed slot is kept, the length links to the next free slot.
+  void freeSlot(u32 slotIdx) {
+    Slot& slot = slots()[slotIdx];
+    slot.setOccupied(false);
+    slot.clearForward();
+    slot.setRelocated(false);
+    slot.setLength(freeSlotHead);
+    freeSlotHead = slotIdx;
+    occupancy()[slotIdx / 64] &= ~(u64(1) << (slotIdx % 64));
+  }
+
+  // first occupied slot at or after slotIdx, numberOfSlots if there is none.
+  u32 nextOccupiedSlot(u32 slotIdx) {
+    u32 numberOfWords = (numberOfSlots + 63) / 64;
+    u32 wordIdx = slotIdx / 64;
+    if (slotIdx >= numberOfSlots) {
+      return numberOfSlots;
+    }
+
+    u64* bitmap = occupancy();
+    u64 word = bitmap[wordIdx] & (~u64(0) << (slotIdx % 64));
+    while (word == 0) {
+      wordIdx += 1;
+      if (wordIdx >= numberOfWords) {
+        return numberOfSlots;
+      }
+      word = bitmap[wordIdx];
+    }
+    return wordIdx * 64 + std::countr_zero(word);
+  }
+
+  u32 numberOfOccupiedSlots() {
+    u32 numberOfWords = (numberOfSlots + 63) / 64;
+    u64* bitmap = occupancy();
+    u32 count = 0;
+    for (u32 i = 0; i < numberOfWords; ++i) {
+      count += std::popcount(bitmap[i]);
+    }
+    return count;
+  }
+};
+
+/**
+A page of a table with the PAX layout (partition attributes across).
+
+The rows of the page are split by column, the values of each column are stored together in a minipage,
+so a scan that reads one column touches contiguous memory. Every column has a fixed width, so row r of a
+column is found without any slot or row header. The header is followed by an occupancy bitmap with one bit
+for every row the page can hold, then a Minipage for every column, then the minipages. pageType and
+pageIndex are at the same place as in TuplePage.
+*/
+struct PaxPage {
+  PageType pageType;
+  u32 pageIndex;
+  u32 pageSize;
+  u32 numberOfColumns;
+  u32 rowCapacity;
+  u32 numberOfRows;
+
+  // write an empty PAX page for the column widths to the start of page, rowCapacity is 0 if no row fits.
+  static void initialize(char* page, u32 pageSize, u32 pageIndex, const std::vector<u32>& columnWidths) {
+    u32 rowWidth = 0;
+    for (u32 width : columnWidths) {
+      rowWidth += width;
+    }
+    u32 numberOfColumns = (u32)columnWidths.size();
+    u32 available = pageSize - sizeof(PaxPage) - numberOfColumns * sizeof(Minipage);
+    // a row takes its width and one bit of the bitmap, the bitmap is made of whole words
+    u32 rowCapacity = (u32)((u64)available * 8 / ((u64)rowWidth * 8 + 1));
+    while (rowCapacity > 0 && rowCapacity * rowWidth + bitmapWords(rowCapacity) * sizeof(u64) > available) {
+      rowCapacity -= 1;
+    }
+
+    PaxPage header{ PageType::PaxPage, pageIndex, pageSize, numberOfColumns, rowCapacity, 0 };
+    std::memcpy(page, &header, sizeof(PaxPage));
+    std::memset(page + sizeof(PaxPage), 0, bitmapWords(rowCapacity) * sizeof(u64));
+    u32 offset = sizeof(PaxPage) + bitmapWords(rowCapacity) * sizeof(u64) + numberOfColumns * sizeof(Minipage);
+    for (u32 i = 0; i < numberOfColumns; ++i) {
+      Minipage minipage{ offset, columnWidths[i] };
+      std::memcpy(page + sizeof(PaxPage) + bitmapWords(rowCapacity) * sizeof(u64) + i * sizeof(Minipage), &minipage, sizeof(Minipage));
+      offset += rowCapacity * columnWidths[i];
+    }
+  }
+
+  static u32 bitmapWords(u32 rowCapacity) {
+    return (rowCapacity + 63) / 64;
+  }
+
+  // everything below only works on a header that lives inside of a page.
+  u64* occupancy() {
+    return reinterpret_cast<u64*>(reinterpret_cast<char*>(this) + sizeof(PaxPage));
+  }
+
+  Minipage* minipages() {
+    return reinterpret_cast<Minipage*>(reinterpret_cast<char*>(this) + sizeof(PaxPage) + bitmapWords(rowCapacity) * sizeof(u64));
+  }
+
+  char* value(u32 columnIdx, u32 row) {
+    Minipage& minipage = minipages()[columnIdx];
+    return reinterpret_cast<char*>(this) + minipage.offset + row * minipage.width;
+  }
+
+  bool isOccupied(u32 row) {
+    return row < rowCapacity && (occupancy()[row / 64] >> (row % 64)) & 1;
+  }
+
+  // take the first free row, the page must not be full.
+  u32 allocateRow() {
+    u64* bitmap = occupancy();
+    for (u32 wordIdx = 0; wordIdx < bitmapWords(rowCapacity); ++wordIdx) {
+      if (bitmap[wordIdx] != ~u64(0)) {
+        u32 row = wordIdx * 64 + std::countr_one(bitmap[wordIdx]);
+        if (row >= rowCapacity) {
+          break;
+        }
+        bitmap[wordIdx] |= u64(1) << (row % 64);
+        numberOfRows += 1;
+        return row;
+      }
+    }
+    throw std::runtime_error("No rows left in PAX page");
+  }
+
+  void freeRow(u32 row) {
+    occupancy()[row / 64] &= ~(u64(1) << (row % 64));
+    numberOfRows -= 1;
+  }
+
+  // first occupied row at or after row, rowCapacity if there is none.
+  u32 nextOccupiedRow(u32 row) {
+    if (row >= rowCapacity) {
+      return rowCapacity;
+    }
+    u32 wordIdx = row / 64;
+    u64* bitmap = occupancy();
+    u64 word = bitmap[wordIdx] & (~u64(0) << (row % 64));
+    while (word == 0) {
+      wordIdx += 1;
+      if (wordIdx >= bitmapWords(rowCapacity)) {
+        return rowCapacity;
+      }
+      word = bitmap[wordIdx];
+    }
+    return wordIdx * 64 + std::countr_zero(word);
   }
 };
 
@@ -133,11 +498,17 @@ public:
   // return the last pageId
   u32 append(std::string filename, int numberOfBlocksToAppend = 1);
 
+  // append whole pages of data to the end of the file, return the last pageId
+  u32 append(std::string filename, const std::vector<char>& bufferData);
+
   u32 getNumberOfPages(PageId pageId);
   u32 getNumberOfPages(std::string filename);
 
   void createFileIfNotExists(const std::string& fileName);
 
+  // close the file stream, the file is reopened on the next access.
+  void close(const std::string& fileName);
+
   bool doesFileExists(const std::string& fileName);
 };
 
@@ -179,7 +550,7 @@ public:
     // if not pinned, find a new buffer.
     // if all buffers are pinned, return nullptr.
     int existingBufferIndex = -1, unpinnedBufferIndex = -1;
-    for (int i = 0; i < bufferPool.size(); ++i) {
+    for (u32 i = 0; i < bufferPool.size(); ++i) {
       auto& buffer = bufferPool[i];
       if (buffer.pin == 0) {
         unpinnedBufferIndex = i;
@@ -226,13 +597,51 @@ public:
     // buffer doesn't exist
     return false;
   }
+
+  // write every dirty buffer of the file to disk.
+  void flush(FileManager& fileManager, const std::string& filename) {
+    for (auto& buffer : bufferPool) {
+      if (buffer.pageId.filename == filename && buffer.dirty) {
+        fileManager.write(buffer.pageId, buffer.bufferData);
+        buffer.dirty = false;
+      }
+    }
+  }
+
+  // drop every buffer of the file without writing it back.
+  void discard(const std::string& filename) {
+    for (auto& buffer : bufferPool) {
+      if (buffer.pageId.filename == filename) {
+        if (buffer.pin > 0) {
+          throw std::runtime_error("Cannot discard a pinned buffer");
+        }
+        buffer.pageId = emptyPageId;
+        buffer.pin = 0;
+        buffer.dirty = false;
+      }
+    }
+  }
+};
+
+// where the last insert into a table found space.
+struct InsertHint {
+  u64 directoryIndex;
+  u32 pageEntryIndex;
 };
 
 struct ResourceManager {
   FileManager fm;
   BufferManager bm;
+  std::unordered_map<std::string, InsertHint> insertHints;
+  // dictionaries of the tables that have DICT columns, read from their dictionary file once
+  std::unordered_map<std::string, std::shared_ptr<Dictionary>> dictionaries;
 
   ResourceManager(u32 pagesize, u32 poolsize) : fm{ pagesize }, bm{ pagesize, poolsize } {}
+
+  // call whenever free space is given back to a table, so inserts search from the start again.
+  void invalidateInsertHint(const std::string& filename) {
+    insertHints.erase(filename);
+  }
 };
 
 // records
@@ -281,12 +690,36 @@ struct ResourceManager {
 namespace HeapFile {
   // 2x 
 
-  // create new heap file
-  void createHeapFile(ResourceManager& rm, std::string filename, const u32 newPages = 8);
+  // create new heap file, the pages of the table use the PAX layout if it has PAX columns.
+  void createHeapFile(ResourceManager& rm, std::string filename, const u32 newPages = 8, const u32 fillFactor = 100,
+    const std::vector<u32>& paxColumns = {});
+
+  u32 getFillFactor(ResourceManager& rm, const std::string& filename);
+
+  // space inserts leave free on a tuple page of a table with the fill factor.
+  u32 reservedSpace(u32 pageSize, u32 fillFactor);
+
+  // the column widths of a table with the PAX layout, empty for a table with the row layout.
+  std::vector<u32> getPaxColumns(ResourceManager& rm, const std::string& filename);
+
+  // the column widths of the schema for the PAX layout, empty if a column does not have a fixed width.
+  std::vector<u32> paxColumnsOf(Schema& schema);
+
+  // write the header of an empty tuple page, or PAX page, to the frame and return its free space.
+  u32 initializeHeapPage(BufferFrame* frame, u32 pageIndex, const std::vector<u32>& paxColumns);
 
   // add new heap file directory
   PageId appendHeapFilePageDirectory(ResourceManager& rm, std::string filename);
 
+  // page number of the i-th page directory, u64Max if there is none.
+  u64 getPageDirectory(ResourceManager& rm, const std::string& filename, u64 directoryIndex);
+
+  u64 numberOfPageDirectories(ResourceManager& rm, const std::string& filename);
+
+  // add a page directory to the last page directory index, a new index is added when it is full.
+  // returns the directory index of the page directory.
+  u64 addPageDirectory(ResourceManager& rm, const std::string& filename, u64 directoryPageNumber);
+
   // add new heap page
   PageId appendNewHeapPage(ResourceManager& rm, std::string filename);
 
@@ -297,6 +730,10 @@ namespace HeapFile {
 
   Page Entry leads to Pages.
 
+  Page Directories are found through the page directory root on page 0 and its page directory indexes,
+  the i-th page entry of page directory d
+  belongs to the tuple page with page index d * entriesPerDirectory + i.
+
   Here's the invariant:
   - Do not create another Page Directory until the current Page Directory is full of page entries.
 
@@ -313,6 +750,7 @@ namespace HeapFile {
     // page directory buffer
     PageId pageDirectoryId;
     BufferFrame* pageDirBuffer;
+    u64 directoryIndex;
 
     // page buffer
     PageId pageBufferId;
@@ -322,10 +760,19 @@ namespace HeapFile {
     // misc data
     std::string filename;
     std::shared_ptr<ResourceManager> resourceManager;
+    u32 reservedSpace = u32Max;
+    std::optional<std::vector<u32>> paxColumns;
   public:
-    HeapFileIterator(std::string filename, std::shared_ptr<ResourceManager> rm) : pageBuffer{ nullptr }, pageEntryIndex{ u32Max }, filename{ filename },
-      resourceManager{ rm } {
-      pageDirectoryId = PageId{ filename, 0 };
+    HeapFileIterator(std::string filename, std::shared_ptr<ResourceManager> rm) : directoryIndex{ 0 }, pageBuffer{ nullptr },
+      pageEntryIndex{ u32Max }, filename{ filename }, resourceManager{ rm } {
+      pageDirectoryId = PageId{ filename, getPageDirectory(*resourceManager, filename, 0) };
+      pageDirBuffer = resourceManager->bm.pin(resourceManager->fm, pageDirectoryId);
+    };
+
+    // start at the page directory and page entry of an insert hint.
+    HeapFileIterator(std::string filename, std::shared_ptr<ResourceManager> rm, InsertHint hint) : directoryIndex{ hint.directoryIndex },
+      pageBuffer{ nullptr }, pageEntryIndex{ hint.pageEntryIndex }, filename{ filename }, resourceManager{ rm } {
+      pageDirectoryId = PageId{ filename, getPageDirectory(*resourceManager, filename, hint.directoryIndex) };
       pageDirBuffer = resourceManager->bm.pin(resourceManager->fm, pageDirectoryId);
     };
 
@@ -340,6 +787,14 @@ namespace HeapFile {
       return pageDirBuffer;
     };
 
+    PageId getPageDirectoryId() {
+      return pageDirectoryId;
+    };
+
+    u64 getDirectoryIndex() {
+      return directoryIndex;
+    };
+
     u32 getPageEntryIndex() {
       return pageEntryIndex;
     };
@@ -348,6 +803,35 @@ namespace HeapFile {
       return pageBuffer;
     };
 
+    const std::string& getFilename() {
+      return filename;
+    };
+
+    // space to leave free on a page for the fill factor of the table.
+    u32 getReservedSpace() {
+      if (reservedSpace == u32Max) {
+        u32 blockSize = resourceManager->fm.getBlockSize();
+        reservedSpace = HeapFile::reservedSpace(blockSize, getFillFactor(*resourceManager, filename));
+      }
+      return reservedSpace;
+    };
+
+    // column widths of a table with the PAX layout, empty for the row layout.
+    const std::vector<u32>& getPaxColumns() {
+      if (!paxColumns) {
+        paxColumns = HeapFile::getPaxColumns(*resourceManager, filename);
+      }
+      return *paxColumns;
+    };
+
+    bool isPax() {
+      return !getPaxColumns().empty();
+    };
+
+    std::shared_ptr<ResourceManager>& getResourceManager() {
+      return resourceManager;
+    };
+
     /**
     * Return true if pages were changed, false if no pages were changed
     *
@@ -357,33 +841,76 @@ namespace HeapFile {
       // set page buffer to nullptr
       if (pageBuffer) {
         resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
+        pageBuffer = nullptr;
       }
 
-      if (pageDirectoryId.pageNumber == 0) {
-        return true;
+      if (directoryIndex != 0) {
+        moveToDir(0, getPageDirectory(*resourceManager, filename, 0));
       }
-      else {
-        pageDirectoryId = PageId{ filename, 0 };
-        resourceManager->bm.unpin(resourceManager->fm, pageDirBuffer->pageId);
-        pageDirBuffer = resourceManager->bm.pin(resourceManager->fm, pageDirectoryId);
+      return true;
+    };
 
+    // move to the page entry of the tuple page, return false if it is not a tuple page of the heap file.
+    bool seekPage(u64 pageNumber) {
+      if (pageBuffer && pageBuffer->pageId.pageNumber == pageNumber) {
         return true;
       }
+
+      // the tuple page knows where its page entry is
+      PageId pageId{ filename, pageNumber };
+      BufferFrame* frame = resourceManager->bm.pin(resourceManager->fm, pageId);
+      if (!frame) {
+        return false;
+      }
+      const TuplePage* tp = reinterpret_cast<TuplePage*>(frame->bufferData.data());
+      bool isTuplePage = tp->pageType == PageType::TuplePage || tp->pageType == PageType::PaxPage;
+      u32 pageIndex = tp->pageIndex;
+      resourceManager->bm.unpin(resourceManager->fm, pageId);
+
+      return isTuplePage && seekPageIndex(pageIndex) && pageBuffer->pageId.pageNumber == pageNumber;
+    };
+
+    // move to the page entry with the page index, return false if there is no such page entry.
+    bool seekPageIndex(u64 pageIndex) {
+      u32 entriesPerDirectory = PageDirectory::entriesPerDirectory(resourceManager->fm.getBlockSize());
+      u64 entryDirectoryIndex = pageIndex / entriesPerDirectory;
+      u32 entryIndex = pageIndex % entriesPerDirectory;
+
+      if (pageBuffer) {
+        resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
+        pageBuffer = nullptr;
+      }
+      if (entryDirectoryIndex != directoryIndex) {
+        u64 directoryPageNumber = getPageDirectory(*resourceManager, filename, entryDirectoryIndex);
+        if (directoryPageNumber == u64Max) {
+          return false;
+        }
+        moveToDir(entryDirectoryIndex, directoryPageNumber);
+      }
+
+      const PageDirectory* pd = reinterpret_cast<PageDirectory*>(pageDirBuffer->bufferData.data());
+      const PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(pageDirBuffer->bufferData.data() + sizeof(PageDirectory));
+      if (entryIndex >= pd->numberOfEntries) {
+        return false;
+      }
+      this->pageBufferId = PageId{ filename, pageEntryList[entryIndex].pageNumber };
+      pageBuffer = resourceManager->bm.pin(resourceManager->fm, this->pageBufferId);
+      pageEntryIndex = entryIndex;
+      return true;
     };
 
     bool nextDir() {
       // i should release current page buffer since it's doesn't belong to the next dir
       if (pageBuffer) {
         resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
+        pageBuffer = nullptr;
       }
 
-      PageDirectory* pd = reinterpret_cast<PageDirectory*>(pageDirBuffer->bufferData.data());
-      if (pd->nextPage == u64Max) {
+      u64 nextDirectoryPageNumber = getPageDirectory(*resourceManager, filename, directoryIndex + 1);
+      if (nextDirectoryPageNumber == u64Max) {
         return false;
       }
-      pageDirectoryId = PageId{ filename, pd->nextPage };
-      resourceManager->bm.unpin(resourceManager->fm, pageDirBuffer->pageId);
-      pageDirBuffer = resourceManager->bm.pin(resourceManager->fm, pageDirectoryId);
+      moveToDir(directoryIndex + 1, nextDirectoryPageNumber);
       return true;
     };
 
@@ -405,6 +932,7 @@ namespace HeapFile {
       else {
         // page exists, so choose the next page entry
         resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
+        pageBuffer = nullptr;
         if (pageEntryIndex + 1 >= pd->numberOfEntries) {
           return false;
         }
@@ -432,11 +960,20 @@ namespace HeapFile {
       3.5 There is next page
       3.6 no next page
 
+      The search of the current page directory starts at startEntryIndex, later page directories are searched from the start.
+
+      A page is only chosen while the bytes it uses stay below the fill target, so the last reserved bytes
+      of every page are kept free. The reserve is checked against the used bytes of the page and not added
+      to the record size, so an empty page always takes the record however low the fill factor is.
+
       return true if pages were added
       , false if no pages were added.
     */
-    bool traverseFromStartTilFindSpace(u32 recordSize) {
-      u32 requiredSize = recordSize + sizeof(Slot);
+    bool traverseFromStartTilFindSpace(u32 recordSize, u32 startEntryIndex = 0, u32 reserved = 0) {
+      // rows of a PAX page have no slot
+      u32 requiredSize = recordSize + (isPax() ? 0 : sizeof(Slot));
+      u32 blockSize = resourceManager->fm.getBlockSize();
+      u32 pageCapacity = blockSize - TuplePage::headerSize(blockSize);
       u32 remainingPageDirSize;
       u64 pageNumberChosen = u64Max;
       PageDirectory* pd;
@@ -444,8 +981,11 @@ namespace HeapFile {
       do {
         pd = reinterpret_cast<PageDirectory*>(pageDirBuffer->bufferData.data());
         pageEntryList = reinterpret_cast<PageEntry*>(pageDirBuffer->bufferData.data() + sizeof(PageDirectory));
-        for (u32 i = 0; i < pd->numberOfEntries; ++i) {
-          if (pageEntryList[i].freeSpace >= requiredSize) {
+        for (u32 i = startEntryIndex; i < pd->numberOfEntries; ++i) {
+          u32 freeSpace = pageEntryList[i].freeSpace;
+          u32 usedSpace = pageCapacity - std::min(freeSpace, pageCapacity);
+          bool belowFillTarget = reserved == 0 || usedSpace == 0 || usedSpace + requiredSize + reserved <= pageCapacity;
+          if (freeSpace >= requiredSize && belowFillTarget) {
             // unpin the current page buffer
             if (pageBuffer) {
               resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
@@ -467,22 +1007,18 @@ namespace HeapFile {
         if (hasSpaceForPageEntry || foundGoodPageEntry) {
           break;
         }
+        startEntryIndex = 0;
       } while (this->nextDir());
 
       // no good page entry found
       if (pageNumberChosen == u64Max) {
-        TuplePage tp{ 0, resourceManager->fm.getBlockSize(), 0, resourceManager->fm.getBlockSize() };
-        u32 freeSpace = resourceManager->fm.getBlockSize() - ((u32)sizeof(TuplePage));
+        u32 entriesPerDirectory = PageDirectory::entriesPerDirectory(resourceManager->fm.getBlockSize());
+        u32 freeSpace;
 
         // add a new page and corresponding page entry
         if (remainingPageDirSize >= sizeof(PageEntry)) {
           u32 lastPageNumber = resourceManager->fm.append(filename) - 1;
 
-          // add the page entry to page directory page
-          PageEntry newPageEntry{ lastPageNumber, freeSpace };
-          pageDirBuffer->modify(&newPageEntry, sizeof(PageEntry), sizeof(PageDirectory) + (pd->numberOfEntries * sizeof(PageEntry)));
-          pd->numberOfEntries += 1;
-
           if (pageBuffer) {
             resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
           }
@@ -490,7 +1026,12 @@ namespace HeapFile {
           // add the tuple header to the tuple page.
           this->pageBufferId = PageId{ filename, lastPageNumber };
           pageBuffer = resourceManager->bm.pin(resourceManager->fm, this->pageBufferId);
-          pageBuffer->modify(&tp, sizeof(TuplePage), 0);
+          freeSpace = initializeHeapPage(pageBuffer, directoryIndex * entriesPerDirectory + pd->numberOfEntries, getPaxColumns());
+
+          // add the page entry to page directory page
+          PageEntry newPageEntry{ lastPageNumber, freeSpace };
+          pageDirBuffer->modify(&newPageEntry, sizeof(PageEntry), sizeof(PageDirectory) + (pd->numberOfEntries * sizeof(PageEntry)));
+          pd->numberOfEntries += 1;
           pageEntryIndex = pd->numberOfEntries - 1;
         }
         else {
@@ -499,40 +1040,29 @@ namespace HeapFile {
           u32 lastPageNumber = resourceManager->fm.append(filename, numPages);
           u32 dirPageNumber = lastPageNumber - numPages;
 
-          // unpin current page directory
-          resourceManager->bm.unpin(resourceManager->fm, pageDirBuffer->pageId);
+          // register the new page directory in the page directory index, then move to it
+          u64 newDirectoryIndex = addPageDirectory(*resourceManager, filename, dirPageNumber);
+          moveToDir(newDirectoryIndex, dirPageNumber);
 
-          // pin new page directory buffer
-          pageDirectoryId = PageId{ filename, dirPageNumber };
-          pageDirBuffer = resourceManager->bm.pin(resourceManager->fm, pageDirectoryId);
+          PageDirectory newPd{ newDirectoryIndex, numPages - 1 };
 
-          PageDirectory newPd{ dirPageNumber, u64Max, 0 };
-          std::strncpy(newPd.tableName, filename.c_str(), 128);
+          if (pageBuffer) {
+            resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
+          }
 
-          // Add page entries to the page directory
+          // Add tuple header for each page and its page entry to the page directory
           std::vector<PageEntry> pe;
           for (u64 i = 1; i <= numPages - 1; ++i) {
-            u32 pageEntryPageNumber = dirPageNumber + i;
-            pe.push_back(PageEntry{ pageEntryPageNumber, freeSpace });
+            PageId tuplePageId{ filename, dirPageNumber + i };
+            pageBuffer = resourceManager->bm.pin(resourceManager->fm, tuplePageId);
+            freeSpace = initializeHeapPage(pageBuffer, newDirectoryIndex * entriesPerDirectory + pe.size(), getPaxColumns());
+            resourceManager->bm.unpin(resourceManager->fm, tuplePageId);
+            pe.push_back(PageEntry{ tuplePageId.pageNumber, freeSpace });
           }
 
           // flush into memory
           pageDirBuffer->modify(&newPd, sizeof(PageDirectory), 0);
           pageDirBuffer->modify(pe.data(), sizeof(PageEntry) * pe.size(), sizeof(PageDirectory));
-          pd->numberOfEntries += numPages - 1;
-
-          // Add tuple header for each page
-          if (pageBuffer) {
-            resourceManager->bm.unpin(resourceManager->fm, pageBuffer->pageId);
-          }
-
-          // Add tuple header for each page 
-          for (auto pageEntry : pe) {
-            PageId tuplePageId{ filename, pageEntry.pageNumber };
-            pageBuffer = resourceManager->bm.pin(resourceManager->fm, tuplePageId);
-            pageBuffer->modify(&tp, sizeof(TuplePage), 0);
-            resourceManager->bm.unpin(resourceManager->fm, tuplePageId);
-          }
 
           // pin the page buffer
           this->pageBufferId = PageId{ filename, pe[0].pageNumber };
@@ -546,6 +1076,14 @@ namespace HeapFile {
       return false;
     };
 
+    // move to another page directory, the page buffer is left as is.
+    void moveToDir(u64 newDirectoryIndex, u64 directoryPageNumber) {
+      resourceManager->bm.unpin(resourceManager->fm, pageDirBuffer->pageId);
+      directoryIndex = newDirectoryIndex;
+      pageDirectoryId = PageId{ filename, directoryPageNumber };
+      pageDirBuffer = resourceManager->bm.pin(resourceManager->fm, pageDirectoryId);
+    }
+
     bool canDirStorePageEntry() {
       const PageDirectory* pd = reinterpret_cast<PageDirectory*>(pageDirBuffer->bufferData.data());
       u32 remainingSize = resourceManager->fm.getBlockSize() - sizeof(PageDirectory) - (pd->numberOfEntries * sizeof(PageEntry));
@@ -553,7 +1091,101 @@ namespace HeapFile {
     }
   };
 
-  void insertTuple(ResourceManager& rm, const std::string& filename, Tuple& tuple);
-  void insertTuples(std::shared_ptr<ResourceManager>& rm, const std::string& filename, std::vector<Tuple>& tuples);
-  void insertTuples(HeapFile::HeapFileIterator& iter, std::vector<Tuple>& tuples);
+  /**
+  Replace the heap file with a new heap file, e.g. one rewritten by VACUUM.
+
+  The new file is flushed and renamed over the old one, so the swap is atomic on disk.
+  Both files must not have any pinned buffers.
+  */
+  void replaceHeapFile(ResourceManager& rm, const std::string& filename, const std::string& newFilename);
+
+  /**
+  Empty the heap file by resetting it to the layout of a new heap file, the fill factor is kept.
+
+  Cached buffers of the file are dropped without being written and the overflow and dictionary files are removed,
+  so the cost does not depend on the size of the table. The file must not have any pinned buffers.
+  */
+  void truncateHeapFile(ResourceManager& rm, const std::string& filename);
+
+  /**
+  Slide the live tuples of a tuple page together at the end of the page and fix their slot offsets
+  and lastOccupiedPosition, so the space left behind by deleted or relocated tuples is contiguous again.
+
+  Returns the free space of the page after compaction.
+  */
+  u32 compactTuplePage(BufferFrame* tupleFrame);
+
+  // the overflow file of a heap file, it is only created once the first value is moved out of line.
+  std::string overflowFilename(const std::string& filename);
+
+  // the dictionary file of a heap file, it is only created once the first value is encoded.
+  std::string dictionaryFilename(const std::string& filename);
+
+  // the cached dictionary of the heap file, it is read from the dictionary file the first time.
+  std::shared_ptr<Dictionary> getDictionary(ResourceManager& rm, const std::string& filename);
+
+  // give every DICT value of the tuple the code of its value in the dictionary of the heap file, new values are added.
+  void encodeDictionaryFields(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Tuple& tuple);
+
+  // write the value to a new chain of overflow pages, returns the first page of the chain.
+  // free pages are reused first, the file only grows by the pages that are still missing.
+  u64 writeOverflow(ResourceManager& rm, const std::string& filename, const std::string& value);
+
+  // add the pages of the chain to the free pages of the overflow file.
+  void freeOverflow(ResourceManager& rm, const std::string& filename, u64 firstPage);
+
+  std::string readOverflow(ResourceManager& rm, const std::string& filename, u64 firstPage, u32 valueLength);
+
+  /**
+  Move varchar values of the tuple to the overflow file until the tuple fits in an empty tuple page.
+
+  Values larger than a quarter of a page always go out of line, so a single large value does not
+  leave most of the page unusable. Overflow values read from another heap file are brought back
+  inline first.
+  The new fields come from the current ArenaScope, a tuple that outlives the arena is moved outside of it.
+  */
+  void moveLargeFieldsOutOfLine(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Tuple& tuple);
+
+  // read the tuple in the slot, a forwarding slot is followed to the page the tuple was moved to.
+  Tuple readTuple(std::shared_ptr<ResourceManager>& rm, Schema& schema, const std::shared_ptr<HeapFileSource>& source,
+    BufferFrame* tupleFrame, u32 slotIdx);
+  // view the tuple in the slot in place, the frame must stay pinned while the view is used.
+  // a forwarded tuple is read into a tuple instead, its page is not kept pinned.
+  TupleView viewTuple(std::shared_ptr<ResourceManager>& rm, Schema& schema, const std::vector<ReadField*>& readFields,
+    const std::shared_ptr<HeapFileSource>& source, BufferFrame* tupleFrame, u32 slotIdx);
+
+  // update or erase the tuple in the slot of the page the iterator is at, pushIter moves tuples that outgrow the page.
+  // the overflow chains of the old row that are erased or replaced are freed, the schema finds its VARCHAR columns.
+  // the RID functions below share the same code, see updateRow and eraseRow in buffer.cpp.
+  void updateTuple(HeapFile::HeapFileIterator& iter, HeapFile::HeapFileIterator& pushIter, Schema& schema, u32 slotIdx, Tuple& tuple);
+  bool eraseTuple(HeapFile::HeapFileIterator& iter, Schema& schema, u32 slotIdx);
+
+  /**
+  Point access to a single row by its RID, without scanning the table.
+
+  Each of them pins the page of the row (and the page it was moved to if the row was forwarded).
+  update and erase change the free space in the page entry once the page is unpinned, its page directory
+  is found from the page index in the page header. Only a row that outgrows its page walks the page directories.
+  A RID that does not point to a row throws. Like updateTuple and eraseTuple they free the overflow chains the row no longer uses.
+  */
+  Tuple fetch(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Schema& schema, RID rid);
+  void update(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Schema& schema, RID rid, Tuple& tuple);
+  void erase(std::shared_ptr<ResourceManager>& rm, const std::string& filename, Schema& schema, RID rid);
+
+  // insert one tuple starting from the current position of the iterator, returns where it was placed.
+  // the codec of the table, if it has one, writes the row. such a row never has values to move out of line.
+  RID insertTuple(HeapFile::HeapFileIterator& iter, Tuple& tuple, RowCodec* codec = nullptr);
+
+  void insertTuples(std::shared_ptr<ResourceManager>& rm, const std::string& filename, std::vector<Tuple>& tuples, RowCodec* codec = nullptr);
+  void insertTuples(HeapFile::HeapFileIterator& iter, std::vector<Tuple>& tuples, RowCodec* codec = nullptr);
+
+  /**
+  Bulk load tuples into the heap file, keeping their order.
+
+  Tuple pages are filled sequentially in a private buffer and written out through the FileManager
+  one page directory (and all of its pages) at a time, bypassing the buffer pool.
+  The last page directory is filled up first, its page entries are added once its new pages have been written.
+  Each new page directory is only added to a page directory index once all of its pages have been written.
+  */
+  void bulkLoad(std::shared_ptr<ResourceManager>& rm, const std::string& filename, std::vector<Tuple>& tuples);
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "codec.h"
+
+std::unique_ptr<RowCodec> RowCodec::create(Schema& schema) {
+  if (schema.fieldList.empty()) {
+    return nullptr;
+  }
+  std::vector<FixedColumn> columns;
+  for (auto& fieldName : schema.fieldList) {
+    ReadField* readField = schema.fieldMap.at(fieldName).get();
+    if (dynamic_cast<ReadIntField*>(readField)) {
+      columns.push_back(FixedColumn{ FixedColumn::Kind::INT, 0, sizeof(i32) });
+    }
+    else if (auto charField = dynamic_cast<ReadFixedCharField*>(readField)) {
+      columns.push_back(FixedColumn{ FixedColumn::Kind::CHAR, 0, charField->getCharLength() });
+    }
+    else {
+      return nullptr;
+    }
+  }
+  return std::make_unique<SchemaRowCodec>(std::move(columns));
+}
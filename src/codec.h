@@ -0,0 +1,248 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "query.h"
+
+/**
+Row codecs for schemas made only of fixed width columns (INT and CHAR(n)).
+
+The columns of a codec are its template parameters, FixedRowCodec<Int, Char<20>, Int> knows the kind of
+every column at compile time and, when every length is known as well, the offset of every column.
+Every row of such a schema has the same size and the same row header. Decoding a row is a memcpy per
+column into the fields of a tuple made once by makeTuple, there is no virtual ReadField::get, no row
+header lookup and no allocation per column.
+
+The lengths of Char<> columns are given to the codec when it is made and the offsets after them are
+computed once.
+
+Schemas read at run time get a SchemaRowCodec instead, it handles any number and mix of INT and CHAR(n)
+columns with a table of the kind, offset and length of every column, so no class is instantiated per
+shape. Decoding a row is still a memcpy per column into the fields made by makeTuple.
+*/
+
+// an INT column of a FixedRowCodec.
+struct Int {
+  static constexpr u32 length = sizeof(i32);
+};
+
+// a CHAR(Length) column of a FixedRowCodec, the length of Char<> is given when the codec is made.
+template <u32 Length = 0>
+struct Char {
+  static constexpr u32 length = Length;
+};
+
+// a column of a SchemaRowCodec.
+struct FixedColumn {
+  enum class Kind : u8 { INT, CHAR };
+  Kind kind;
+  // from the start of the row, past the row header
+  u32 offset;
+  u32 length;
+};
+
+class RowCodec {
+public:
+  virtual ~RowCodec() = default;
+  // a tuple with a field for every column, rows are decoded into it in place.
+  virtual Tuple makeTuple() = 0;
+  // overwrite the fields of a tuple made by makeTuple of this codec with the row, nothing is allocated.
+  virtual void decode(const char* row, Tuple& tuple) = 0;
+  virtual void encode(Tuple& tuple, char* buffer, u32 offset) = 0;
+  virtual u32 getRecordSize() = 0;
+
+  // decode the row into a new tuple.
+  Tuple decode(const char* row) {
+    Tuple tuple = makeTuple();
+    decode(row, tuple);
+    return tuple;
+  }
+
+  // the codec of the schema, nullptr if the schema has a column that is not INT or CHAR(n).
+  static std::unique_ptr<RowCodec> create(Schema& schema);
+};
+
+template <typename... Columns>
+class FixedRowCodec : public RowCodec {
+  static constexpr u32 N = sizeof...(Columns);
+  static constexpr std::array<u32, N> staticLengths{ Columns::length... };
+  // every offset is known at compile time if no column is a Char<>
+  static constexpr bool hasStaticOffsets = ((Columns::length != 0) && ...);
+  static constexpr std::array<u32, N> staticOffsets = [] {
+    std::array<u32, N> offsets{};
+    u32 offset = RowHeader::size(N);
+    for (u32 i = 0; i < N; ++i) {
+      offsets[i] = offset;
+      offset += staticLengths[i];
+    }
+    return offsets;
+  }();
+
+  template <std::size_t I>
+  using Column = std::tuple_element_t<I, std::tuple<Columns...>>;
+
+  std::array<u32, N> lengths;
+  std::array<u32, N> offsets;
+  // the row header is the same for every row, it is copied in one go
+  std::array<char, RowHeader::size(N)> rowHeader;
+  u32 recordSize;
+
+  template <std::size_t I>
+  u32 offsetOf() const {
+    if constexpr (hasStaticOffsets) {
+      return staticOffsets[I];
+    }
+    else {
+      return offsets[I];
+    }
+  }
+
+  template <std::size_t I>
+  u32 lengthOf() const {
+    if constexpr (Column<I>::length != 0) {
+      return Column<I>::length;
+    }
+    else {
+      return lengths[I];
+    }
+  }
+
+  template <std::size_t I>
+  std::unique_ptr<WriteField> makeField() {
+    if constexpr (std::is_same_v<Column<I>, Int>) {
+      return std::make_unique<IntField>(0);
+    }
+    else {
+      return std::make_unique<FixedCharField>(lengthOf<I>(), std::string());
+    }
+  }
+
+  template <std::size_t I>
+  void decodeColumn(const char* row, WriteField* field) {
+    if constexpr (std::is_same_v<Column<I>, Int>) {
+      i32 value;
+      std::memcpy(&value, row + offsetOf<I>(), sizeof(i32));
+      static_cast<IntField*>(field)->setValue(value);
+    }
+    else {
+      const char* value = row + offsetOf<I>();
+      static_cast<FixedCharField*>(field)->setValue(value, strnlen(value, lengthOf<I>()));
+    }
+  }
+
+  template <std::size_t... I>
+  Tuple makeColumns(std::index_sequence<I...>) {
+    Tuple::Fields fields(ArenaScope::getResource());
+    fields.reserve(N);
+    (fields.push_back(makeField<I>()), ...);
+    return Tuple(std::move(fields), recordSize);
+  }
+
+  template <std::size_t... I>
+  void decodeColumns(const char* row, Tuple& tuple, std::index_sequence<I...>) {
+    (decodeColumn<I>(row, tuple.fields[I].get()), ...);
+  }
+
+  template <std::size_t... I>
+  void encodeColumns(Tuple& tuple, char* row, std::index_sequence<I...>) {
+    (tuple.fields[I]->write(row, offsetOf<I>()), ...);
+  }
+
+public:
+  // columnLengths are only read for the Char<> columns.
+  FixedRowCodec(const std::array<u32, N>& columnLengths = {}) {
+    recordSize = RowHeader::size(N);
+    rowHeader.fill(0);
+    for (u32 i = 0; i < N; ++i) {
+      lengths[i] = staticLengths[i] != 0 ? staticLengths[i] : columnLengths[i];
+      offsets[i] = recordSize;
+      u16 storedOffset = (u16)offsets[i];
+      std::memcpy(rowHeader.data() + i * sizeof(u16), &storedOffset, sizeof(u16));
+      recordSize += lengths[i];
+    }
+  }
+
+  virtual Tuple makeTuple() override {
+    return makeColumns(std::make_index_sequence<N>{});
+  }
+
+  virtual void decode(const char* row, Tuple& tuple) override {
+    decodeColumns(row, tuple, std::make_index_sequence<N>{});
+  }
+  using RowCodec::decode;
+
+  virtual void encode(Tuple& tuple, char* buffer, u32 offset) override {
+    std::memcpy(buffer + offset, rowHeader.data(), rowHeader.size());
+    encodeColumns(tuple, buffer + offset, std::make_index_sequence<N>{});
+  }
+
+  virtual u32 getRecordSize() override {
+    return recordSize;
+  }
+};
+
+// the codec of a schema read at run time, its columns are a table instead of template parameters.
+class SchemaRowCodec : public RowCodec {
+  std::vector<FixedColumn> columns;
+  // the row header is the same for every row, it is copied in one go
+  std::vector<char> rowHeader;
+  u32 recordSize;
+
+public:
+  // the offsets of the columns are computed from their lengths, the offset of each given column is ignored.
+  SchemaRowCodec(std::vector<FixedColumn> fixedColumns) : columns{ std::move(fixedColumns) } {
+    u32 numberOfColumns = (u32)columns.size();
+    recordSize = RowHeader::size(numberOfColumns);
+    rowHeader.assign(recordSize, 0);
+    for (u32 i = 0; i < numberOfColumns; ++i) {
+      columns[i].offset = recordSize;
+      u16 storedOffset = (u16)recordSize;
+      std::memcpy(rowHeader.data() + i * sizeof(u16), &storedOffset, sizeof(u16));
+      recordSize += columns[i].length;
+    }
+  }
+
+  virtual Tuple makeTuple() override {
+    Tuple::Fields fields(ArenaScope::getResource());
+    fields.reserve(columns.size());
+    for (auto& column : columns) {
+      if (column.kind == FixedColumn::Kind::INT) {
+        fields.push_back(std::make_unique<IntField>(0));
+      }
+      else {
+        fields.push_back(std::make_unique<FixedCharField>(column.length, std::string()));
+      }
+    }
+    return Tuple(std::move(fields), recordSize);
+  }
+
+  virtual void decode(const char* row, Tuple& tuple) override {
+    for (u32 i = 0; i < columns.size(); ++i) {
+      const FixedColumn& column = columns[i];
+      const char* value = row + column.offset;
+      if (column.kind == FixedColumn::Kind::INT) {
+        i32 number;
+        std::memcpy(&number, value, sizeof(i32));
+        static_cast<IntField*>(tuple.fields[i].get())->setValue(number);
+      }
+      else {
+        static_cast<FixedCharField*>(tuple.fields[i].get())->setValue(value, strnlen(value, column.length));
+      }
+    }
+  }
+  using RowCodec::decode;
+
+  virtual void encode(Tuple& tuple, char* buffer, u32 offset) override {
+    std::memcpy(buffer + offset, rowHeader.data(), rowHeader.size());
+    for (u32 i = 0; i < columns.size(); ++i) {
+      tuple.fields[i]->write(buffer + offset, columns[i].offset);
+    }
+  }
+
+  virtual u32 getRecordSize() override {
+    return recordSize;
+  }
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 
 using u8 = std::uint8_t;
 using u16 = std::uint16_t;
@@ -9,6 +10,7 @@ using u64 = std::uint64_t;
 using i8 = std::int8_t;
 using i16 = std::int16_t;
 using i32 = std::int32_t;
+using i64 = std::int64_t;
 
 
 const static u8 u8Max = std::numeric_limits<u8>::max();
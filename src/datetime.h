@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "common.h"
+
+/**
+DATE values are stored as days since 1970-01-01 and TIMESTAMP values as microseconds since
+1970-01-01 00:00:00, without a time zone. Both are plain integers once stored, so comparing
+them is an integer comparison.
+
+They are written as "YYYY-MM-DD" and "YYYY-MM-DD HH:MM:SS[.ffffff]" ('T' may separate the date and the time).
+*/
+namespace DateTime {
+  constexpr i64 MICROSECONDS_PER_SECOND = 1000000;
+  constexpr i64 MICROSECONDS_PER_DAY = 86400 * MICROSECONDS_PER_SECOND;
+
+  // read exactly digits digits at pos.
+  inline bool readDigits(std::string_view text, size_t& pos, u32 digits, int& value) {
+    if (pos + digits > text.size()) {
+      return false;
+    }
+    value = 0;
+    for (u32 i = 0; i < digits; ++i) {
+      char c = text[pos + i];
+      if (c < '0' || c > '9') {
+        return false;
+      }
+      value = value * 10 + (c - '0');
+    }
+    pos += digits;
+    return true;
+  }
+
+  inline bool readSeparator(std::string_view text, size_t& pos, char separator) {
+    if (pos >= text.size() || text[pos] != separator) {
+      return false;
+    }
+    pos += 1;
+    return true;
+  }
+
+  inline std::optional<i32> parseDate(std::string_view text, size_t& pos) {
+    int year, month, day;
+    if (!readDigits(text, pos, 4, year) || !readSeparator(text, pos, '-') || !readDigits(text, pos, 2, month) ||
+      !readSeparator(text, pos, '-') || !readDigits(text, pos, 2, day)) {
+      return std::nullopt;
+    }
+    std::chrono::year_month_day date{ std::chrono::year(year), std::chrono::month(month), std::chrono::day(day) };
+    if (!date.ok()) {
+      return std::nullopt;
+    }
+    return (i32)std::chrono::sys_days(date).time_since_epoch().count();
+  }
+
+  inline std::optional<i32> parseDate(std::string_view text) {
+    size_t pos = 0;
+    auto days = parseDate(text, pos);
+    if (!days || pos != text.size()) {
+      return std::nullopt;
+    }
+    return days;
+  }
+
+  // a date alone is midnight of that day.
+  inline std::optional<i64> parseTimestamp(std::string_view text) {
+    size_t pos = 0;
+    auto days = parseDate(text, pos);
+    if (!days) {
+      return std::nullopt;
+    }
+    i64 timestamp = *days * MICROSECONDS_PER_DAY;
+    if (pos == text.size()) {
+      return timestamp;
+    }
+
+    int hours, minutes, seconds;
+    if ((!readSeparator(text, pos, ' ') && !readSeparator(text, pos, 'T')) || !readDigits(text, pos, 2, hours) ||
+      !readSeparator(text, pos, ':') || !readDigits(text, pos, 2, minutes) ||
+      !readSeparator(text, pos, ':') || !readDigits(text, pos, 2, seconds) ||
+      hours > 23 || minutes > 59 || seconds > 59) {
+      return std::nullopt;
+    }
+    timestamp += ((hours * 60 + minutes) * 60 + seconds) * MICROSECONDS_PER_SECOND;
+
+    if (readSeparator(text, pos, '.')) {
+      i64 fraction = MICROSECONDS_PER_SECOND;
+      size_t start = pos;
+      while (pos < text.size() && pos - start < 6 && text[pos] >= '0' && text[pos] <= '9') {
+        fraction /= 10;
+        timestamp += (text[pos] - '0') * fraction;
+        pos += 1;
+      }
+      if (pos == start) {
+        return std::nullopt;
+      }
+    }
+    if (pos != text.size()) {
+      return std::nullopt;
+    }
+    return timestamp;
+  }
+
+  inline std::string formatDate(i32 days) {
+    std::chrono::year_month_day date{ std::chrono::sys_days(std::chrono::days(days)) };
+    char text[16];
+    std::snprintf(text, sizeof(text), "%04d-%02u-%02u", (int)date.year(), (unsigned)date.month(), (unsigned)date.day());
+    return text;
+  }
+
+  // the fraction is only written if there is one.
+  inline std::string formatTimestamp(i64 timestamp) {
+    i64 days = timestamp / MICROSECONDS_PER_DAY;
+    i64 timeOfDay = timestamp % MICROSECONDS_PER_DAY;
+    if (timeOfDay < 0) {
+      days -= 1;
+      timeOfDay += MICROSECONDS_PER_DAY;
+    }
+    i64 seconds = timeOfDay / MICROSECONDS_PER_SECOND;
+    i64 fraction = timeOfDay % MICROSECONDS_PER_SECOND;
+
+    char text[32];
+    if (fraction == 0) {
+      std::snprintf(text, sizeof(text), " %02d:%02d:%02d", (int)(seconds / 3600), (int)(seconds / 60 % 60), (int)(seconds % 60));
+    }
+    else {
+      std::snprintf(text, sizeof(text), " %02d:%02d:%02d.%06d", (int)(seconds / 3600), (int)(seconds / 60 % 60), (int)(seconds % 60), (int)fraction);
+    }
+    return formatDate((i32)days) + text;
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "common.h"
+
+/**
+The values of the dictionary encoded (DICT) columns of a table.
+
+A row stores the code of its value instead of the value, equal values have equal codes, so
+columns with few distinct values take 2 bytes per row and equality is a comparison of codes.
+The dictionary is kept in the dictionary file of the table and cached by the ResourceManager,
+see HeapFile::getDictionary. Codes are never reused or removed.
+*/
+class Dictionary {
+  // a deque keeps its values in place as it grows, the codes refer to them
+  std::deque<std::string> values;
+  std::unordered_map<std::string_view, u32> codes;
+
+public:
+  // the code of a value that is not in the dictionary, it is equal to no stored code
+  static constexpr u32 NO_CODE = u32Max;
+  // codes are stored as u16
+  static constexpr u32 MAX_VALUES = 1 << 16;
+
+  Dictionary() = default;
+  Dictionary(const Dictionary&) = delete;
+  Dictionary& operator=(const Dictionary&) = delete;
+
+  u32 find(std::string_view value) const {
+    auto code = codes.find(value);
+    return code == codes.end() ? NO_CODE : code->second;
+  }
+
+  // add a value that is not in the dictionary yet and return its code.
+  u32 add(std::string value) {
+    if (values.size() >= MAX_VALUES) {
+      throw std::runtime_error("Dictionary is full");
+    }
+    u32 code = (u32)values.size();
+    values.push_back(std::move(value));
+    codes.emplace(values.back(), code);
+    return code;
+  }
+
+  const std::string& decode(u32 code) const {
+    if (code >= values.size()) {
+      throw std::runtime_error("Dictionary code does not exist");
+    }
+    return values[code];
+  }
+
+  u32 size() const {
+    return (u32)values.size();
+  }
+};
@@ -2,10 +2,14 @@
 
 
 #include <variant>
+#include <optional>
+#include <chrono>
+#include <sstream>
 
 #include "parser.h"
 #include "query.h"
 #include "buffer.h"
+#include "codec.h"
 #include "./scan/scan.h"
 #include "./scan/TableScan.h"
 #include "./scan/ProductScan.h"
@@ -55,19 +59,63 @@ public:
   }
 
   std::tuple<std::vector<Tuple>, std::string> execute(std::string sqlStmt) {
-    Parser parser(sqlStmt);
-    Parser::StatementVariant stmt = parser.parseStatement();
+    std::tuple<std::vector<Tuple>, std::string> result;
+    {
+      Parser parser(sqlStmt);
+      Parser::StatementVariant stmt = parser.parseStatement();
+      // the schemas, scans and constants a DML statement makes come from the statement arena, what is made
+      // for a single row comes from the row arena, see forEachRow. the statement arena is only released below,
+      // once everything the statement made is gone. VACUUM keeps its rows across batches and runs outside both.
+      bool isDml = std::holds_alternative<Query>(stmt) || std::holds_alternative<Insert>(stmt)
+        || std::holds_alternative<UpdateStmt>(stmt) || std::holds_alternative<DeleteStmt>(stmt);
+      // unknown columns and mismatched types are found while the scans are built, before any row is read
+      try {
+        std::optional<ArenaScope> arenaScope;
+        if (isDml) {
+          arenaScope.emplace(arena);
+        }
+        result = executeStatement(stmt);
+      }
+      catch (const BindError& error) {
+        result = { std::vector<Tuple>{}, std::string(error.what()) + "\n" };
+      }
+    }
+    rowArena.release();
+    arena.release();
+    return result;
+  }
+
+private:
+  // run fn on every row of the scan. what the scan and fn allocate for a row comes from the row arena,
+  // which is released once the row is done, so a statement over N rows does not keep N rows of garbage.
+  // nothing allocated for a row may be kept past it, rows that are kept are made under ArenaScope(nullptr).
+  template <typename Fn>
+  void forEachRow(Scan& scan, Fn fn) {
+    scan.getFirst();
+    while (true) {
+      {
+        ArenaScope rowScope(rowArena);
+        if (!scan.next()) {
+          break;
+        }
+        fn();
+      }
+      rowArena.release();
+    }
+  }
+
+  std::tuple<std::vector<Tuple>, std::string> executeStatement(Parser::StatementVariant& stmt) {
     if (std::holds_alternative<Query>(stmt)) {
       // QUERY
       auto& queryStmt = std::get<Query>(stmt);
       auto scan = createBasicScan(queryStmt);
 
+      // the rows returned by get() are kept after the statement, they come from the heap
       std::vector<Tuple> tuples;
-      scan->getFirst();
-      while (scan->next()) {
-        auto tuple = scan->get();
-        tuples.push_back(std::move(tuple));
-      }
+      forEachRow(*scan, [&] {
+        ArenaScope heapScope(nullptr);
+        tuples.push_back(scan->get());
+      });
       return { std::move(tuples), "" };
     }
     else if (std::holds_alternative<Insert>(stmt)) {
@@ -75,11 +123,15 @@ public:
       auto& insertStmt = std::get<Insert>(stmt);
       auto schemaMap = getSchemaFromTableName({ insertStmt.table }, resourceManager);
       auto schema = schemaMap.at(insertStmt.table);
+      // the inserted rows are returned, they come from the heap. the insert replaces the fields of
+      // values it moves to overflow pages, so it runs outside the arena as well
+      auto codec = RowCodec::create(schema);
+      ArenaScope heapScope(nullptr);
       std::vector<Tuple> tuples;
       for (auto& tokenList : insertStmt.values) {
         tuples.push_back(schema.createTuple(tokenList));
       }
-      HeapFile::insertTuples(resourceManager, insertStmt.table, tuples);
+      HeapFile::insertTuples(resourceManager, insertStmt.table, tuples, codec.get());
 
       return { std::move(tuples), "" };
     }
@@ -90,7 +142,7 @@ public:
       auto schema = schemaMap.at(updateStmt.table);
 
       std::unique_ptr<ModifyScan> scan = std::make_unique<ModifyTableScan>(updateStmt.table, resourceManager, schema);
-
+      updateStmt.bind(scan->getSchema());
 
       if (updateStmt.predicate.size() > 0) {
         std::unique_ptr<Predicate> pred = std::move(updateStmt.predicate.at(0));
@@ -104,10 +156,9 @@ public:
       }
 
 
-      scan->getFirst();
-      while (scan->next()) {
+      forEachRow(*scan, [&] {
         scan->update(updateStmt);
-      }
+      });
 
       return { std::vector<Tuple>{}, "" };
     }
@@ -130,12 +181,76 @@ public:
         scan = std::make_unique<SelectModifyScan>(std::move(scan), std::move(pred));
       }
 
-      scan->getFirst();
-      while (scan->next()) {
-        auto tuple = scan->get();
+      forEachRow(*scan, [&] {
         scan->deleteTuple();
+      });
+
+      return { std::vector<Tuple>{}, "" };
+    }
+    else if (std::holds_alternative<VacuumStmt>(stmt)) {
+      // VACUUM
+      auto& vacuumStmt = std::get<VacuumStmt>(stmt);
+      auto schemaMap = getSchemaFromTableName({ vacuumStmt.table }, resourceManager);
+      if (schemaMap.size() == 0) {
+        return { std::vector<Tuple>{}, "Table does not exist\n" };
+      }
+      auto& schema = schemaMap.at(vacuumStmt.table);
+
+      auto start = std::chrono::steady_clock::now();
+      u32 pagesBefore = resourceManager->fm.getNumberOfPages(vacuumStmt.table);
+
+      // rewrite the live tuples densely packed into a new heap file and swap it in
+      std::string newFilename = vacuumStmt.table + ".vacuum";
+      // the files of an interrupted VACUUM, a stale dictionary would be loaded into the new file
+      for (auto& leftover : { newFilename, HeapFile::overflowFilename(newFilename), HeapFile::dictionaryFilename(newFilename) }) {
+        resourceManager->bm.discard(leftover);
+        resourceManager->fm.close(leftover);
+        if (resourceManager->fm.doesFileExists(leftover)) {
+          std::filesystem::remove(leftover);
+        }
+      }
+      resourceManager->dictionaries.erase(newFilename);
+      u32 fillFactor = HeapFile::getFillFactor(*resourceManager, vacuumStmt.table);
+      HeapFile::createHeapFile(*resourceManager, newFilename, 0, fillFactor,
+        HeapFile::getPaxColumns(*resourceManager, vacuumStmt.table));
+
+      // the tuples are read and loaded one page directory's worth at a time, the table is never held in memory
+      u32 blockSize = resourceManager->fm.getBlockSize();
+      u64 batchSize = (u64)PageDirectory::entriesPerDirectory(blockSize)
+        * (blockSize - TuplePage::headerSize(blockSize) - HeapFile::reservedSpace(blockSize, fillFactor));
+      u64 bytesInBatch = 0;
+      std::vector<Tuple> tuples;
+      TableScan scan(vacuumStmt.table, resourceManager, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        tuples.push_back(scan.get());
+        bytesInBatch += tuples.back().recordSize + sizeof(Slot);
+        if (bytesInBatch >= batchSize) {
+          HeapFile::bulkLoad(resourceManager, newFilename, tuples);
+          tuples.clear();
+          bytesInBatch = 0;
+        }
+      }
+      HeapFile::bulkLoad(resourceManager, newFilename, tuples);
+      HeapFile::replaceHeapFile(*resourceManager, vacuumStmt.table, newFilename);
+
+      u32 pagesAfter = resourceManager->fm.getNumberOfPages(vacuumStmt.table);
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+      std::stringstream msg;
+      msg << "VACUUM " << vacuumStmt.table << ": " << pagesBefore << " -> " << pagesAfter << " pages, "
+        << ((i64)pagesBefore - (i64)pagesAfter) << " pages reclaimed in " << elapsed.count() << " ms\n";
+      return { std::vector<Tuple>{}, msg.str() };
+    }
+    else if (std::holds_alternative<TruncateStmt>(stmt)) {
+      // TRUNCATE
+      auto& truncateStmt = std::get<TruncateStmt>(stmt);
+      auto schemaMap = getSchemaFromTableName({ truncateStmt.table }, resourceManager);
+      if (schemaMap.size() == 0) {
+        return { std::vector<Tuple>{}, "Table does not exist\n" };
       }
 
+      HeapFile::truncateHeapFile(*resourceManager, truncateStmt.table);
       return { std::vector<Tuple>{}, "" };
     }
     else if (std::holds_alternative<Schema>(stmt)) {
@@ -144,13 +259,20 @@ public:
       auto tuples = schema.createSchemaTuple();
 
       // check whether table already exists
-      auto schemaMap = getSchemaFromTableName({ schema.tableList.at(0) }, resourceManager);
+      auto schemaMap = getSchemaFromTableName({ std::string(schema.tableList.at(0)) }, resourceManager);
       if (schemaMap.size() > 0) {
         std::cout << "Table already exists\n";
         return { std::vector<Tuple>{} ,"Table already exists\n" };
       }
+      std::vector<u32> paxColumns;
+      if (schema.options.layout == PageLayout::PAX) {
+        paxColumns = HeapFile::paxColumnsOf(schema);
+        if (paxColumns.empty()) {
+          return { std::vector<Tuple>{}, "PAX layout needs fixed width columns\n" };
+        }
+      }
       // Base level schema, there can only be 1 and only 1 table
-      HeapFile::createHeapFile(*resourceManager, schema.tableList.at(0), 8);
+      HeapFile::createHeapFile(*resourceManager, std::string(schema.tableList.at(0)), 8, schema.options.fillFactor, paxColumns);
       HeapFile::insertTuples(resourceManager, SCHEMA_TABLE, tuples);
 
       return { std::move(tuples), "" };
@@ -159,6 +281,9 @@ public:
     return { std::vector<Tuple>{}, "" };
   }
 
-private:
   std::shared_ptr<ResourceManager> resourceManager;
+  // released after every statement, its first block is reused by the next one
+  QueryArena arena;
+  // released after every row of a statement
+  QueryArena rowArena;
 };
\ No newline at end of file
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FILTER_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#include "buffer.h"
+#include "program.h"
+
+/**
+Filter kernels that compare a whole column of a PAX page with a constant.
+
+The values of a column are stored one after the other in the minipage, so 64 rows are
+compared at once into one word of a selection bitmap, with AVX2 or SSE4.2 where the CPU has
+them and a branch free scalar loop otherwise. The bitmap has the layout of the occupancy
+bitmap of the page, the filters of a conjunction are ANDed into it and the rows that are
+left are the only ones the scan visits.
+*/
+namespace FilterKernels {
+  enum class Isa : u8 { SCALAR, SSE4, AVX2 };
+
+  enum class Type : u8 { I32, I64, F64 };
+
+  // a column compared with a constant, an I32 constant fits in an i32
+  struct ColumnFilter {
+    u32 column;
+    Type type;
+    TermOperand op;
+    i64 integer;
+    double real;
+  };
+
+  // the operators that are computed as the opposite of another one, != is not ==, <= is not > and >= is not <.
+  // only for integers, doubles are compared as they are so NaN stays false.
+  inline bool isNegated(TermOperand op) {
+    return op == TermOperand::NOT_EQUAL || op == TermOperand::LESS_EQUAL || op == TermOperand::GREATER_EQUAL;
+  }
+
+  template <typename T, typename Compare>
+  inline u64 compareScalar(const char* values, u32 count, T constant, Compare compare) {
+    u64 mask = 0;
+    for (u32 row = 0; row < count; ++row) {
+      T value;
+      std::memcpy(&value, values + row * sizeof(T), sizeof(T));
+      mask |= u64(compare(value, constant)) << row;
+    }
+    return mask;
+  }
+
+  template <typename T>
+  inline u64 compareScalar(const char* values, u32 count, TermOperand op, T constant) {
+    switch (op) {
+    case TermOperand::EQUAL:
+      return compareScalar(values, count, constant, std::equal_to<T>());
+    case TermOperand::NOT_EQUAL:
+      return compareScalar(values, count, constant, std::not_equal_to<T>());
+    case TermOperand::LESS:
+      return compareScalar(values, count, constant, std::less<T>());
+    case TermOperand::LESS_EQUAL:
+      return compareScalar(values, count, constant, std::less_equal<T>());
+    case TermOperand::GREATER:
+      return compareScalar(values, count, constant, std::greater<T>());
+    default:
+      return compareScalar(values, count, constant, std::greater_equal<T>());
+    }
+  }
+
+  // a bit for each of the count values, count is at most 64
+  inline u64 compareScalar(const ColumnFilter& filter, const char* values, u32 count) {
+    switch (filter.type) {
+    case Type::I32:
+      return compareScalar<i32>(values, count, filter.op, (i32)filter.integer);
+    case Type::I64:
+      return compareScalar<i64>(values, count, filter.op, filter.integer);
+    default:
+      return compareScalar<double>(values, count, filter.op, filter.real);
+    }
+  }
+
+#ifdef FILTER_KERNELS_X86
+  __attribute__((target("avx2"))) inline u64 compareI32Avx2(const char* values, TermOperand op, i32 constant) {
+    __m256i broadcast = _mm256_set1_epi32(constant);
+    bool isEqual = op == TermOperand::EQUAL || op == TermOperand::NOT_EQUAL;
+    bool isLess = op == TermOperand::LESS || op == TermOperand::GREATER_EQUAL;
+    u64 mask = 0;
+    for (u32 i = 0; i < 8; ++i) {
+      __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i * sizeof(__m256i)));
+      __m256i result = isEqual ? _mm256_cmpeq_epi32(value, broadcast) :
+        isLess ? _mm256_cmpgt_epi32(broadcast, value) : _mm256_cmpgt_epi32(value, broadcast);
+      mask |= u64((u32)_mm256_movemask_ps(_mm256_castsi256_ps(result))) << (i * 8);
+    }
+    return isNegated(op) ? ~mask : mask;
+  }
+
+  __attribute__((target("avx2"))) inline u64 compareI64Avx2(const char* values, TermOperand op, i64 constant) {
+    __m256i broadcast = _mm256_set1_epi64x(constant);
+    bool isEqual = op == TermOperand::EQUAL || op == TermOperand::NOT_EQUAL;
+    bool isLess = op == TermOperand::LESS || op == TermOperand::GREATER_EQUAL;
+    u64 mask = 0;
+    for (u32 i = 0; i < 16; ++i) {
+      __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i * sizeof(__m256i)));
+      __m256i result = isEqual ? _mm256_cmpeq_epi64(value, broadcast) :
+        isLess ? _mm256_cmpgt_epi64(broadcast, value) : _mm256_cmpgt_epi64(value, broadcast);
+      mask |= u64((u32)_mm256_movemask_pd(_mm256_castsi256_pd(result))) << (i * 4);
+    }
+    return isNegated(op) ? ~mask : mask;
+  }
+
+  // the predicate of _mm256_cmp_pd has to be known at compile time
+  template <int Predicate>
+  __attribute__((target("avx2"))) inline u64 compareF64Avx2(const char* values, double constant) {
+    __m256d broadcast = _mm256_set1_pd(constant);
+    u64 mask = 0;
+    for (u32 i = 0; i < 16; ++i) {
+      __m256d value = _mm256_loadu_pd(reinterpret_cast<const double*>(values + i * sizeof(__m256d)));
+      mask |= u64((u32)_mm256_movemask_pd(_mm256_cmp_pd(value, broadcast, Predicate))) << (i * 4);
+    }
+    return mask;
+  }
+
+  __attribute__((target("avx2"))) inline u64 compareF64Avx2(const char* values, TermOperand op, double constant) {
+    switch (op) {
+    case TermOperand::EQUAL:
+      return compareF64Avx2<_CMP_EQ_OQ>(values, constant);
+    case TermOperand::NOT_EQUAL:
+      return compareF64Avx2<_CMP_NEQ_UQ>(values, constant);
+    case TermOperand::LESS:
+      return compareF64Avx2<_CMP_LT_OQ>(values, constant);
+    case TermOperand::LESS_EQUAL:
+      return compareF64Avx2<_CMP_LE_OQ>(values, constant);
+    case TermOperand::GREATER:
+      return compareF64Avx2<_CMP_GT_OQ>(values, constant);
+    default:
+      return compareF64Avx2<_CMP_GE_OQ>(values, constant);
+    }
+  }
+
+  __attribute__((target("sse4.2"))) inline u64 compareI32Sse4(const char* values, TermOperand op, i32 constant) {
+    __m128i broadcast = _mm_set1_epi32(constant);
+    bool isEqual = op == TermOperand::EQUAL || op == TermOperand::NOT_EQUAL;
+    bool isLess = op == TermOperand::LESS || op == TermOperand::GREATER_EQUAL;
+    u64 mask = 0;
+    for (u32 i = 0; i < 16; ++i) {
+      __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i * sizeof(__m128i)));
+      __m128i result = isEqual ? _mm_cmpeq_epi32(value, broadcast) :
+        isLess ? _mm_cmpgt_epi32(broadcast, value) : _mm_cmpgt_epi32(value, broadcast);
+      mask |= u64((u32)_mm_movemask_ps(_mm_castsi128_ps(result))) << (i * 4);
+    }
+    return isNegated(op) ? ~mask : mask;
+  }
+
+  __attribute__((target("sse4.2"))) inline u64 compareI64Sse4(const char* values, TermOperand op, i64 constant) {
+    __m128i broadcast = _mm_set1_epi64x(constant);
+    bool isEqual = op == TermOperand::EQUAL || op == TermOperand::NOT_EQUAL;
+    bool isLess = op == TermOperand::LESS || op == TermOperand::GREATER_EQUAL;
+    u64 mask = 0;
+    for (u32 i = 0; i < 32; ++i) {
+      __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i * sizeof(__m128i)));
+      __m128i result = isEqual ? _mm_cmpeq_epi64(value, broadcast) :
+        isLess ? _mm_cmpgt_epi64(broadcast, value) : _mm_cmpgt_epi64(value, broadcast);
+      mask |= u64((u32)_mm_movemask_pd(_mm_castsi128_pd(result))) << (i * 2);
+    }
+    return isNegated(op) ? ~mask : mask;
+  }
+
+  __attribute__((target("sse4.2"))) inline u64 compareF64Sse4(const char* values, TermOperand op, double constant) {
+    __m128d broadcast = _mm_set1_pd(constant);
+    u64 mask = 0;
+    for (u32 i = 0; i < 32; ++i) {
+      __m128d value = _mm_loadu_pd(reinterpret_cast<const double*>(values + i * sizeof(__m128d)));
+      __m128d result;
+      switch (op) {
+      case TermOperand::EQUAL:
+        result = _mm_cmpeq_pd(value, broadcast);
+        break;
+      case TermOperand::NOT_EQUAL:
+        result = _mm_cmpneq_pd(value, broadcast);
+        break;
+      case TermOperand::LESS:
+        result = _mm_cmplt_pd(value, broadcast);
+        break;
+      case TermOperand::LESS_EQUAL:
+        result = _mm_cmple_pd(value, broadcast);
+        break;
+      case TermOperand::GREATER:
+        result = _mm_cmpgt_pd(value, broadcast);
+        break;
+      default:
+        result = _mm_cmpge_pd(value, broadcast);
+        break;
+      }
+      mask |= u64((u32)_mm_movemask_pd(result)) << (i * 2);
+    }
+    return mask;
+  }
+#endif
+
+  // a bit for each of the 64 values starting at values
+  inline u64 compareBlock(Isa isa, const ColumnFilter& filter, const char* values) {
+#ifdef FILTER_KERNELS_X86
+    if (isa == Isa::AVX2) {
+      switch (filter.type) {
+      case Type::I32:
+        return compareI32Avx2(values, filter.op, (i32)filter.integer);
+      case Type::I64:
+        return compareI64Avx2(values, filter.op, filter.integer);
+      default:
+        return compareF64Avx2(values, filter.op, filter.real);
+      }
+    }
+    if (isa == Isa::SSE4) {
+      switch (filter.type) {
+      case Type::I32:
+        return compareI32Sse4(values, filter.op, (i32)filter.integer);
+      case Type::I64:
+        return compareI64Sse4(values, filter.op, filter.integer);
+      default:
+        return compareF64Sse4(values, filter.op, filter.real);
+      }
+    }
+#endif
+    return compareScalar(filter, values, 64);
+  }
+
+  // the widest instructions the CPU has, looked up once
+  inline Isa bestIsa() {
+#ifdef FILTER_KERNELS_X86
+    static const Isa isa = __builtin_cpu_supports("avx2") ? Isa::AVX2 : __builtin_cpu_supports("sse4.2") ? Isa::SSE4 : Isa::SCALAR;
+    return isa;
+#else
+    return Isa::SCALAR;
+#endif
+  }
+
+  inline bool isSupported(Isa isa) {
+    return isa <= bestIsa();
+  }
+
+  // clear the bits of selection of the rows 0 to count - 1 whose value fails the filter, the values
+  // are stored one after the other. words that have no row left are not compared.
+  inline void apply(Isa isa, const ColumnFilter& filter, const char* values, u32 count, u64* selection) {
+    u32 width = filter.type == Type::I32 ? sizeof(i32) : sizeof(i64);
+    for (u32 word = 0; word * 64 < count; ++word) {
+      if (selection[word] == 0) {
+        continue;
+      }
+      u32 rows = std::min(64u, count - word * 64);
+      const char* block = values + word * 64 * width;
+      // the last block stops at the end of the minipage
+      selection[word] &= rows == 64 ? compareBlock(isa, filter, block) : compareScalar(filter, block, rows);
+    }
+  }
+}
+
+// the terms of a predicate that the filter kernels evaluate for a whole PAX page at once.
+class BatchFilter {
+  std::vector<FilterKernels::ColumnFilter> filters;
+  bool complete;
+  FilterKernels::Isa isa;
+
+public:
+  BatchFilter(PredicateProgram& program, FilterKernels::Isa isa = FilterKernels::bestIsa()) : isa{ isa } {
+    using Opcode = PredicateProgram::Opcode;
+    // the opcodes of a type are EQ, NE, LT, LE, GT, GE, one type after the other
+    static constexpr TermOperand operators[] = { TermOperand::EQUAL, TermOperand::NOT_EQUAL, TermOperand::LESS,
+      TermOperand::LESS_EQUAL, TermOperand::GREATER, TermOperand::GREATER_EQUAL };
+    for (auto& conjunct : program.getConjuncts(complete)) {
+      u8 opcode = (u8)conjunct.opcode;
+      TermOperand op = operators[(opcode - (u8)Opcode::I32_EQ) % 6];
+      if (conjunct.opcode >= Opcode::I32_EQ && conjunct.opcode <= Opcode::I32_GE &&
+        conjunct.integer >= std::numeric_limits<i32>::min() && conjunct.integer <= std::numeric_limits<i32>::max()) {
+        filters.push_back({ conjunct.column, FilterKernels::Type::I32, op, conjunct.integer, 0 });
+      }
+      else if (conjunct.opcode >= Opcode::I64_EQ && conjunct.opcode <= Opcode::I64_GE) {
+        filters.push_back({ conjunct.column, FilterKernels::Type::I64, op, conjunct.integer, 0 });
+      }
+      else if (conjunct.opcode >= Opcode::F64_EQ && conjunct.opcode <= Opcode::F64_GE) {
+        filters.push_back({ conjunct.column, FilterKernels::Type::F64, op, 0, conjunct.real });
+      }
+      else {
+        complete = false;
+      }
+    }
+  }
+
+  bool isEmpty() const {
+    return filters.empty();
+  }
+
+  // whether the rows the filter selects satisfy the whole predicate
+  bool isComplete() const {
+    return complete;
+  }
+
+  // the occupied rows of the page that pass every filter, a bitmap like the occupancy of the page
+  void select(PaxPage* page, std::vector<u64>& selection) {
+    u64* occupancy = page->occupancy();
+    selection.assign(occupancy, occupancy + PaxPage::bitmapWords(page->rowCapacity));
+    for (auto& filter : filters) {
+      FilterKernels::apply(isa, filter, page->value(filter.column, 0), page->rowCapacity, selection.data());
+    }
+  }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "common.h"
+
+/**
+The matchers of the IN and LIKE terms, both test a value without allocating.
+
+A ValueSet holds the constants of an IN list as integers, doubles or strings, the form the
+column they are compared with is read in. Short lists are kept sorted and binary searched,
+longer ones are hashed.
+
+A LikePattern is split at its '%' into segments that must appear in order, '_' matches any
+one character. The common shapes of a pattern, a constant, a prefix, a suffix or a substring
+without '_', are matched with one memcmp or a memchr driven search instead.
+*/
+class ValueSet {
+public:
+  enum class Kind : u8 { INTEGER, REAL, STRING };
+
+  // lists longer than this are hashed
+  static constexpr u32 SORTED_SIZE = 16;
+
+  ValueSet() = default;
+
+  // the set must be filled again after a copy, the hashed strings refer to the strings of the set
+  ValueSet(const ValueSet&) = delete;
+  ValueSet& operator=(const ValueSet&) = delete;
+
+  void assign(std::vector<i64> values) {
+    kind = Kind::INTEGER;
+    integers = std::move(values);
+    std::sort(integers.begin(), integers.end());
+    integerSet.clear();
+    if (integers.size() > SORTED_SIZE) {
+      integerSet.insert(integers.begin(), integers.end());
+    }
+  }
+
+  void assign(std::vector<double> values) {
+    kind = Kind::REAL;
+    reals = std::move(values);
+    std::sort(reals.begin(), reals.end());
+    realSet.clear();
+    if (reals.size() > SORTED_SIZE) {
+      realSet.insert(reals.begin(), reals.end());
+    }
+  }
+
+  void assign(std::vector<std::string> values) {
+    kind = Kind::STRING;
+    strings = std::move(values);
+    std::sort(strings.begin(), strings.end());
+    stringSet.clear();
+    if (strings.size() > SORTED_SIZE) {
+      stringSet.insert(strings.begin(), strings.end());
+    }
+  }
+
+  Kind getKind() const {
+    return kind;
+  }
+
+  bool contains(i64 value) const {
+    if (integers.size() > SORTED_SIZE) {
+      return integerSet.contains(value);
+    }
+    return std::binary_search(integers.begin(), integers.end(), value);
+  }
+
+  bool contains(double value) const {
+    if (reals.size() > SORTED_SIZE) {
+      return realSet.contains(value);
+    }
+    return std::binary_search(reals.begin(), reals.end(), value);
+  }
+
+  bool contains(std::string_view value) const {
+    if (strings.size() > SORTED_SIZE) {
+      return stringSet.contains(value);
+    }
+    auto found = std::lower_bound(strings.begin(), strings.end(), value,
+      [](const std::string& lhs, std::string_view rhs) { return std::string_view(lhs) < rhs; });
+    return found != strings.end() && *found == value;
+  }
+
+private:
+  Kind kind = Kind::INTEGER;
+  std::vector<i64> integers;
+  std::vector<double> reals;
+  std::vector<std::string> strings;
+  std::unordered_set<i64> integerSet;
+  std::unordered_set<double> realSet;
+  std::unordered_set<std::string_view> stringSet;
+};
+
+class LikePattern {
+public:
+  LikePattern() = default;
+
+  explicit LikePattern(std::string_view pattern) {
+    isAnchoredStart = pattern.empty() || pattern.front() != '%';
+    isAnchoredEnd = pattern.empty() || pattern.back() != '%';
+    size_t start = 0;
+    while (start <= pattern.size()) {
+      size_t end = std::min(pattern.find('%', start), pattern.size());
+      if (end > start) {
+        std::string_view segment = pattern.substr(start, end - start);
+        segments.push_back({ std::string(segment), segment.find('_') != std::string_view::npos });
+      }
+      start = end + 1;
+    }
+
+    bool hasWildcard = std::any_of(segments.begin(), segments.end(), [](auto& segment) { return segment.hasWildcard; });
+    if (segments.size() > 1 || hasWildcard) {
+      shape = Shape::GENERAL;
+    }
+    else if (segments.empty()) {
+      // '' matches the empty string only, '%' anything
+      shape = isAnchoredStart ? Shape::EXACT : Shape::ANY;
+    }
+    else if (isAnchoredStart && isAnchoredEnd) {
+      shape = Shape::EXACT;
+    }
+    else {
+      shape = isAnchoredStart ? Shape::PREFIX : isAnchoredEnd ? Shape::SUFFIX : Shape::SUBSTRING;
+    }
+  }
+
+  bool matches(std::string_view text) const {
+    switch (shape) {
+    case Shape::ANY:
+      return true;
+    case Shape::EXACT:
+      return segments.empty() ? text.empty() : text == segments[0].text;
+    case Shape::PREFIX:
+      return text.size() >= segments[0].text.size() && std::memcmp(text.data(), segments[0].text.data(), segments[0].text.size()) == 0;
+    case Shape::SUFFIX: {
+      const std::string& suffix = segments[0].text;
+      return text.size() >= suffix.size() && std::memcmp(text.data() + text.size() - suffix.size(), suffix.data(), suffix.size()) == 0;
+    }
+    case Shape::SUBSTRING:
+      return find(text, 0, segments[0]) != std::string_view::npos;
+    default:
+      return matchesSegments(text);
+    }
+  }
+
+private:
+  enum class Shape : u8 { ANY, EXACT, PREFIX, SUFFIX, SUBSTRING, GENERAL };
+
+  struct Segment {
+    std::string text;
+    // whether the segment has a '_'
+    bool hasWildcard;
+  };
+
+  std::vector<Segment> segments;
+  bool isAnchoredStart = true;
+  bool isAnchoredEnd = true;
+  Shape shape = Shape::EXACT;
+
+  static bool matchesAt(std::string_view text, size_t pos, const Segment& segment) {
+    if (!segment.hasWildcard) {
+      return std::memcmp(text.data() + pos, segment.text.data(), segment.text.size()) == 0;
+    }
+    for (size_t i = 0; i < segment.text.size(); ++i) {
+      if (segment.text[i] != '_' && segment.text[i] != text[pos + i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // the first position at or after pos where the segment is, npos if there is none. memchr finds
+  // the candidates for the first character, a segment that starts with '_' tries every position.
+  static size_t find(std::string_view text, size_t pos, const Segment& segment) {
+    size_t length = segment.text.size();
+    if (text.size() < length) {
+      return std::string_view::npos;
+    }
+    size_t last = text.size() - length;
+    char first = segment.text[0];
+    while (pos <= last) {
+      if (first != '_') {
+        auto found = static_cast<const char*>(std::memchr(text.data() + pos, first, last - pos + 1));
+        if (!found) {
+          return std::string_view::npos;
+        }
+        pos = found - text.data();
+      }
+      if (matchesAt(text, pos, segment)) {
+        return pos;
+      }
+      pos += 1;
+    }
+    return std::string_view::npos;
+  }
+
+  // the first and last segments are pinned to the ends unless the pattern has a '%' there, the
+  // segments between are found as early as they can be, which leaves the most room for the rest.
+  bool matchesSegments(std::string_view text) const {
+    size_t first = 0;
+    size_t last = segments.size();
+    size_t pos = 0;
+    size_t end = text.size();
+    if (isAnchoredStart) {
+      const Segment& segment = segments.front();
+      if (text.size() < segment.text.size() || !matchesAt(text, 0, segment)) {
+        return false;
+      }
+      pos = segment.text.size();
+      first += 1;
+    }
+    if (isAnchoredEnd && last > first) {
+      const Segment& segment = segments.back();
+      if (end - pos < segment.text.size() || !matchesAt(text, end - segment.text.size(), segment)) {
+        return false;
+      }
+      end -= segment.text.size();
+      last -= 1;
+    }
+    else if (isAnchoredEnd && pos != end) {
+      // the only segment is pinned to both ends
+      return false;
+    }
+    std::string_view middle = text.substr(0, end);
+    for (size_t i = first; i < last; ++i) {
+      size_t found = find(middle, pos, segments[i]);
+      if (found == std::string_view::npos) {
+        return false;
+      }
+      pos = found + segments[i].text.size();
+    }
+    return true;
+  }
+};
@@ -3,6 +3,7 @@
 #include <cctype>
 #include <unordered_map>
 #include <memory>
+#include <limits>
 
 #include "./parser.h"
 #include "./query.h"
@@ -28,6 +29,15 @@ std::unordered_map<std::string, TokenType> keywords = {
   {"DELETE", DELETE},
   {"UPDATE", UPDATE},
   {"SET", SET},
+  {"VACUUM", VACUUM},
+  {"WITH", WITH},
+  {"FILLFACTOR", FILLFACTOR},
+  {"TRUNCATE", TRUNCATE},
+  {"LAYOUT", LAYOUT},
+  {"TRUE", TRUE_TOKEN},
+  {"FALSE", FALSE_TOKEN},
+  {"IN", IN_TOKEN},
+  {"LIKE", LIKE},
 
   // do the uncapitalised keywords
 
@@ -48,10 +58,48 @@ void Lexer::skipWhiteSpace()
   }
 }
 
-std::tuple<Token, int> Lexer::scanToken()
+// an integer, or a DECIMAL if it has a fraction, start is left on its last character.
+Token Lexer::scanNumber(u32& start)
+{
+  u32 begin = start;
+  bool isNegative = input[start] == '-';
+  if (isNegative) {
+    start++;
+  }
+  // the magnitude may be one past the largest BIGINT, so the smallest BIGINT can be written
+  u64 limit = isNegative ? (u64)std::numeric_limits<i64>::max() + 1 : (u64)std::numeric_limits<i64>::max();
+  u64 magnitude = 0;
+  bool overflow = false;
+  while (start < input.size() && isdigit(input[start])) {
+    u64 next = input[start] - '0';
+    if (overflow || magnitude > (limit - next) / 10) {
+      overflow = true;
+    }
+    else {
+      magnitude = magnitude * 10 + next;
+    }
+    start++;
+  }
+  if (start + 1 < input.size() && input[start] == '.' && isdigit(input[start + 1])) {
+    start++;
+    while (start < input.size() && isdigit(input[start])) {
+      start++;
+    }
+    Token token = { DECIMAL, line, input.substr(begin, start - begin) };
+    start--;
+    return token;
+  }
+  start--;
+  if (overflow) {
+    return { ERROR_TOKEN, line, input.substr(begin, start + 1 - begin) };
+  }
+  return { NUMBER, line, "", isNegative ? (i64)(0 - magnitude) : (i64)magnitude };
+}
+
+std::tuple<Token, u32> Lexer::scanToken()
 {
   skipWhiteSpace();
-  int start = this->idx;
+  u32 start = this->idx;
   Token token;
   switch (this->input[start]) {
     // Single character tokens
@@ -71,7 +119,13 @@ std::tuple<Token, int> Lexer::scanToken()
     token = { DOT, line, "" };
     break;
   case '-':
-    token = { MINUS, line, "" };
+    // a minus sign right in front of a number is part of the number
+    if (start + 1 < input.size() && isdigit(input[start + 1])) {
+      token = scanNumber(start);
+    }
+    else {
+      token = { MINUS, line, "" };
+    }
     break;
   case '+':
     token = { PLUS, line, "" };
@@ -117,7 +171,7 @@ std::tuple<Token, int> Lexer::scanToken()
   {
     char startingQuote = input[start];
     start++;
-    int end = start;
+    u32 end = start;
     while (end < input.size() && input[end] != startingQuote) {
       end++;
     }
@@ -128,13 +182,7 @@ std::tuple<Token, int> Lexer::scanToken()
 
   default:
     if (isdigit(input[start])) {
-      int digit = 0;
-      while (start < input.size() && isdigit(input[start])) {
-        digit = digit * 10 + (input[start] - '0');
-        start++;
-      }
-      start--;
-      token = { NUMBER, line, "", digit };
+      token = scanNumber(start);
     }
     else if (isalpha(input[start])) {
       std::string lexeme = "";
@@ -208,6 +256,12 @@ Parser::StatementVariant Parser::parseStatement()
   else if (lexer.matchToken(DELETE)) {
     return this->parseDelete();
   }
+  else if (lexer.matchToken(VACUUM)) {
+    return this->parseVacuum();
+  }
+  else if (lexer.matchToken(TRUNCATE)) {
+    return this->parseTruncate();
+  }
   else {
     throw "no proper statements given here, to refactor in the future";
   }
@@ -386,6 +440,9 @@ Schema Parser::parseCreate() {
     this->addError("Expected right parenthesis");
   }
   lexer.nextToken();
+  if (lexer.matchToken(WITH)) {
+    this->parseTableOptions(schema.options);
+  }
   if (!lexer.matchToken(SEMI_COLON)) {
     this->addError("Expected semicolon");
   }
@@ -394,6 +451,66 @@ Schema Parser::parseCreate() {
   return schema;
 }
 
+// WITH (FILLFACTOR = 70, LAYOUT = PAX)
+void Parser::parseTableOptions(TableOptions& options) {
+  if (!lexer.matchToken(WITH)) {
+    this->addError("Expected WITH keyword");
+  }
+  lexer.nextToken();
+  if (!lexer.matchToken(LEFT_PAREN)) {
+    this->addError("Expected left parenthesis");
+  }
+  lexer.nextToken();
+
+  do {
+    bool isFillFactor = lexer.matchToken(FILLFACTOR);
+    if (!isFillFactor && !lexer.matchToken(LAYOUT)) {
+      this->addError("Expected FILLFACTOR or LAYOUT");
+      break;
+    }
+    lexer.nextToken();
+    if (!lexer.matchToken(EQUAL)) {
+      this->addError("Expected =");
+    }
+    lexer.nextToken();
+
+    if (isFillFactor) {
+      if (!lexer.matchToken(NUMBER)) {
+        this->addError("Expected fill factor");
+      }
+      auto fillFactor = lexer.nextToken();
+      if (fillFactor.digit < 10 || fillFactor.digit > 100) {
+        this->addError("Fill factor must be between 10 and 100");
+      }
+      else {
+        options.fillFactor = fillFactor.digit;
+      }
+    }
+    else {
+      auto layout = lexer.nextToken();
+      if (layout.tokenType == IDENTIFIER && layout.lexeme == "ROW") {
+        options.layout = PageLayout::ROW;
+      }
+      else if (layout.tokenType == IDENTIFIER && layout.lexeme == "PAX") {
+        options.layout = PageLayout::PAX;
+      }
+      else {
+        this->addError("Layout must be ROW or PAX");
+      }
+    }
+
+    if (!lexer.matchToken(COMMA)) {
+      break;
+    }
+    lexer.nextToken();
+  } while (true);
+
+  if (!lexer.matchToken(RIGHT_PAREN)) {
+    this->addError("Expected right parenthesis");
+  }
+  lexer.nextToken();
+}
+
 UpdateStmt Parser::parseUpdate()
 {
   UpdateStmt updateStmt;
@@ -479,6 +596,54 @@ DeleteStmt Parser::parseDelete()
   return deleteStmt;
 }
 
+VacuumStmt Parser::parseVacuum()
+{
+  VacuumStmt vacuumStmt;
+
+  if (!lexer.matchToken(VACUUM)) {
+    this->addError("Expected VACUUM keyword");
+  }
+  lexer.nextToken();
+
+  if (!lexer.matchToken(IDENTIFIER)) {
+    this->addError("Expected table name");
+  }
+  vacuumStmt.table = lexer.nextToken().lexeme;
+
+  if (!lexer.matchToken(SEMI_COLON)) {
+    this->addError("Expected semicolon");
+  }
+  lexer.nextToken();
+
+  return vacuumStmt;
+}
+
+// TRUNCATE [TABLE] t;
+TruncateStmt Parser::parseTruncate()
+{
+  TruncateStmt truncateStmt;
+
+  if (!lexer.matchToken(TRUNCATE)) {
+    this->addError("Expected TRUNCATE keyword");
+  }
+  lexer.nextToken();
+  if (lexer.matchToken(TABLE)) {
+    lexer.nextToken();
+  }
+
+  if (!lexer.matchToken(IDENTIFIER)) {
+    this->addError("Expected table name");
+  }
+  truncateStmt.table = lexer.nextToken().lexeme;
+
+  if (!lexer.matchToken(SEMI_COLON)) {
+    this->addError("Expected semicolon");
+  }
+  lexer.nextToken();
+
+  return truncateStmt;
+}
+
 void Parser::parseTable(Query& query)
 {
   if (lexer.matchToken(IDENTIFIER)) {
@@ -563,41 +728,72 @@ std::unique_ptr<Predicate> Parser::parsePredicate()
   return lhs;
 }
 
+// term ::= value op value | value IN (constant [, constant]*) | value LIKE string
 std::unique_ptr<Term> Parser::parseTerm()
 {
   auto lhs = parseValue();
+  if (lhs && lexer.matchToken(IN_TOKEN)) {
+    lexer.nextToken();
+    if (!lexer.matchToken(LEFT_PAREN)) {
+      this->addError("Expected left parenthesis");
+      return nullptr;
+    }
+    std::vector<Constant> list;
+    do {
+      lexer.nextToken();
+      auto value = parseValue();
+      auto constant = dynamic_cast<Constant*>(value.get());
+      if (!constant) {
+        this->addError("Expected a constant");
+        return nullptr;
+      }
+      list.push_back(*constant);
+    } while (lexer.matchToken(COMMA));
+    if (!lexer.matchToken(RIGHT_PAREN)) {
+      this->addError("Expected right parenthesis");
+      return nullptr;
+    }
+    lexer.nextToken();
+    return std::make_unique<Term>(std::move(lhs), std::move(list));
+  }
+  if (lhs && lexer.matchToken(LIKE)) {
+    lexer.nextToken();
+    if (!lexer.matchToken(STRING)) {
+      this->addError("Expected a pattern");
+      return nullptr;
+    }
+    return std::make_unique<Term>(TermOperand::LIKE, std::move(lhs), std::make_unique<Constant>(lexer.nextToken().lexeme));
+  }
   auto op = lexer.nextToken();
   auto rhs = parseValue();
 
   if (lhs && rhs) {
-    if (op.tokenType == EQUAL || op.tokenType == NOT_EQUAL || op.tokenType == GREATER || op.tokenType == GREATER_EQUAL || op.tokenType == LESS || op.tokenType == LESS_EQUAL) {
-      TermOperand to;
-      switch (op.tokenType) {
-      case EQUAL:
-        to = TermOperand::EQUAL;
-        break;
-      case NOT_EQUAL:
-        to = TermOperand::NOT_EQUAL;
-        break;
-      case GREATER:
-        to = TermOperand::GREATER;
-        break;
-      case GREATER_EQUAL:
-        to = TermOperand::GREATER_EQUAL;
-        break;
-      case LESS:
-        to = TermOperand::LESS;
-        break;
-      case LESS_EQUAL:
-        to = TermOperand::LESS_EQUAL;
-        break;
-      }
-      return std::make_unique<Term>(to, std::move(lhs), std::move(rhs));
-    }
-    else {
+    TermOperand to;
+    switch (op.tokenType) {
+    case EQUAL:
+      to = TermOperand::EQUAL;
+      break;
+    case NOT_EQUAL:
+      to = TermOperand::NOT_EQUAL;
+      break;
+    case GREATER:
+      to = TermOperand::GREATER;
+      break;
+    case GREATER_EQUAL:
+      to = TermOperand::GREATER_EQUAL;
+      break;
+    case LESS:
+      to = TermOperand::LESS;
+      break;
+    case LESS_EQUAL:
+      to = TermOperand::LESS_EQUAL;
+      break;
+    default:
       // display error here.
       errors.push_back(ErrorMessage{ "Expected a comparison operator" });
+      return nullptr;
     }
+    return std::make_unique<Term>(to, std::move(lhs), std::move(rhs));
   }
 
   return nullptr;
@@ -615,6 +811,14 @@ std::unique_ptr<TableValue> Parser::parseValue()
     std::unique_ptr<TableValue> tv = std::make_unique<Constant>(token.digit);
     return tv;
   }
+  else if (lexer.matchToken(DECIMAL)) {
+    Token token = lexer.nextToken();
+    return std::make_unique<Constant>(Constant::fromDouble(std::stod(token.lexeme)));
+  }
+  else if (lexer.matchToken(TRUE_TOKEN) || lexer.matchToken(FALSE_TOKEN)) {
+    Token token = lexer.nextToken();
+    return std::make_unique<Constant>(Constant::boolean(token.tokenType == TRUE_TOKEN));
+  }
   else if (lexer.matchToken(IDENTIFIER)) {
     Token field = lexer.nextToken();
     if (lexer.matchToken(DOT)) {
@@ -642,6 +846,24 @@ std::unique_ptr<ReadField> Parser::parseType() {
   if (fieldType.lexeme == "INT") {
     return std::make_unique<ReadIntField>();
   }
+  else if (fieldType.lexeme == "BIGINT") {
+    return std::make_unique<ReadBigIntField>();
+  }
+  else if (fieldType.lexeme == "DOUBLE") {
+    return std::make_unique<ReadDoubleField>();
+  }
+  else if (fieldType.lexeme == "DATE") {
+    return std::make_unique<ReadDateField>();
+  }
+  else if (fieldType.lexeme == "TIMESTAMP") {
+    return std::make_unique<ReadTimestampField>();
+  }
+  else if (fieldType.lexeme == "BOOLEAN") {
+    return std::make_unique<ReadBoolField>();
+  }
+  else if (fieldType.lexeme == "DICT") {
+    return std::make_unique<ReadDictField>();
+  }
   else if (fieldType.lexeme == "VARCHAR" || fieldType.lexeme == "CHAR") {
 
     u32 defaultFieldSize = 100;
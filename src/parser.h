@@ -18,11 +18,12 @@ enum TokenType {
   NOT_EQUAL, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL,
 
   // literals
-  IDENTIFIER, STRING, NUMBER,
+  IDENTIFIER, STRING, NUMBER, DECIMAL,
 
   // keywords
   SELECT, AS, FROM, WHERE, AND, OR, IS, NOT, NULL_TOKEN, JOIN,
-  ON, CREATE, TABLE, INSERT, INTO, VALUES, DELETE, UPDATE, SET,
+  ON, CREATE, TABLE, INSERT, INTO, VALUES, DELETE, UPDATE, SET, VACUUM, WITH, FILLFACTOR, TRUNCATE, LAYOUT,
+  TRUE_TOKEN, FALSE_TOKEN, IN_TOKEN, LIKE,
 
   // error keyword
   ERROR_TOKEN
@@ -32,8 +33,9 @@ struct Token {
 public:
   TokenType tokenType;
   int line = 0;
-  std::string lexeme;
-  int digit;
+  // the text of a DECIMAL, which is read when it is known what type it is for
+  std::string lexeme = "";
+  i64 digit = 0;
 
   bool operator==(const Token& other) const {
     return tokenType == other.tokenType && line == other.line && lexeme == other.lexeme && digit == other.digit;
@@ -43,14 +45,15 @@ public:
 class Lexer {
 private:
   std::string input;
-  int idx = 0;
+  u32 idx = 0;
 
   void skipWhiteSpace();
-  std::tuple<Token, int> scanToken();
+  Token scanNumber(u32& start);
+  std::tuple<Token, u32> scanToken();
 public:
   int line = 1;
   Lexer(std::string input) : input{ input }, idx(0) {};
-  Lexer(std::string input, int idx) : input(input), idx(idx) {};
+  Lexer(std::string input, u32 idx) : input(input), idx(idx) {};
 
   Token nextToken();
   bool matchToken(TokenType type);
@@ -60,7 +63,7 @@ public:
 
 struct ErrorMessage {
   std::string message;
-  int line;
+  int line = 0;
 };
 
 class Parser {
@@ -70,7 +73,7 @@ private:
   void addError(std::string message);
 public:
 
-  using StatementVariant = std::variant<Query, Insert, Schema, UpdateStmt, DeleteStmt>;
+  using StatementVariant = std::variant<Query, Insert, Schema, UpdateStmt, DeleteStmt, VacuumStmt, TruncateStmt>;
 
   Parser(std::string input) : lexer(input) {};
 
@@ -78,8 +81,11 @@ public:
   Query parseQuery();
   Insert parseInsert();
   Schema parseCreate();
+  void parseTableOptions(TableOptions& options);
   UpdateStmt parseUpdate();
   DeleteStmt parseDelete();
+  VacuumStmt parseVacuum();
+  TruncateStmt parseTruncate();
   void parseTable(Query& query);
   std::unique_ptr<Predicate> parsePredicate();
   std::unique_ptr<Term> parseTerm();
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "query.h"
+
+/**
+A WHERE clause compiled into a flat list of typed instructions.
+
+Evaluating a Predicate walks its tree and goes through the virtual getValue of both sides of
+every term for every row. The program is built once from a bound predicate instead: a term
+comparing a fixed type column with a constant becomes one instruction that knows the column
+index, the type of the column and the constant, already converted to that type, so it reads
+the column straight from the page and compares. AND and OR become jumps over the
+instructions they short circuit, the result of the last comparison is the only register.
+
+Terms the program has no instruction for (DICT and BOOLEAN columns, two columns, two
+constants) are kept as a TERM instruction that evaluates the term. Rows that are not read in
+place, such as the rows of a join, evaluate the term of every instruction.
+
+The terms of an AND or an OR are not run in the order they were written. Each term has an
+estimated cost and chance to pass, an AND runs first the terms that are cheap and likely to
+fail and an OR the ones that are cheap and likely to pass. Some rows are profiled to count how
+often each term passes, and the program is ordered again from those counts as the scan goes.
+*/
+class PredicateProgram {
+public:
+  enum class Opcode : u8 {
+    // an INT or DATE column and a constant
+    I32_EQ, I32_NE, I32_LT, I32_LE, I32_GT, I32_GE,
+    // a BIGINT or TIMESTAMP column and a constant
+    I64_EQ, I64_NE, I64_LT, I64_LE, I64_GT, I64_GE,
+    // a DOUBLE column and a constant
+    F64_EQ, F64_NE, F64_LT, F64_LE, F64_GT, F64_GE,
+    // a CHAR or VARCHAR column and a constant
+    STR_EQ, STR_NE, STR_LT, STR_LE, STR_GT, STR_GE,
+    // any other term
+    TERM,
+    // jump to target if the last result is false or true
+    JUMP_IF_FALSE, JUMP_IF_TRUE,
+  };
+
+  struct Instruction {
+    Opcode opcode;
+    // the column, or where a jump goes
+    u32 column = 0;
+    i64 integer = 0;
+    double real = 0;
+    std::string string = "";
+    // the length of a CHAR column, 0 for a VARCHAR column
+    u32 width = 0;
+    Term* term = nullptr;
+    // the statistics of the term
+    u32 leaf = 0;
+  };
+
+  // the predicate must be bound to the schema, both must outlive the program.
+  PredicateProgram(Predicate& predicate, Schema& schema) : predicate{ &predicate }, schema{ &schema } {
+    root = build(predicate);
+    isAdaptive = root.op != PredicateOperand::SINGLE;
+    order(root);
+    emit(root);
+  }
+
+  const std::vector<Instruction>& getInstructions() const {
+    return instructions;
+  }
+
+  // the typed instructions of the terms the predicate is a conjunction of. isComplete is false
+  // if there is more to the predicate than those, an OR or a term without a typed instruction.
+  std::vector<Instruction> getConjuncts(bool& isComplete) {
+    std::vector<Instruction> conjuncts;
+    isComplete = true;
+    collectConjuncts(*predicate, conjuncts, isComplete);
+    return conjuncts;
+  }
+
+  bool evaluate(TupleView& row) {
+    bool isProfiled = false;
+    if (isAdaptive && --rowsUntilSample == 0) {
+      rowsUntilSample = SAMPLE_INTERVAL;
+      isProfiled = true;
+    }
+    bool result;
+    if (row.isInPlace()) {
+      result = isProfiled ? run<true, true>(row) : run<true, false>(row);
+    }
+    else {
+      result = isProfiled ? run<false, true>(row) : run<false, false>(row);
+    }
+    if (isProfiled && ++sampledRows == REORDER_INTERVAL) {
+      reorder();
+    }
+    return result;
+  }
+
+private:
+  // an AND or an OR of any number of nodes, or a single term
+  struct Node {
+    PredicateOperand op;
+    std::vector<Node> children = {};
+    u32 leaf = 0;
+    // the chance the node is true and what it costs to evaluate, in comparisons of two integers
+    double selectivity = 1;
+    double cost = 0;
+  };
+
+  struct Statistics {
+    double selectivity;
+    double cost;
+    // profiled rows that reached the term and that passed it
+    double evaluated = 0;
+    double passed = 0;
+  };
+
+  // every 16th row is profiled, the program is ordered again every 64 profiled rows
+  static constexpr u32 SAMPLE_INTERVAL = 16;
+  static constexpr u32 REORDER_INTERVAL = 64;
+  // how many profiled rows the estimate of a term counts for
+  static constexpr double ESTIMATE_WEIGHT = 8;
+
+  Predicate* predicate;
+  Schema* schema;
+  std::vector<Instruction> instructions;
+  Node root;
+  std::vector<Instruction> leaves;
+  std::vector<Statistics> statistics;
+  bool isAdaptive;
+  u32 rowsUntilSample = SAMPLE_INTERVAL;
+  u32 sampledRows = 0;
+
+  template <bool IsInPlace, bool IsProfiled>
+  bool run(TupleView& row) {
+    bool result = true;
+    u32 pc = 0;
+    u32 size = (u32)instructions.size();
+    while (pc < size) {
+      const Instruction& instruction = instructions[pc++];
+      if (!IsInPlace && instruction.opcode <= Opcode::TERM) {
+        result = instruction.term->evaluate(row, *schema);
+      }
+      else {
+        switch (instruction.opcode) {
+        case Opcode::I32_EQ: result = loadI32(row, instruction) == instruction.integer; break;
+        case Opcode::I32_NE: result = loadI32(row, instruction) != instruction.integer; break;
+        case Opcode::I32_LT: result = loadI32(row, instruction) < instruction.integer; break;
+        case Opcode::I32_LE: result = loadI32(row, instruction) <= instruction.integer; break;
+        case Opcode::I32_GT: result = loadI32(row, instruction) > instruction.integer; break;
+        case Opcode::I32_GE: result = loadI32(row, instruction) >= instruction.integer; break;
+        case Opcode::I64_EQ: result = loadI64(row, instruction) == instruction.integer; break;
+        case Opcode::I64_NE: result = loadI64(row, instruction) != instruction.integer; break;
+        case Opcode::I64_LT: result = loadI64(row, instruction) < instruction.integer; break;
+        case Opcode::I64_LE: result = loadI64(row, instruction) <= instruction.integer; break;
+        case Opcode::I64_GT: result = loadI64(row, instruction) > instruction.integer; break;
+        case Opcode::I64_GE: result = loadI64(row, instruction) >= instruction.integer; break;
+        case Opcode::F64_EQ: result = loadF64(row, instruction) == instruction.real; break;
+        case Opcode::F64_NE: result = loadF64(row, instruction) != instruction.real; break;
+        case Opcode::F64_LT: result = loadF64(row, instruction) < instruction.real; break;
+        case Opcode::F64_LE: result = loadF64(row, instruction) <= instruction.real; break;
+        case Opcode::F64_GT: result = loadF64(row, instruction) > instruction.real; break;
+        case Opcode::F64_GE: result = loadF64(row, instruction) >= instruction.real; break;
+        case Opcode::STR_EQ: result = loadString(row, instruction) == instruction.string; break;
+        case Opcode::STR_NE: result = loadString(row, instruction) != instruction.string; break;
+        case Opcode::STR_LT: result = loadString(row, instruction) < instruction.string; break;
+        case Opcode::STR_LE: result = loadString(row, instruction) <= instruction.string; break;
+        case Opcode::STR_GT: result = loadString(row, instruction) > instruction.string; break;
+        case Opcode::STR_GE: result = loadString(row, instruction) >= instruction.string; break;
+        case Opcode::TERM: result = instruction.term->evaluate(row, *schema); break;
+        case Opcode::JUMP_IF_FALSE:
+          if (!result) {
+            pc = instruction.column;
+          }
+          continue;
+        case Opcode::JUMP_IF_TRUE:
+          if (result) {
+            pc = instruction.column;
+          }
+          continue;
+        }
+      }
+      if (IsProfiled) {
+        statistics[instruction.leaf].evaluated += 1;
+        statistics[instruction.leaf].passed += result;
+      }
+    }
+    return result;
+  }
+
+  static i64 loadI32(TupleView& row, const Instruction& instruction) {
+    i32 value;
+    std::memcpy(&value, row.columnData(instruction.column), sizeof(i32));
+    return value;
+  }
+
+  static i64 loadI64(TupleView& row, const Instruction& instruction) {
+    i64 value;
+    std::memcpy(&value, row.columnData(instruction.column), sizeof(i64));
+    return value;
+  }
+
+  static double loadF64(TupleView& row, const Instruction& instruction) {
+    double value;
+    std::memcpy(&value, row.columnData(instruction.column), sizeof(double));
+    return value;
+  }
+
+  // a varchar in overflow pages is read through the view, which keeps it for the row
+  static std::string_view loadString(TupleView& row, const Instruction& instruction) {
+    const char* data = row.columnData(instruction.column);
+    if (instruction.width > 0) {
+      return std::string_view(data, strnlen(data, instruction.width));
+    }
+    u16 length, physicalSize;
+    std::memcpy(&length, data, sizeof(u16));
+    std::memcpy(&physicalSize, data + sizeof(u16), sizeof(u16));
+    if (length == VARCHAR_OVERFLOW && physicalSize == VARCHAR_OVERFLOW) {
+      return row.getValue(instruction.column).getString();
+    }
+    return std::string_view(data + sizeof(u16) + sizeof(u16), length);
+  }
+
+  void collectConjuncts(Predicate& node, std::vector<Instruction>& conjuncts, bool& isComplete) {
+    if (node.op == PredicateOperand::AND) {
+      collectConjuncts(*node.lhs, conjuncts, isComplete);
+      collectConjuncts(*node.rhs, conjuncts, isComplete);
+    }
+    else if (node.op == PredicateOperand::SINGLE) {
+      Instruction instruction = compileTerm(*node.term);
+      if (instruction.opcode == Opcode::TERM) {
+        isComplete = false;
+      }
+      else {
+        conjuncts.push_back(std::move(instruction));
+      }
+    }
+    else {
+      isComplete = false;
+    }
+  }
+
+  // the tree of the predicate with the children of nested ANDs, and of nested ORs, in one node
+  Node build(Predicate& predicate) {
+    Node node{ predicate.op };
+    if (predicate.op == PredicateOperand::SINGLE) {
+      node.leaf = (u32)leaves.size();
+      leaves.push_back(compileTerm(*predicate.term));
+      leaves.back().leaf = node.leaf;
+      statistics.push_back(estimate(leaves.back()));
+      return node;
+    }
+    for (Predicate* side : { predicate.lhs.get(), predicate.rhs.get() }) {
+      Node child = build(*side);
+      if (child.op == node.op) {
+        std::move(child.children.begin(), child.children.end(), std::back_inserter(node.children));
+      }
+      else {
+        node.children.push_back(std::move(child));
+      }
+    }
+    return node;
+  }
+
+  // the cost of a term and its chance to pass before any row is seen
+  static Statistics estimate(const Instruction& instruction) {
+    if (instruction.opcode == Opcode::TERM) {
+      return { 0.5, 10 };
+    }
+    static constexpr double selectivities[] = { 0.1, 0.9, 1.0 / 3, 1.0 / 3, 1.0 / 3, 1.0 / 3 };
+    double selectivity = selectivities[(u8)instruction.opcode % 6];
+    return { selectivity, instruction.opcode >= Opcode::STR_EQ ? 4.0 : 1.0 };
+  }
+
+  // sort the children of every node from its statistics, an AND puts first the children with the lowest
+  // cost for each row they reject and an OR the ones with the lowest cost for each row they accept.
+  void order(Node& node) {
+    if (node.op == PredicateOperand::SINGLE) {
+      Statistics& term = statistics[node.leaf];
+      node.selectivity = (term.passed + term.selectivity * ESTIMATE_WEIGHT) / (term.evaluated + ESTIMATE_WEIGHT);
+      node.cost = term.cost;
+      return;
+    }
+    for (auto& child : node.children) {
+      order(child);
+    }
+    bool isAnd = node.op == PredicateOperand::AND;
+    auto rank = [isAnd](const Node& child) {
+      double decided = isAnd ? 1 - child.selectivity : child.selectivity;
+      return child.cost / std::max(decided, 1e-6);
+    };
+    std::stable_sort(node.children.begin(), node.children.end(), [&](const Node& lhs, const Node& rhs) {
+      return rank(lhs) < rank(rhs);
+    });
+    // the chance that a child is reached
+    double reached = 1;
+    node.cost = 0;
+    for (auto& child : node.children) {
+      node.cost += reached * child.cost;
+      reached *= isAnd ? child.selectivity : 1 - child.selectivity;
+    }
+    node.selectivity = isAnd ? reached : 1 - reached;
+  }
+
+  void emit(Node& node) {
+    if (node.op == PredicateOperand::SINGLE) {
+      instructions.push_back(leaves[node.leaf]);
+      return;
+    }
+    // a child that decides the node jumps over the rest, the result is then the one of the child
+    std::vector<u32> jumps;
+    for (u32 i = 0; i < node.children.size(); ++i) {
+      emit(node.children[i]);
+      if (i + 1 < node.children.size()) {
+        jumps.push_back((u32)instructions.size());
+        instructions.push_back({ node.op == PredicateOperand::AND ? Opcode::JUMP_IF_FALSE : Opcode::JUMP_IF_TRUE });
+      }
+    }
+    for (u32 jump : jumps) {
+      instructions[jump].column = (u32)instructions.size();
+    }
+  }
+
+  // order the program from the profiled rows, older rows count for less as the scan goes on
+  void reorder() {
+    sampledRows = 0;
+    order(root);
+    instructions.clear();
+    emit(root);
+    for (auto& term : statistics) {
+      term.evaluated /= 2;
+      term.passed /= 2;
+    }
+  }
+
+  // the term as a column compared with a constant, the column on the left.
+  Instruction compileTerm(Term& term) {
+    Instruction fallback{ Opcode::TERM };
+    fallback.term = &term;
+    if (term.op == TermOperand::IN || term.op == TermOperand::LIKE || term.isLhsConstant == term.isRhsConstant) {
+      return fallback;
+    }
+    auto field = dynamic_cast<Field*>(term.isLhsConstant ? term.rhs.get() : term.lhs.get());
+    auto constant = static_cast<Constant*>(term.isLhsConstant ? term.lhs.get() : term.rhs.get());
+    if (!field) {
+      return fallback;
+    }
+    TermOperand op = term.isLhsConstant ? flip(term.op) : term.op;
+
+    Instruction instruction{ Opcode::TERM };
+    instruction.term = &term;
+    instruction.column = field->getIndex(*schema);
+    ReadField* column = schema->fieldMap.at(schema->fieldList[instruction.column]).get();
+    ConstantType columnType = column->getConstantType();
+    ConstantType constantType = constant->constantType;
+    Opcode first;
+    if ((columnType == ConstantType::NUMBER || columnType == ConstantType::DATE) && column->getFixedWidth() == sizeof(i32)) {
+      auto integer = toInteger(*constant, columnType);
+      if (!integer) {
+        return fallback;
+      }
+      first = Opcode::I32_EQ;
+      instruction.integer = *integer;
+    }
+    else if ((columnType == ConstantType::NUMBER || columnType == ConstantType::TIMESTAMP) && column->getFixedWidth() == sizeof(i64)) {
+      auto integer = toInteger(*constant, columnType);
+      if (!integer) {
+        return fallback;
+      }
+      first = Opcode::I64_EQ;
+      instruction.integer = *integer;
+    }
+    else if (columnType == ConstantType::DOUBLE && (constantType == ConstantType::NUMBER || constantType == ConstantType::DOUBLE)) {
+      first = Opcode::F64_EQ;
+      instruction.real = constantType == ConstantType::DOUBLE ? constant->real : (double)constant->num;
+    }
+    else if (constantType == ConstantType::STRING && (dynamic_cast<ReadFixedCharField*>(column) || dynamic_cast<ReadVarCharField*>(column))) {
+      first = Opcode::STR_EQ;
+      instruction.string = constant->str;
+      instruction.width = column->getFixedWidth();
+    }
+    else {
+      return fallback;
+    }
+    instruction.opcode = (Opcode)((u8)first + offsetOf(op));
+    return instruction;
+  }
+
+  // the constant as the integer stored in a column of the type, nothing if it is not one
+  static std::optional<i64> toInteger(const Constant& constant, ConstantType columnType) {
+    if (constant.constantType == columnType) {
+      return constant.num;
+    }
+    if (constant.constantType == ConstantType::STRING && columnType == ConstantType::DATE) {
+      auto days = DateTime::parseDate(constant.str);
+      return days ? std::optional<i64>(*days) : std::nullopt;
+    }
+    if (constant.constantType == ConstantType::STRING && columnType == ConstantType::TIMESTAMP) {
+      return DateTime::parseTimestamp(constant.str);
+    }
+    return std::nullopt;
+  }
+
+  // the opcodes of each type are in the order EQ, NE, LT, LE, GT, GE
+  static u8 offsetOf(TermOperand op) {
+    switch (op) {
+    case TermOperand::EQUAL:
+      return 0;
+    case TermOperand::NOT_EQUAL:
+      return 1;
+    case TermOperand::LESS:
+      return 2;
+    case TermOperand::LESS_EQUAL:
+      return 3;
+    case TermOperand::GREATER:
+      return 4;
+    default:
+      return 5;
+    }
+  }
+
+  // the operator with its sides swapped, 5 < a is a > 5
+  static TermOperand flip(TermOperand op) {
+    switch (op) {
+    case TermOperand::GREATER:
+      return TermOperand::LESS;
+    case TermOperand::GREATER_EQUAL:
+      return TermOperand::LESS_EQUAL;
+    case TermOperand::LESS:
+      return TermOperand::GREATER;
+    case TermOperand::LESS_EQUAL:
+      return TermOperand::GREATER_EQUAL;
+    default:
+      return op;
+    }
+  }
+};
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <limits>
+
 
 #include "parser.h"
 #include "query.h"
@@ -6,6 +9,14 @@
 #include "../src/scan/SelectScan.h"
 #include "../src/scan/TableScan.h"
 
+const std::string& OverflowVarCharField::getString() {
+  if (!isFetched) {
+    value = HeapFile::readOverflow(*source->rm, source->filename, firstPage, valueLength);
+    isFetched = true;
+  }
+  return value;
+}
+
 bool Field::operator==(const TableValue* other) const {
   if (auto otherConstant = dynamic_cast<const Field*>(other)) {
     return otherConstant->fieldName == fieldName && otherConstant->table == table;
@@ -16,21 +27,51 @@ bool Field::operator==(const TableValue* other) const {
 }
 
 Constant Field::getConstant(Tuple& tuple, Schema& schema) {
-  for (int i = 0; i < schema.fieldList.size(); i++) {
-    if (schema.fieldList[i] == fieldName && schema.tableList[i] == table) {
-      return tuple.fields[i]->getConstant();
+  return tuple.fields[getIndex(schema)]->getConstant();
+}
+
+Value Field::getValue(TupleView& row, Schema& schema) {
+  return row.getValue(getIndex(schema));
+}
+
+ConstantType Field::bind(Schema& schema) {
+  auto column = resolve(schema);
+  if (!column) {
+    throw BindError("Column does not exist: " + getName());
+  }
+  boundSchema = &schema;
+  index = *column;
+  return schema.fieldMap.at(schema.fieldList[index])->getConstantType();
+}
+
+std::optional<u32> Field::resolve(const Schema& schema) const {
+  for (u32 i = 0; i < schema.fieldList.size(); i++) {
+    if (schema.fieldList[i] == std::string_view(fieldName) && schema.tableList[i] == std::string_view(table)) {
+      return i;
     }
   }
-  // to do, add empty constant...
+  if (table == fieldName) {
+    for (u32 i = 0; i < schema.fieldList.size(); i++) {
+      if (schema.fieldList[i] == std::string_view(fieldName)) {
+        return i;
+      }
+    }
+  }
+  return std::nullopt;
 }
 
-Constant Constant::getConstant(Tuple& tuple, Schema& schema) {
+Constant Constant::getConstant(Tuple&, Schema&) {
   return *this;
 }
 
+Value Constant::getValue(TupleView&, Schema&) {
+  return getValue();
+}
+
 bool Constant::operator==(const TableValue* other) const {
   if (auto otherConstant = dynamic_cast<const Constant*>(other)) {
-    return otherConstant->constantType == constantType && otherConstant->num == num && otherConstant->str == str;
+    return otherConstant->constantType == constantType && otherConstant->num == num &&
+      otherConstant->real == real && otherConstant->str == str;
   }
   else {
     return false;
@@ -74,28 +115,200 @@ std::unique_ptr<WriteField> ReadFixedCharField::get(Constant constant) {
   }
 }
 
+std::shared_ptr<Dictionary>& ReadDictField::getDictionary(const std::shared_ptr<HeapFileSource>& source) {
+  if (!source) {
+    throw std::runtime_error("Dictionary value read without its heap file");
+  }
+  if (source != dictionarySource) {
+    dictionary = HeapFile::getDictionary(*source->rm, source->filename);
+    dictionarySource = source;
+  }
+  return dictionary;
+}
+
+std::unique_ptr<WriteField> ReadDictField::get(Token token) {
+  if (token.tokenType != TokenType::STRING) {
+    return nullptr;
+  }
+  else {
+    return std::make_unique<DictField>(token.lexeme);
+  }
+}
+
+std::unique_ptr<WriteField> ReadDictField::get(Constant constant) {
+  if (constant.constantType == ConstantType::STRING) {
+    return std::make_unique<DictField>(std::string(constant.str));
+  }
+  else {
+    return nullptr;
+  }
+}
+
+// NUMBER literals are 64 bit, an INT column only takes the ones that fit in 32 bits
+static bool fitsInt(i64 value) {
+  return value >= std::numeric_limits<i32>::min() && value <= std::numeric_limits<i32>::max();
+}
+
 std::unique_ptr<WriteField> ReadIntField::get(Token token) {
-  if (token.tokenType != TokenType::NUMBER) {
+  if (token.tokenType != TokenType::NUMBER || !fitsInt(token.digit)) {
     return nullptr;
   }
   else {
-    return std::make_unique<IntField>(token.digit);
+    return std::make_unique<IntField>(static_cast<i32>(token.digit));
   }
 }
 
 std::unique_ptr<WriteField> ReadIntField::get(Constant constant) {
+  if (constant.constantType == ConstantType::NUMBER && fitsInt(constant.num)) {
+    return std::make_unique<IntField>(static_cast<i32>(constant.num));
+  }
+  else {
+    return nullptr;
+  }
+}
+
+std::unique_ptr<WriteField> ReadBigIntField::get(Token token) {
+  if (token.tokenType != TokenType::NUMBER) {
+    return nullptr;
+  }
+  else {
+    return std::make_unique<BigIntField>(token.digit);
+  }
+}
+
+std::unique_ptr<WriteField> ReadBigIntField::get(Constant constant) {
+  if (constant.constantType == ConstantType::NUMBER) {
+    return std::make_unique<BigIntField>(constant.num);
+  }
+  else {
+    return nullptr;
+  }
+}
+
+std::unique_ptr<WriteField> ReadDoubleField::get(Token token) {
+  if (token.tokenType == TokenType::NUMBER) {
+    return std::make_unique<DoubleField>((double)token.digit);
+  }
+  else if (token.tokenType == TokenType::DECIMAL) {
+    return std::make_unique<DoubleField>(std::stod(token.lexeme));
+  }
+  else {
+    return nullptr;
+  }
+}
+
+std::unique_ptr<WriteField> ReadDoubleField::get(Constant constant) {
   if (constant.constantType == ConstantType::NUMBER) {
-    return std::make_unique<IntField>(constant.num);
+    return std::make_unique<DoubleField>((double)constant.num);
+  }
+  else if (constant.constantType == ConstantType::DOUBLE) {
+    return std::make_unique<DoubleField>(constant.real);
+  }
+  else {
+    return nullptr;
+  }
+}
+
+std::unique_ptr<WriteField> ReadDateField::get(Token token) {
+  auto days = token.tokenType == TokenType::STRING ? DateTime::parseDate(token.lexeme) : std::nullopt;
+  if (!days) {
+    return nullptr;
+  }
+  else {
+    return std::make_unique<DateField>(*days);
+  }
+}
+
+std::unique_ptr<WriteField> ReadDateField::get(Constant constant) {
+  if (constant.constantType == ConstantType::DATE) {
+    return std::make_unique<DateField>((i32)constant.num);
+  }
+  auto days = constant.constantType == ConstantType::STRING ? DateTime::parseDate(constant.str) : std::nullopt;
+  if (!days) {
+    return nullptr;
   }
   else {
+    return std::make_unique<DateField>(*days);
+  }
+}
+
+std::unique_ptr<WriteField> ReadTimestampField::get(Token token) {
+  auto microseconds = token.tokenType == TokenType::STRING ? DateTime::parseTimestamp(token.lexeme) : std::nullopt;
+  if (!microseconds) {
     return nullptr;
   }
+  else {
+    return std::make_unique<TimestampField>(*microseconds);
+  }
+}
+
+std::unique_ptr<WriteField> ReadTimestampField::get(Constant constant) {
+  if (constant.constantType == ConstantType::TIMESTAMP) {
+    return std::make_unique<TimestampField>(constant.num);
+  }
+  if (constant.constantType == ConstantType::DATE) {
+    return std::make_unique<TimestampField>(constant.num * DateTime::MICROSECONDS_PER_DAY);
+  }
+  auto microseconds = constant.constantType == ConstantType::STRING ? DateTime::parseTimestamp(constant.str) : std::nullopt;
+  if (!microseconds) {
+    return nullptr;
+  }
+  else {
+    return std::make_unique<TimestampField>(*microseconds);
+  }
+}
+
+// TRUE and FALSE, or 1 and 0
+std::unique_ptr<WriteField> ReadBoolField::get(Token token) {
+  if (token.tokenType == TokenType::TRUE_TOKEN || token.tokenType == TokenType::FALSE_TOKEN) {
+    return std::make_unique<BoolField>(token.tokenType == TokenType::TRUE_TOKEN);
+  }
+  else if (token.tokenType == TokenType::NUMBER && (token.digit == 0 || token.digit == 1)) {
+    return std::make_unique<BoolField>(token.digit == 1);
+  }
+  else {
+    return nullptr;
+  }
+}
+
+std::unique_ptr<WriteField> ReadBoolField::get(Constant constant) {
+  if (constant.constantType == ConstantType::BOOLEAN ||
+    (constant.constantType == ConstantType::NUMBER && (constant.num == 0 || constant.num == 1))) {
+    return std::make_unique<BoolField>(constant.num == 1);
+  }
+  else {
+    return nullptr;
+  }
+}
+
+void UpdateStmt::bind(Schema& schema) {
+  for (auto& [field, value] : setFields) {
+    ReadField* column = schema.fieldMap.at(schema.fieldList[field->getIndex(schema)]).get();
+    ConstantType valueType = value->bind(schema);
+    // a constant fits if the column can be written from it, another column if it has the same type
+    // and, for numbers, is not wider than the column, so an INT is never set from a BIGINT
+    auto constant = dynamic_cast<Constant*>(value.get());
+    auto sourceField = dynamic_cast<Field*>(value.get());
+    bool fits = constant ? column->get(*constant) != nullptr :
+      valueType == column->getConstantType() || (valueType == ConstantType::NUMBER && column->getConstantType() == ConstantType::DOUBLE);
+    if (fits && sourceField && valueType == ConstantType::NUMBER && column->getConstantType() == ConstantType::NUMBER) {
+      ReadField* sourceColumn = schema.fieldMap.at(schema.fieldList[sourceField->getIndex(schema)]).get();
+      fits = sourceColumn->getFixedWidth() <= column->getFixedWidth();
+    }
+    if (!fits) {
+      throw BindError("Cannot assign " + constantTypeName(valueType) + " to " + field->getName() + " " + column->serializeType());
+    }
+  }
 }
 
 Tuple Schema::createTuple(std::vector<Token>& tokens) {
-  std::vector<std::unique_ptr<WriteField>> writeFields;
-  for (int i = 0; i < tokens.size(); i++) {
-    writeFields.push_back(fieldMap[fieldList[i]]->get(tokens[i]));
+  Tuple::Fields writeFields(ArenaScope::getResource());
+  for (u32 i = 0; i < tokens.size(); i++) {
+    auto writeField = fieldMap[fieldList[i]]->get(tokens[i]);
+    if (writeField == nullptr) {
+      throw BindError("Cannot insert into " + std::string(fieldList[i]) + " " + fieldMap[fieldList[i]]->serializeType());
+    }
+    writeFields.push_back(std::move(writeField));
   }
   return Tuple(std::move(writeFields));
 }
@@ -133,9 +346,9 @@ std::unordered_map<std::string, Schema> getSchemaFromTableName(std::vector<std::
   std::unordered_map<std::string, Schema> res;
 
   for (auto& tuple : tuples) {
-    std::string tableName = tuple.fields[0]->getConstant().str;
-    std::string fieldName = tuple.fields[1]->getConstant().str;
-    std::string fieldType = tuple.fields[2]->getConstant().str;
+    std::string tableName(tuple.fields[0]->getConstant().str);
+    std::string fieldName(tuple.fields[1]->getConstant().str);
+    std::string fieldType(tuple.fields[2]->getConstant().str);
 
     if (res.find(tableName) == res.end()) {
       res.emplace(tableName, Schema());
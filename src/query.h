@@ -2,43 +2,359 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <cmath>
+#include <memory_resource>
+#include <new>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
 #include <unordered_map>
+#include <stdexcept>
+#include <optional>
 #include "common.h"
+#include "arena.h"
+#include "dictionary.h"
+#include "datetime.h"
+#include "matcher.h"
 
 struct Tuple;
 struct Schema;
 class Constant;
+class TupleView;
 struct Token;
 
+enum class ValueType : u8 {
+  NUMBER, STRING, DOUBLE, DATE, TIMESTAMP, BOOLEAN
+};
+
+/**
+A 16 byte value used while rows are evaluated, it never allocates.
+
+Numbers are stored inline, so are strings of up to 12 characters. Longer strings keep their
+first 4 characters next to the length and point to the rest, which is owned by someone else
+(a pinned page, a field or a constant), the value is only valid as long as the owner is.
+A string of a DICT column is kept as its code and its dictionary, two codes of the same
+dictionary are compared without looking at the strings.
+Dates and timestamps are integers with their own tag, so a range over them compares integers.
+Comparisons follow Constant, numbers and doubles compare with each other, values of other
+different types are only not equal.
+*/
+class Value {
+  static constexpr u32 NUMBER_TAG = u32Max;
+  static constexpr u32 CODE_TAG = u32Max - 1;
+  static constexpr u32 DOUBLE_TAG = u32Max - 2;
+  static constexpr u32 DATE_TAG = u32Max - 3;
+  static constexpr u32 TIMESTAMP_TAG = u32Max - 4;
+  static constexpr u32 BOOLEAN_TAG = u32Max - 5;
+  static constexpr u32 PREFIX_SIZE = 4;
+  static constexpr u32 INLINE_SIZE = 12;
+
+  union {
+    struct {
+      u32 length;
+      char prefix[PREFIX_SIZE];
+      const char* data;
+    } pointer;
+    struct {
+      u32 length;
+      char chars[INLINE_SIZE];
+    } inlined;
+    struct {
+      u32 tag;
+      i64 num;
+    } number;
+    struct {
+      u32 tag;
+      double value;
+    } real;
+    struct {
+      u32 tag;
+      u32 code;
+      const Dictionary* dictionary;
+    } coded;
+  };
+
+  Value(u32 tag, i64 num) : number{ tag, num } {}
+
+  // the length and the first 4 characters, equal strings have equal heads
+  u64 head() const {
+    u64 head;
+    std::memcpy(&head, this, sizeof(u64));
+    return head;
+  }
+
+  // the last 8 bytes, characters 4 to 12 of an inline string or the pointer of a long one
+  u64 tail() const {
+    u64 tail;
+    std::memcpy(&tail, reinterpret_cast<const char*>(this) + sizeof(u64), sizeof(u64));
+    return tail;
+  }
+
+public:
+  Value() : number{ NUMBER_TAG, 0 } {}
+  Value(i64 num) : number{ NUMBER_TAG, num } {}
+  Value(std::string_view str) : inlined{ (u32)str.size(), {} } {
+    if (str.size() <= INLINE_SIZE) {
+      std::memcpy(inlined.chars, str.data(), str.size());
+    }
+    else {
+      std::memcpy(pointer.prefix, str.data(), PREFIX_SIZE);
+      pointer.data = str.data();
+    }
+  }
+  // a string of a DICT column, the code may be Dictionary::NO_CODE for a value that is not in the dictionary
+  Value(const Dictionary& dictionary, u32 code) : coded{ CODE_TAG, code, &dictionary } {}
+
+  // not constructors, Value(7) would be ambiguous with a double constructor
+  static Value fromDouble(double real) {
+    Value value;
+    value.real = { DOUBLE_TAG, real };
+    return value;
+  }
+  static Value date(i32 days) {
+    return Value(DATE_TAG, days);
+  }
+  static Value timestamp(i64 microseconds) {
+    return Value(TIMESTAMP_TAG, microseconds);
+  }
+  static Value boolean(bool flag) {
+    return Value(BOOLEAN_TAG, flag);
+  }
+
+  ValueType getType() const {
+    switch (number.tag) {
+    case NUMBER_TAG:
+      return ValueType::NUMBER;
+    case DOUBLE_TAG:
+      return ValueType::DOUBLE;
+    case DATE_TAG:
+      return ValueType::DATE;
+    case TIMESTAMP_TAG:
+      return ValueType::TIMESTAMP;
+    case BOOLEAN_TAG:
+      return ValueType::BOOLEAN;
+    default:
+      return ValueType::STRING;
+    }
+  }
+
+  // the integer of a number, date, timestamp or boolean
+  i64 getNumber() const {
+    return number.num;
+  }
+
+  double getDouble() const {
+    return number.tag == DOUBLE_TAG ? real.value : (double)number.num;
+  }
+
+  bool isCode() const {
+    return coded.tag == CODE_TAG;
+  }
+
+  const Dictionary* getDictionary() const {
+    return isCode() ? coded.dictionary : nullptr;
+  }
+
+  u32 getCode() const {
+    return coded.code;
+  }
+
+  std::string_view getString() const {
+    if (isCode()) {
+      return coded.dictionary->decode(coded.code);
+    }
+    if (inlined.length <= INLINE_SIZE) {
+      return std::string_view(inlined.chars, inlined.length);
+    }
+    return std::string_view(pointer.data, pointer.length);
+  }
+
+  bool operator==(const Value& other) const {
+    if (isCode() && other.isCode() && coded.dictionary == other.coded.dictionary) {
+      return coded.code == other.coded.code;
+    }
+    if (!isComparable(other)) {
+      return false;
+    }
+    if (isCode() || other.isCode()) {
+      return getString() == other.getString();
+    }
+    if (getType() != ValueType::STRING) {
+      return compare(other) == 0;
+    }
+    if (head() != other.head()) {
+      return false;
+    }
+    // inline strings are zero padded, the rest of them is compared at once
+    if (inlined.length <= INLINE_SIZE) {
+      return tail() == other.tail();
+    }
+    return std::memcmp(pointer.data + PREFIX_SIZE, other.pointer.data + PREFIX_SIZE, pointer.length - PREFIX_SIZE) == 0;
+  }
+
+  bool operator!=(const Value& other) const {
+    return !(*this == other);
+  }
+
+  bool operator<(const Value& other) const {
+    return isComparable(other) && compare(other) < 0;
+  }
+
+  bool operator<=(const Value& other) const {
+    return isComparable(other) && compare(other) <= 0;
+  }
+
+  bool operator>(const Value& other) const {
+    return isComparable(other) && compare(other) > 0;
+  }
+
+  bool operator>=(const Value& other) const {
+    return isComparable(other) && compare(other) >= 0;
+  }
+
+private:
+  static bool isNumeric(ValueType type) {
+    return type == ValueType::NUMBER || type == ValueType::DOUBLE;
+  }
+
+  bool isComparable(const Value& other) const {
+    ValueType type = getType();
+    ValueType otherType = other.getType();
+    return type == otherType || (isNumeric(type) && isNumeric(otherType));
+  }
+
+  // only for comparable values
+  int compare(const Value& other) const {
+    if (getType() == ValueType::STRING) {
+      return getString().compare(other.getString());
+    }
+    if (number.tag == DOUBLE_TAG || other.number.tag == DOUBLE_TAG) {
+      double lhs = getDouble();
+      double rhs = other.getDouble();
+      return lhs < rhs ? -1 : lhs > rhs;
+    }
+    return number.num < other.number.num ? -1 : number.num > other.number.num;
+  }
+};
+
+static_assert(sizeof(Value) == 16);
+
+enum class ConstantType {
+  STRING, NUMBER, DOUBLE, DATE, TIMESTAMP, BOOLEAN
+};
+
+inline std::string constantTypeName(ConstantType type) {
+  switch (type) {
+  case ConstantType::NUMBER:
+    return "NUMBER";
+  case ConstantType::DOUBLE:
+    return "DOUBLE";
+  case ConstantType::DATE:
+    return "DATE";
+  case ConstantType::TIMESTAMP:
+    return "TIMESTAMP";
+  case ConstantType::BOOLEAN:
+    return "BOOLEAN";
+  default:
+    return "STRING";
+  }
+}
+
+// a statement that names a column that does not exist, or compares or assigns values of
+// types that do not go together. it is raised before any row is read, except for an UPDATE
+// value that only turns out not to fit its column once it is computed for a row.
+class BindError : public std::runtime_error {
+public:
+  BindError(const std::string& message) : std::runtime_error(message) {}
+};
+
 class TableValue {
 public:
   virtual ~TableValue() = default;
   virtual bool operator==(const TableValue* other) const = 0;
   virtual Constant getConstant(Tuple& tuple, Schema& schema) = 0;
+  virtual Value getValue(TupleView& row, Schema& schema) = 0;
+  // resolve the columns the value refers to once, before the rows of the schema are evaluated.
+  // returns the type of the value.
+  virtual ConstantType bind(Schema& schema) = 0;
 };
 
-enum class ConstantType {
-  STRING, NUMBER
-};
-
+// a date is kept in num as days, a timestamp as microseconds and a boolean as 0 or 1.
 class Constant : public TableValue {
 public:
   virtual ~Constant() override {}
-  Constant(int num) : constantType{ ConstantType::NUMBER }, num{ num } {}
-  Constant(std::string str) : constantType{ ConstantType::STRING }, str{ str } {}
+  Constant(i64 num) : constantType{ ConstantType::NUMBER }, num{ num }, str{ ArenaScope::getResource() } {}
+  Constant(std::string_view str) : constantType{ ConstantType::STRING }, num{ 0 }, str{ str, ArenaScope::getResource() } {}
+  // a copy takes its string from the arena of the statement that makes it
+  Constant(const Constant& other) : TableValue(other), constantType{ other.constantType }, num{ other.num },
+    real{ other.real }, str{ other.str, ArenaScope::getResource() } {}
+  Constant(Constant&&) = default;
+  Constant& operator=(const Constant&) = default;
+  Constant& operator=(Constant&&) = default;
+
+  // not constructors, a string literal would be taken for a bool
+  static Constant fromDouble(double real) {
+    Constant constant(ConstantType::DOUBLE, 0);
+    constant.real = real;
+    return constant;
+  }
+  static Constant date(i32 days) {
+    return Constant(ConstantType::DATE, days);
+  }
+  static Constant timestamp(i64 microseconds) {
+    return Constant(ConstantType::TIMESTAMP, microseconds);
+  }
+  static Constant boolean(bool flag) {
+    return Constant(ConstantType::BOOLEAN, flag);
+  }
 
   bool operator==(const TableValue* other) const override;
   virtual Constant getConstant(Tuple& tuple, Schema& schema) override;
+  virtual Value getValue(TupleView& row, Schema& schema) override;
+  virtual ConstantType bind(Schema&) override {
+    return constantType;
+  }
 
-  bool operator==(const Constant& other) const {
-    if (constantType != other.constantType) {
-      return false;
+  // whether values of the types can be compared, a string is only compared with a date or a
+  // timestamp when it is a constant, see isReadableAs
+  static bool isComparable(ConstantType lhs, ConstantType rhs) {
+    auto isNumeric = [](ConstantType type) { return type == ConstantType::NUMBER || type == ConstantType::DOUBLE; };
+    auto isTime = [](ConstantType type) { return type == ConstantType::DATE || type == ConstantType::TIMESTAMP; };
+    return lhs == rhs || (isNumeric(lhs) && isNumeric(rhs)) ||
+      (lhs == ConstantType::STRING && isTime(rhs)) || (isTime(lhs) && rhs == ConstantType::STRING);
+  }
+
+  // whether the constant can be compared with a value of the type, a string must be a valid date or timestamp for those
+  bool isReadableAs(ConstantType type) const {
+    if (constantType != ConstantType::STRING || (type != ConstantType::DATE && type != ConstantType::TIMESTAMP)) {
+      return true;
     }
-    if (constantType == ConstantType::NUMBER) {
-      return num == other.num;
+    return parseAs(type).has_value();
+  }
+
+  // the value refers to the string of the constant
+  Value getValue() const {
+    switch (constantType) {
+    case ConstantType::NUMBER:
+      return Value(num);
+    case ConstantType::DOUBLE:
+      return Value::fromDouble(real);
+    case ConstantType::DATE:
+      return Value::date((i32)num);
+    case ConstantType::TIMESTAMP:
+      return Value::timestamp(num);
+    case ConstantType::BOOLEAN:
+      return Value::boolean(num != 0);
+    default:
+      return Value(str);
     }
-    return str == other.str;
+  }
+
+  bool operator==(const Constant& other) const {
+    auto order = compare(other);
+    return order && *order == 0;
   }
 
   bool operator!=(const Constant& other) const {
@@ -46,51 +362,91 @@ public:
   }
 
   bool operator>=(const Constant& other) const {
-    if (constantType != other.constantType) {
-      return false;
-    }
-    if (constantType == ConstantType::NUMBER) {
-      return num >= other.num;
-    }
-    return str >= other.str;
+    auto order = compare(other);
+    return order && *order >= 0;
   }
 
   bool operator>(const Constant& other) const {
-    if (constantType != other.constantType) {
-      return false;
-    }
-    if (constantType == ConstantType::NUMBER) {
-      return num > other.num;
-    }
-    return str > other.str;
+    auto order = compare(other);
+    return order && *order > 0;
   }
 
   bool operator<=(const Constant& other) const {
-    if (constantType != other.constantType) {
-      return false;
-    }
-    if (constantType == ConstantType::NUMBER) {
-      return num <= other.num;
-    }
-    return str <= other.str;
+    auto order = compare(other);
+    return order && *order <= 0;
   }
 
   bool operator<(const Constant& other) const {
-    if (constantType != other.constantType) {
-      return false;
-    }
-    if (constantType == ConstantType::NUMBER) {
-      return num < other.num;
-    }
-    return str < other.str;
+    auto order = compare(other);
+    return order && *order < 0;
   }
 
   ConstantType constantType;
-  int num;
-  std::string str;
+  i64 num;
+  double real = 0;
+  std::pmr::string str;
+
+private:
+  Constant(ConstantType constantType, i64 num) : constantType{ constantType }, num{ num }, str{ ArenaScope::getResource() } {}
+
+  bool isNumeric() const {
+    return constantType == ConstantType::NUMBER || constantType == ConstantType::DOUBLE;
+  }
+
+  double getDouble() const {
+    return constantType == ConstantType::DOUBLE ? real : (double)num;
+  }
+
+  // a string compared with a date or a timestamp is read as one
+  std::optional<i64> parseAs(ConstantType type) const {
+    if (type == ConstantType::DATE) {
+      auto days = DateTime::parseDate(str);
+      return days ? std::optional<i64>(*days) : std::nullopt;
+    }
+    return DateTime::parseTimestamp(str);
+  }
+
+  // the order of the constants, nothing if they can not be compared
+  std::optional<int> compare(const Constant& other) const {
+    if (constantType == other.constantType) {
+      switch (constantType) {
+      case ConstantType::STRING: {
+        int order = str.compare(other.str);
+        return order < 0 ? -1 : order > 0;
+      }
+      case ConstantType::DOUBLE:
+        return real < other.real ? -1 : real > other.real;
+      default:
+        return num < other.num ? -1 : num > other.num;
+      }
+    }
+    if (isNumeric() && other.isNumeric()) {
+      double lhs = getDouble();
+      double rhs = other.getDouble();
+      return lhs < rhs ? -1 : lhs > rhs;
+    }
+    bool isTime = constantType == ConstantType::DATE || constantType == ConstantType::TIMESTAMP;
+    bool isOtherTime = other.constantType == ConstantType::DATE || other.constantType == ConstantType::TIMESTAMP;
+    if (constantType == ConstantType::STRING && isOtherTime) {
+      auto lhs = parseAs(other.constantType);
+      if (!lhs) {
+        return std::nullopt;
+      }
+      return *lhs < other.num ? -1 : *lhs > other.num;
+    }
+    if (isTime && other.constantType == ConstantType::STRING) {
+      auto rhs = other.parseAs(constantType);
+      if (!rhs) {
+        return std::nullopt;
+      }
+      return num < *rhs ? -1 : num > *rhs;
+    }
+    return std::nullopt;
+  }
 };
 
 
+// a field without a table is written with its name as the table, it matches the column of any table.
 class Field : public TableValue {
 public:
   virtual ~Field() override {}
@@ -98,72 +454,689 @@ public:
   Field(std::string fieldName) : fieldName{ fieldName }, table{ fieldName } {}
   bool operator==(const TableValue* other) const override;
   virtual Constant getConstant(Tuple& tuple, Schema& schema) override;
+  virtual Value getValue(TupleView& row, Schema& schema) override;
+  virtual ConstantType bind(Schema& schema) override;
+
+  // the column of the field in the schema, it is only looked up when the schema changes
+  u32 getIndex(Schema& schema) {
+    if (&schema != boundSchema) {
+      bind(schema);
+    }
+    return index;
+  }
+
+  // the column of the field in the schema, a column of the named table is preferred
+  std::optional<u32> resolve(const Schema& schema) const;
+
+  std::string getName() const {
+    return table == fieldName ? fieldName : table + "." + fieldName;
+  }
+
 private:
   std::string fieldName;
   std::string table;
+  const Schema* boundSchema = nullptr;
+  u32 index = 0;
+};
+
+
+
+class WriteField {
+  // set by operator new for the constructor, fields of an arena are not freed one by one
+  inline static thread_local bool allocatingInArena = false;
+  bool isArenaAllocated;
+
+public:
+  WriteField() : isArenaAllocated{ allocatingInArena } {
+    allocatingInArena = false;
+  }
+  WriteField(const WriteField&) : WriteField() {}
+  WriteField& operator=(const WriteField&) {
+    return *this;
+  }
+  virtual ~WriteField() = default;
+  virtual u32 getLength() = 0;
+  virtual void write(char* buffer, u32 offset) = 0;
+  virtual Constant getConstant() = 0;
+  // the value refers to the field, it is valid as long as the field is
+  virtual Value getValue() = 0;
+
+  // fields created while an ArenaScope is alive are allocated from its arena
+  static void* operator new(std::size_t size) {
+    QueryArena* arena = ArenaScope::getCurrent();
+    allocatingInArena = arena != nullptr;
+    return arena ? arena->allocate(size, alignof(std::max_align_t)) : ::operator new(size);
+  }
+
+  // the field is destroyed, its memory is only freed if it came from the heap
+  static void operator delete(WriteField* field, std::destroying_delete_t) {
+    bool inArena = field->isArenaAllocated;
+    field->~WriteField();
+    if (!inArena) {
+      ::operator delete(field);
+    }
+  }
+
+  // a constructor threw, the scope is still the one the field was allocated in
+  static void operator delete(void* ptr) {
+    allocatingInArena = false;
+    if (!ArenaScope::getCurrent()) {
+      ::operator delete(ptr);
+    }
+  }
+};
+
+struct ResourceManager;
+
+// the heap file a row was read from, values stored in overflow pages are fetched from it.
+struct HeapFileSource {
+  std::shared_ptr<ResourceManager> rm;
+  std::string filename;
+};
+
+class ReadField {
+public:
+  virtual ~ReadField() = default;
+  virtual std::unique_ptr<ReadField> clone() = 0;
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) = 0;
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) {
+    return get(buffer, offset);
+  }
+  virtual std::unique_ptr<WriteField> get(Token token) = 0;
+  virtual std::unique_ptr<WriteField> get(Constant token) = 0;
+  virtual std::string serializeType() = 0;
+  // the type of the constants of the field
+  virtual ConstantType getConstantType() = 0;
+
+  // size of the field stored at offset, read in place without building the field.
+  virtual u32 getLength(const char* buffer, u32 offset) = 0;
+  // size of every value of the field, 0 if values differ in size.
+  virtual u32 getFixedWidth() {
+    return 0;
+  }
+  // value of the field stored at offset.
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>& source) {
+    return get(buffer, offset, source)->getConstant();
+  }
+  // value of the field referring to the buffer, false if the value is not stored in the row.
+  virtual bool getValue(const char*, u32, const std::shared_ptr<HeapFileSource>&, Value&) {
+    return false;
+  }
+};
+
+
+// a varchar stored in overflow pages has both lengths set to this marker, followed by
+// the length of the value and the first overflow page.
+const static u16 VARCHAR_OVERFLOW = 0xFFFF;
+const static u32 VARCHAR_OVERFLOW_SIZE = sizeof(u16) + sizeof(u16) + sizeof(u32) + sizeof(u64);
+
+// first 2 bytes is string length, then physical length then the string
+class VarCharField : public WriteField {
+  u16 physicalSize;
+  std::string value;
+public:
+  virtual ~VarCharField() override = default;
+  VarCharField(std::string_view value) :physicalSize{ (u16)value.size() }, value{ value } {}
+  VarCharField(std::string_view value, u16 physicalSize) : physicalSize{ physicalSize }, value{ value } {}
+
+  virtual u32 getLength() override {
+    return physicalSize + sizeof(u32);
+  }
+
+  virtual void write(char* buffer, u32 offset) override {
+    u16 length = (u16)value.size();
+    std::memcpy(buffer + offset, &length, sizeof(u16));
+    std::memcpy(buffer + offset + sizeof(u16), &physicalSize, sizeof(u16));
+    std::memcpy(buffer + offset + sizeof(u16) + sizeof(u16), value.c_str(), length);
+  }
+
+  virtual Constant getConstant() override {
+    return Constant(value);
+  }
+
+  virtual Value getValue() override {
+    return Value(value);
+  }
+
+  const std::string& getString() {
+    return value;
+  }
 };
 
+// a varchar that lives in overflow pages, only the pointer is stored in the row.
+// the value is read from the overflow pages the first time it is needed.
+class OverflowVarCharField : public WriteField {
+  std::shared_ptr<HeapFileSource> source;
+  u32 valueLength;
+  u64 firstPage;
+  bool isFetched;
+  std::string value;
+public:
+  virtual ~OverflowVarCharField() override = default;
+  OverflowVarCharField(std::shared_ptr<HeapFileSource> source, u32 valueLength, u64 firstPage) :
+    source{ source }, valueLength{ valueLength }, firstPage{ firstPage }, isFetched{ false } {}
+  OverflowVarCharField(std::shared_ptr<HeapFileSource> source, u64 firstPage, std::string value) :
+    source{ source }, valueLength{ (u32)value.size() }, firstPage{ firstPage }, isFetched{ true }, value{ std::move(value) } {}
+
+  virtual u32 getLength() override {
+    return VARCHAR_OVERFLOW_SIZE;
+  }
+
+  virtual void write(char* buffer, u32 offset) override {
+    std::memcpy(buffer + offset, &VARCHAR_OVERFLOW, sizeof(u16));
+    std::memcpy(buffer + offset + sizeof(u16), &VARCHAR_OVERFLOW, sizeof(u16));
+    std::memcpy(buffer + offset + sizeof(u16) + sizeof(u16), &valueLength, sizeof(u32));
+    std::memcpy(buffer + offset + sizeof(u16) + sizeof(u16) + sizeof(u32), &firstPage, sizeof(u64));
+  }
+
+  virtual Constant getConstant() override {
+    return Constant(getString());
+  }
+
+  virtual Value getValue() override {
+    return Value(getString());
+  }
+
+  const std::string& getString();
+
+  const std::string& getFilename() {
+    return source->filename;
+  }
+
+  u64 getFirstPage() {
+    return firstPage;
+  }
+};
+
+class ReadVarCharField : public ReadField {
+public:
+  ReadVarCharField() {}
+  virtual ~ReadVarCharField() = default;
+
+  virtual std::unique_ptr<ReadField> clone() override {
+    return std::make_unique<ReadVarCharField>();
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
+    return get(buffer, offset, nullptr);
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>& source) override {
+    u16 length, physicalSize;
+    std::memcpy(&length, buffer + offset, sizeof(u16));
+    std::memcpy(&physicalSize, buffer + offset + sizeof(u16), sizeof(u16));
+    if (length == VARCHAR_OVERFLOW && physicalSize == VARCHAR_OVERFLOW) {
+      if (!source) {
+        throw std::runtime_error("Overflow value read without its heap file");
+      }
+      u32 valueLength;
+      u64 firstPage;
+      std::memcpy(&valueLength, buffer + offset + sizeof(u16) + sizeof(u16), sizeof(u32));
+      std::memcpy(&firstPage, buffer + offset + sizeof(u16) + sizeof(u16) + sizeof(u32), sizeof(u64));
+      return std::make_unique<OverflowVarCharField>(source, valueLength, firstPage);
+    }
+    std::string value(buffer + offset + sizeof(u16) + sizeof(u16), length);
+    return std::make_unique<VarCharField>(value);
+  }
+
+  virtual u32 getLength(const char* buffer, u32 offset) override {
+    u16 length, physicalSize;
+    std::memcpy(&length, buffer + offset, sizeof(u16));
+    std::memcpy(&physicalSize, buffer + offset + sizeof(u16), sizeof(u16));
+    if (length == VARCHAR_OVERFLOW && physicalSize == VARCHAR_OVERFLOW) {
+      return VARCHAR_OVERFLOW_SIZE;
+    }
+    return physicalSize + sizeof(u32);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>& source) override {
+    u16 length, physicalSize;
+    std::memcpy(&length, buffer + offset, sizeof(u16));
+    std::memcpy(&physicalSize, buffer + offset + sizeof(u16), sizeof(u16));
+    if (length == VARCHAR_OVERFLOW && physicalSize == VARCHAR_OVERFLOW) {
+      return get(buffer, offset, source)->getConstant();
+    }
+    return Constant(std::string(buffer + offset + sizeof(u16) + sizeof(u16), length));
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    u16 length, physicalSize;
+    std::memcpy(&length, buffer + offset, sizeof(u16));
+    std::memcpy(&physicalSize, buffer + offset + sizeof(u16), sizeof(u16));
+    if (length == VARCHAR_OVERFLOW && physicalSize == VARCHAR_OVERFLOW) {
+      return false;
+    }
+    value = Value(std::string_view(buffer + offset + sizeof(u16) + sizeof(u16), length));
+    return true;
+  }
+
+  virtual std::unique_ptr<WriteField> get(Token token) override;
+
+  std::unique_ptr<WriteField> get(Constant constant) override;
+
+  virtual std::string serializeType() override {
+    return "VARCHAR";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::STRING;
+  }
+};
+
+class FixedCharField : public WriteField {
+private:
+  int length;
+  std::string value;
+public:
+  FixedCharField(int length, std::string_view value) : length{ length }, value{ value } {}
+  virtual ~FixedCharField() override = default;
+
+  // for a row codec that decodes rows into the same field, the string keeps its capacity
+  void setValue(const char* newValue, std::size_t size) {
+    value.assign(newValue, size);
+  }
+
+  virtual u32 getLength() override {
+    return length;
+  }
+  virtual void write(char* buffer, u32 offset) override {
+    // pad with zeroes so stale bytes of the page never leak into the value
+    u32 valueSize = std::min((u32)value.size(), (u32)length);
+    std::memcpy(buffer + offset, value.c_str(), valueSize);
+    std::memset(buffer + offset + valueSize, 0, length - valueSize);
+  }
+  virtual Constant getConstant() override {
+    return Constant(value);
+  }
+  virtual Value getValue() override {
+    return Value(value);
+  }
+
+
+};
+
+class ReadFixedCharField : public ReadField {
+private:
+  int length;
+public:
+  ReadFixedCharField(int length) : length{ length } {}
+  virtual ~ReadFixedCharField() override = default;
+
+  virtual std::unique_ptr<ReadField> clone() override {
+    return std::make_unique<ReadFixedCharField>(length);
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
+    std::string value(buffer + offset, strnlen(buffer + offset, length));
+    return std::make_unique<FixedCharField>(length, value);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return length;
+  }
+  virtual u32 getFixedWidth() override {
+    return length;
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) override {
+    return Constant(std::string(buffer + offset, strnlen(buffer + offset, length)));
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    value = Value(std::string_view(buffer + offset, strnlen(buffer + offset, length)));
+    return true;
+  }
+
+  virtual std::unique_ptr<WriteField> get(Token token) override;
+
+  std::unique_ptr<WriteField> get(Constant constant) override;
+
+
+  virtual std::string serializeType() override {
+    return "CHAR(" + std::to_string(length) + ")";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::STRING;
+  }
+
+  u32 getCharLength() const {
+    return length;
+  }
+};
+
+class IntField : public WriteField {
+private:
+  i32 value;
+public:
+  IntField(i32 value) : value{ value } {}
+  virtual ~IntField() override = default;
+
+  // for a row codec that decodes rows into the same field
+  void setValue(i32 newValue) {
+    value = newValue;
+  }
+
+  virtual u32 getLength() override {
+    return sizeof(i32);
+  }
+  virtual void write(char* buffer, u32 offset) override {
+    std::memcpy(buffer + offset, &value, sizeof(i32));
+  }
+  virtual Constant getConstant() override {
+    return Constant(value);
+  }
+  virtual Value getValue() override {
+    return Value(value);
+  }
+};
+
+class ReadIntField : public ReadField {
+public:
+  ReadIntField() {}
+  virtual ~ReadIntField() override = default;
+
+  virtual std::unique_ptr<ReadField> clone() override {
+    return std::make_unique<ReadIntField>();
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
+    i32 value;
+    std::memcpy(&value, buffer + offset, sizeof(i32));
+    return std::make_unique<IntField>(value);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return sizeof(i32);
+  }
+  virtual u32 getFixedWidth() override {
+    return sizeof(i32);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) override {
+    i32 value;
+    std::memcpy(&value, buffer + offset, sizeof(i32));
+    return Constant(value);
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    i32 num;
+    std::memcpy(&num, buffer + offset, sizeof(i32));
+    value = Value(num);
+    return true;
+  }
+
+  virtual std::unique_ptr<WriteField> get(Token token) override;
+
+  std::unique_ptr<WriteField> get(Constant constant) override;
+
+
+  virtual std::string serializeType() override {
+    return "INT";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::NUMBER;
+  }
+};
+
+class BigIntField : public WriteField {
+private:
+  i64 value;
+public:
+  BigIntField(i64 value) : value{ value } {}
+  virtual ~BigIntField() override = default;
+
+  virtual u32 getLength() override {
+    return sizeof(i64);
+  }
+  virtual void write(char* buffer, u32 offset) override {
+    std::memcpy(buffer + offset, &value, sizeof(i64));
+  }
+  virtual Constant getConstant() override {
+    return Constant(value);
+  }
+  virtual Value getValue() override {
+    return Value(value);
+  }
+};
+
+class ReadBigIntField : public ReadField {
+public:
+  ReadBigIntField() {}
+  virtual ~ReadBigIntField() override = default;
+
+  virtual std::unique_ptr<ReadField> clone() override {
+    return std::make_unique<ReadBigIntField>();
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
+    i64 value;
+    std::memcpy(&value, buffer + offset, sizeof(i64));
+    return std::make_unique<BigIntField>(value);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return sizeof(i64);
+  }
+  virtual u32 getFixedWidth() override {
+    return sizeof(i64);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) override {
+    i64 value;
+    std::memcpy(&value, buffer + offset, sizeof(i64));
+    return Constant(value);
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    i64 num;
+    std::memcpy(&num, buffer + offset, sizeof(i64));
+    value = Value(num);
+    return true;
+  }
+
+  virtual std::unique_ptr<WriteField> get(Token token) override;
+
+  std::unique_ptr<WriteField> get(Constant constant) override;
+
+  virtual std::string serializeType() override {
+    return "BIGINT";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::NUMBER;
+  }
+};
+
+class DoubleField : public WriteField {
+private:
+  double value;
+public:
+  DoubleField(double value) : value{ value } {}
+  virtual ~DoubleField() override = default;
+
+  virtual u32 getLength() override {
+    return sizeof(double);
+  }
+  virtual void write(char* buffer, u32 offset) override {
+    std::memcpy(buffer + offset, &value, sizeof(double));
+  }
+  virtual Constant getConstant() override {
+    return Constant::fromDouble(value);
+  }
+  virtual Value getValue() override {
+    return Value::fromDouble(value);
+  }
+};
+
+class ReadDoubleField : public ReadField {
+public:
+  ReadDoubleField() {}
+  virtual ~ReadDoubleField() override = default;
+
+  virtual std::unique_ptr<ReadField> clone() override {
+    return std::make_unique<ReadDoubleField>();
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
+    double value;
+    std::memcpy(&value, buffer + offset, sizeof(double));
+    return std::make_unique<DoubleField>(value);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return sizeof(double);
+  }
+  virtual u32 getFixedWidth() override {
+    return sizeof(double);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) override {
+    double value;
+    std::memcpy(&value, buffer + offset, sizeof(double));
+    return Constant::fromDouble(value);
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    double real;
+    std::memcpy(&real, buffer + offset, sizeof(double));
+    value = Value::fromDouble(real);
+    return true;
+  }
+
+  virtual std::unique_ptr<WriteField> get(Token token) override;
+
+  std::unique_ptr<WriteField> get(Constant constant) override;
+
+  virtual std::string serializeType() override {
+    return "DOUBLE";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::DOUBLE;
+  }
+};
+
+// days since 1970-01-01, see DateTime
+class DateField : public WriteField {
+private:
+  i32 days;
+public:
+  DateField(i32 days) : days{ days } {}
+  virtual ~DateField() override = default;
+
+  virtual u32 getLength() override {
+    return sizeof(i32);
+  }
+  virtual void write(char* buffer, u32 offset) override {
+    std::memcpy(buffer + offset, &days, sizeof(i32));
+  }
+  virtual Constant getConstant() override {
+    return Constant::date(days);
+  }
+  virtual Value getValue() override {
+    return Value::date(days);
+  }
+};
+
+class ReadDateField : public ReadField {
+public:
+  ReadDateField() {}
+  virtual ~ReadDateField() override = default;
+
+  virtual std::unique_ptr<ReadField> clone() override {
+    return std::make_unique<ReadDateField>();
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
+    i32 days;
+    std::memcpy(&days, buffer + offset, sizeof(i32));
+    return std::make_unique<DateField>(days);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return sizeof(i32);
+  }
+  virtual u32 getFixedWidth() override {
+    return sizeof(i32);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) override {
+    i32 days;
+    std::memcpy(&days, buffer + offset, sizeof(i32));
+    return Constant::date(days);
+  }
 
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    i32 days;
+    std::memcpy(&days, buffer + offset, sizeof(i32));
+    value = Value::date(days);
+    return true;
+  }
 
-class WriteField {
-public:
-  virtual ~WriteField() = default;
-  virtual u32 getLength() = 0;
-  virtual void write(char* buffer, u32 offset) = 0;
-  virtual Constant getConstant() = 0;
-};
+  virtual std::unique_ptr<WriteField> get(Token token) override;
 
-class ReadField {
-public:
-  virtual ~ReadField() = default;
-  virtual std::unique_ptr<ReadField> clone() = 0;
-  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) = 0;
-  virtual std::unique_ptr<WriteField> get(Token token) = 0;
-  virtual std::unique_ptr<WriteField> get(Constant token) = 0;
-  virtual std::string serializeType() = 0;
-};
+  std::unique_ptr<WriteField> get(Constant constant) override;
 
+  virtual std::string serializeType() override {
+    return "DATE";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::DATE;
+  }
+};
 
-// first 2 bytes is string length, then physical length then the string
-class VarCharField : public WriteField {
-  u16 physicalSize;
-  std::string value;
+// microseconds since 1970-01-01 00:00:00, see DateTime
+class TimestampField : public WriteField {
+private:
+  i64 microseconds;
 public:
-  virtual ~VarCharField() override = default;
-  VarCharField(std::string value) :physicalSize{ (u16)value.size() }, value{ value } {}
-  VarCharField(std::string value, u16 physicalSize) : physicalSize{ physicalSize }, value{ value } {}
+  TimestampField(i64 microseconds) : microseconds{ microseconds } {}
+  virtual ~TimestampField() override = default;
 
   virtual u32 getLength() override {
-    return physicalSize + sizeof(u32);
+    return sizeof(i64);
   }
-
   virtual void write(char* buffer, u32 offset) override {
-    u16 length = (u16)value.size();
-    std::memcpy(buffer + offset, &length, sizeof(u16));
-    std::memcpy(buffer + offset + sizeof(u16), &physicalSize, sizeof(u16));
-    std::memcpy(buffer + offset + sizeof(u16) + sizeof(u16), value.c_str(), length);
+    std::memcpy(buffer + offset, &microseconds, sizeof(i64));
   }
-
   virtual Constant getConstant() override {
-    return Constant(value);
+    return Constant::timestamp(microseconds);
+  }
+  virtual Value getValue() override {
+    return Value::timestamp(microseconds);
   }
 };
 
-class ReadVarCharField : public ReadField {
+class ReadTimestampField : public ReadField {
 public:
-  ReadVarCharField() {}
-  virtual ~ReadVarCharField() = default;
+  ReadTimestampField() {}
+  virtual ~ReadTimestampField() override = default;
 
   virtual std::unique_ptr<ReadField> clone() override {
-    return std::make_unique<ReadVarCharField>();
+    return std::make_unique<ReadTimestampField>();
   }
 
   virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
-    u16 length, physicalSize;
-    std::memcpy(&length, buffer + offset, sizeof(u16));
-    std::memcpy(&physicalSize, buffer + offset + sizeof(u16), sizeof(u16));
-    std::string value(buffer + offset + sizeof(u16) + sizeof(u16), length);
-    return std::make_unique<VarCharField>(value);
+    i64 microseconds;
+    std::memcpy(&microseconds, buffer + offset, sizeof(i64));
+    return std::make_unique<TimestampField>(microseconds);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return sizeof(i64);
+  }
+  virtual u32 getFixedWidth() override {
+    return sizeof(i64);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) override {
+    i64 microseconds;
+    std::memcpy(&microseconds, buffer + offset, sizeof(i64));
+    return Constant::timestamp(microseconds);
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    i64 microseconds;
+    std::memcpy(&microseconds, buffer + offset, sizeof(i64));
+    value = Value::timestamp(microseconds);
+    return true;
   }
 
   virtual std::unique_ptr<WriteField> get(Token token) override;
@@ -171,108 +1144,228 @@ public:
   std::unique_ptr<WriteField> get(Constant constant) override;
 
   virtual std::string serializeType() override {
-    return "VARCHAR";
+    return "TIMESTAMP";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::TIMESTAMP;
   }
 };
 
-class FixedCharField : public WriteField {
+class BoolField : public WriteField {
 private:
-  int length;
-  std::string value;
+  bool value;
 public:
-  FixedCharField(int length, std::string value) : length{ length }, value{ value } {}
-  virtual ~FixedCharField() override = default;
+  BoolField(bool value) : value{ value } {}
+  virtual ~BoolField() override = default;
 
   virtual u32 getLength() override {
-    return length;
+    return sizeof(u8);
   }
   virtual void write(char* buffer, u32 offset) override {
-    std::memcpy(buffer + offset, value.c_str(), value.size());
+    buffer[offset] = value ? 1 : 0;
   }
   virtual Constant getConstant() override {
-    return Constant(value);
+    return Constant::boolean(value);
+  }
+  virtual Value getValue() override {
+    return Value::boolean(value);
   }
-
-
 };
 
-class ReadFixedCharField : public ReadField {
-private:
-  int length;
+class ReadBoolField : public ReadField {
 public:
-  ReadFixedCharField(int length) : length{ length } {}
-  virtual ~ReadFixedCharField() override = default;
+  ReadBoolField() {}
+  virtual ~ReadBoolField() override = default;
 
   virtual std::unique_ptr<ReadField> clone() override {
-    return std::make_unique<ReadFixedCharField>(length);
+    return std::make_unique<ReadBoolField>();
   }
 
   virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
-    std::string value(buffer + offset);
-    return std::make_unique<FixedCharField>(length, value);
+    return std::make_unique<BoolField>(buffer[offset] != 0);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return sizeof(u8);
+  }
+  virtual u32 getFixedWidth() override {
+    return sizeof(u8);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&) override {
+    return Constant::boolean(buffer[offset] != 0);
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>&, Value& value) override {
+    value = Value::boolean(buffer[offset] != 0);
+    return true;
   }
 
   virtual std::unique_ptr<WriteField> get(Token token) override;
 
   std::unique_ptr<WriteField> get(Constant constant) override;
 
-
   virtual std::string serializeType() override {
-    return "CHAR(" + std::to_string(length) + ")";
+    return "BOOLEAN";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::BOOLEAN;
   }
 };
 
-class IntField : public WriteField {
+// a value of a DICT column, the row stores its code in the dictionary of the table.
+// a value that was not read from a table has no code until it is written, see HeapFile::encodeDictionaryFields.
+class DictField : public WriteField {
 private:
-  i32 value;
+  std::string value;
+  u32 code;
+  // the dictionary the code belongs to, kept alive so the code can not be taken for a code of another dictionary
+  std::shared_ptr<Dictionary> dictionary;
 public:
-  IntField(i32 value) : value{ value } {}
-  virtual ~IntField() override = default;
+  DictField(std::string value) : value{ std::move(value) }, code{ Dictionary::NO_CODE } {}
+  DictField(std::string value, u32 code, std::shared_ptr<Dictionary> dictionary) :
+    value{ std::move(value) }, code{ code }, dictionary{ std::move(dictionary) } {}
+  virtual ~DictField() override = default;
 
   virtual u32 getLength() override {
-    return sizeof(i32);
+    return sizeof(u16);
   }
+
   virtual void write(char* buffer, u32 offset) override {
-    std::memcpy(buffer + offset, &value, sizeof(i32));
+    if (!dictionary) {
+      throw std::runtime_error("Dictionary value is written without its code");
+    }
+    u16 storedCode = (u16)code;
+    std::memcpy(buffer + offset, &storedCode, sizeof(u16));
   }
+
   virtual Constant getConstant() override {
     return Constant(value);
   }
+
+  virtual Value getValue() override {
+    if (dictionary) {
+      return Value(*dictionary, code);
+    }
+    return Value(value);
+  }
+
+  const std::string& getString() {
+    return value;
+  }
+
+  const Dictionary* getDictionary() {
+    return dictionary.get();
+  }
+
+  void setCode(u32 newCode, std::shared_ptr<Dictionary> newDictionary) {
+    code = newCode;
+    dictionary = std::move(newDictionary);
+  }
 };
 
-class ReadIntField : public ReadField {
+class ReadDictField : public ReadField {
+private:
+  // the dictionary of the table the field was last read from, it is looked up once per table
+  std::shared_ptr<HeapFileSource> dictionarySource;
+  std::shared_ptr<Dictionary> dictionary;
+
+  std::shared_ptr<Dictionary>& getDictionary(const std::shared_ptr<HeapFileSource>& source);
+
+  static u32 readCode(const char* buffer, u32 offset) {
+    u16 code;
+    std::memcpy(&code, buffer + offset, sizeof(u16));
+    return code;
+  }
+
 public:
-  ReadIntField() {}
-  virtual ~ReadIntField() override = default;
+  ReadDictField() {}
+  virtual ~ReadDictField() override = default;
 
   virtual std::unique_ptr<ReadField> clone() override {
-    return std::make_unique<ReadIntField>();
+    return std::make_unique<ReadDictField>();
   }
 
   virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset) override {
-    i32 value;
-    std::memcpy(&value, buffer + offset, sizeof(i32));
-    return std::make_unique<IntField>(value);
+    return get(buffer, offset, nullptr);
+  }
+
+  virtual std::unique_ptr<WriteField> get(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>& source) override {
+    auto& tableDictionary = getDictionary(source);
+    u32 code = readCode(buffer, offset);
+    return std::make_unique<DictField>(tableDictionary->decode(code), code, tableDictionary);
+  }
+
+  virtual u32 getLength(const char*, u32) override {
+    return sizeof(u16);
+  }
+  virtual u32 getFixedWidth() override {
+    return sizeof(u16);
+  }
+
+  virtual Constant getConstant(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>& source) override {
+    return Constant(getDictionary(source)->decode(readCode(buffer, offset)));
+  }
+
+  virtual bool getValue(const char* buffer, u32 offset, const std::shared_ptr<HeapFileSource>& source, Value& value) override {
+    value = Value(*getDictionary(source), readCode(buffer, offset));
+    return true;
   }
 
   virtual std::unique_ptr<WriteField> get(Token token) override;
 
   std::unique_ptr<WriteField> get(Constant constant) override;
 
-
   virtual std::string serializeType() override {
-    return "INT";
+    return "DICT";
+  }
+  virtual ConstantType getConstantType() override {
+    return ConstantType::STRING;
+  }
+};
+
+// a stored row starts with the offset of every column from the start of the row, followed by a
+// null bitmap, so any column is read without decoding the columns before it.
+// nothing writes NULL yet, the bitmap is kept so the format does not change when it does.
+struct RowHeader {
+  static constexpr u32 size(u32 numberOfColumns) {
+    return numberOfColumns * sizeof(u16) + (numberOfColumns + 7) / 8;
+  }
+
+  static u32 columnOffset(const char* row, u32 idx) {
+    u16 offset;
+    std::memcpy(&offset, row + idx * sizeof(u16), sizeof(u16));
+    return offset;
   }
+
+  static bool isNull(const char* row, u32 numberOfColumns, u32 idx) {
+    const u8* nullBitmap = reinterpret_cast<const u8*>(row + numberOfColumns * sizeof(u16));
+    return (nullBitmap[idx / 8] >> (idx % 8)) & 1;
+  }
+};
+
+// where the values of one column are stored in a PAX page, the value of row r is at offset + r * width.
+struct Minipage {
+  u32 offset;
+  u32 width;
 };
 
 struct Tuple {
-  std::vector<std::unique_ptr<WriteField>> fields;
+  // the fields of a row made while a statement runs come from its arena, see ArenaScope::getResource
+  using Fields = std::pmr::vector<std::unique_ptr<WriteField>>;
+
+  Fields fields;
+  // size of the stored row, including its row header
   u32 recordSize;
-  Tuple(std::vector<std::unique_ptr<WriteField>> inputFields) : fields{ std::move(inputFields) } {
-    recordSize = 0;
-    for (auto& field : this->fields) {
-      recordSize += field->getLength();
-    }
+  Tuple(Fields inputFields) : fields{ std::move(inputFields) } {
+    computeRecordSize();
+  }
+  // for callers that already know the size of the row
+  Tuple(Fields inputFields, u32 recordSize) : fields{ std::move(inputFields) }, recordSize{ recordSize } {}
+  Tuple(std::vector<std::unique_ptr<WriteField>> inputFields) : fields{ ArenaScope::getResource() } {
+    fields.reserve(inputFields.size());
+    std::move(inputFields.begin(), inputFields.end(), std::back_inserter(fields));
+    computeRecordSize();
   }
 
   u32 set(u32 idx, std::unique_ptr<WriteField> field) {
@@ -280,26 +1373,144 @@ struct Tuple {
       return 0;
     }
     fields[idx] = std::move(field);
-    recordSize = 0;
+    computeRecordSize();
+    return recordSize;
+  }
+
+  // write the row header and the fields, recordSize bytes starting at offset.
+  void write(char* buffer, u32 offset) {
+    u32 numberOfColumns = (u32)fields.size();
+    u32 columnOffset = RowHeader::size(numberOfColumns);
+    for (u32 i = 0; i < numberOfColumns; ++i) {
+      u16 storedOffset = (u16)columnOffset;
+      std::memcpy(buffer + offset + i * sizeof(u16), &storedOffset, sizeof(u16));
+      fields[i]->write(buffer, offset + columnOffset);
+      columnOffset += fields[i]->getLength();
+    }
+    std::memset(buffer + offset + numberOfColumns * sizeof(u16), 0, (numberOfColumns + 7) / 8);
+  }
+
+private:
+  void computeRecordSize() {
+    recordSize = RowHeader::size((u32)fields.size());
     for (auto& field : this->fields) {
       recordSize += field->getLength();
     }
-    return recordSize;
   }
 };
 
+// a row read in place from a pinned tuple page, columns are decoded only when they are asked for.
+// the view is only valid while the page stays pinned, materialize() copies the row into a Tuple.
+// scans that cannot point into a page wrap a materialized tuple instead.
+class TupleView {
+  const char* buffer;
+  u32 offset;
+  const std::vector<ReadField*>* readFields;
+  const std::shared_ptr<HeapFileSource>* source;
+  std::optional<Tuple> tuple;
+  // values that are not stored in the row are read in here, so values can refer to them
+  std::vector<std::unique_ptr<std::string>> outOfRowValues;
+  // set for a row of a PAX page, offset is then the row number
+  const Minipage* minipages = nullptr;
+
+  u32 columnOffset(u32 idx) {
+    if (minipages) {
+      return minipages[idx].offset + offset * minipages[idx].width;
+    }
+    return offset + RowHeader::columnOffset(buffer + offset, idx);
+  }
+
+public:
+  TupleView(const char* buffer, u32 offset, const std::vector<ReadField*>& readFields, const std::shared_ptr<HeapFileSource>& source) :
+    buffer{ buffer }, offset{ offset }, readFields{ &readFields }, source{ &source } {}
+  // a row of a PAX page, its columns are spread over the minipages of the page.
+  TupleView(const char* page, const Minipage* minipages, u32 row, const std::vector<ReadField*>& readFields,
+    const std::shared_ptr<HeapFileSource>& source) :
+    buffer{ page }, offset{ row }, readFields{ &readFields }, source{ &source }, minipages{ minipages } {}
+  TupleView(Tuple&& tuple) : buffer{ nullptr }, offset{ 0 }, readFields{ nullptr }, source{ nullptr }, tuple{ std::move(tuple) } {}
+
+  bool isInPlace() const {
+    return !tuple.has_value();
+  }
+
+  // where the column is stored in the page, only for a row read in place
+  const char* columnData(u32 idx) {
+    return buffer + columnOffset(idx);
+  }
+
+  bool isNull(u32 idx) {
+    if (tuple || minipages) {
+      return false;
+    }
+    return RowHeader::isNull(buffer + offset, (u32)readFields->size(), idx);
+  }
+
+  Constant getConstant(u32 idx) {
+    if (tuple) {
+      return tuple->fields[idx]->getConstant();
+    }
+    return (*readFields)[idx]->getConstant(buffer, columnOffset(idx), *source);
+  }
+
+  // the value refers to the page, or to the view for values that are not stored in the row
+  Value getValue(u32 idx) {
+    if (tuple) {
+      return tuple->fields[idx]->getValue();
+    }
+    Value value;
+    if ((*readFields)[idx]->getValue(buffer, columnOffset(idx), *source, value)) {
+      return value;
+    }
+    outOfRowValues.push_back(std::make_unique<std::string>(getConstant(idx).str));
+    return Value(*outOfRowValues.back());
+  }
+
+  // a wrapped tuple hands over its field, so each column can be taken once.
+  std::unique_ptr<WriteField> getField(u32 idx) {
+    if (tuple) {
+      return std::move(tuple->fields[idx]);
+    }
+    return (*readFields)[idx]->get(buffer, columnOffset(idx), *source);
+  }
+
+  Tuple materialize() {
+    if (tuple) {
+      return std::move(*tuple);
+    }
+    Tuple::Fields output(ArenaScope::getResource());
+    for (u32 i = 0; i < readFields->size(); ++i) {
+      output.push_back((*readFields)[i]->get(buffer, columnOffset(i), *source));
+    }
+    return Tuple(std::move(output));
+  }
+};
+
+// IN compares the lhs with a list of constants, LIKE with a pattern in a string constant
 enum class TermOperand {
-  EQUAL, NOT_EQUAL, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL,
+  EQUAL, NOT_EQUAL, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL, IN, LIKE,
 };
 
 
 class Term {
+  friend class PredicateProgram;
+  friend class PredicateSimplifier;
 public:
   // move constructor
-  Term(TermOperand op, std::unique_ptr<TableValue>&& lhs, std::unique_ptr<TableValue>&& rhs) : op{ op }, lhs{ std::move(lhs) }, rhs{ std::move(rhs) } {}
+  Term(TermOperand op, std::unique_ptr<TableValue>&& lhs, std::unique_ptr<TableValue>&& rhs) : op{ op }, lhs{ std::move(lhs) }, rhs{ std::move(rhs) },
+    isLhsConstant{ dynamic_cast<Constant*>(this->lhs.get()) != nullptr }, isRhsConstant{ dynamic_cast<Constant*>(this->rhs.get()) != nullptr } {
+    if (op == TermOperand::LIKE && isRhsConstant) {
+      likePattern = LikePattern(static_cast<Constant*>(this->rhs.get())->str);
+    }
+  }
+  // lhs IN (list), the term has no rhs
+  Term(std::unique_ptr<TableValue>&& lhs, std::vector<Constant> list) : op{ TermOperand::IN }, lhs{ std::move(lhs) },
+    isLhsConstant{ dynamic_cast<Constant*>(this->lhs.get()) != nullptr }, isRhsConstant{ false }, inList{ std::move(list) } {}
   bool operator==(const Term& other) const {
     const TableValue* lhsVal = this->lhs.get();
     const TableValue* rhsVal = this->rhs.get();
+    if (op == TermOperand::IN) {
+      return other.op == op && lhsVal != nullptr && other.lhs != nullptr && *lhsVal == other.lhs.get() && inList == other.inList;
+    }
     if (op == other.op && lhsVal == nullptr && rhsVal == nullptr && other.lhs == nullptr && other.rhs == nullptr) {
       return true;
     }
@@ -310,9 +1521,165 @@ public:
     return false;
   }
 
+  // resolve the columns of the term and check that its sides can be compared.
+  void bind(Schema& schema) {
+    if (op == TermOperand::IN) {
+      bindList(lhs->bind(schema));
+      return;
+    }
+    ConstantType lhsType = lhs->bind(schema);
+    ConstantType rhsType = rhs->bind(schema);
+    if (op == TermOperand::LIKE && (lhsType != ConstantType::STRING || rhsType != ConstantType::STRING || !isRhsConstant)) {
+      throw BindError("Cannot match " + constantTypeName(lhsType) + " with LIKE");
+    }
+    bool isLhsString = lhsType == ConstantType::STRING && lhsType != rhsType;
+    bool isRhsString = rhsType == ConstantType::STRING && lhsType != rhsType;
+    if (!Constant::isComparable(lhsType, rhsType) || (isLhsString && !isLhsConstant) || (isRhsString && !isRhsConstant)) {
+      throw BindError("Cannot compare " + constantTypeName(lhsType) + " with " + constantTypeName(rhsType));
+    }
+    auto checkConstant = [](TableValue* value, bool isConstant, ConstantType type) {
+      if (isConstant && !static_cast<Constant*>(value)->isReadableAs(type)) {
+        throw BindError("Invalid " + constantTypeName(type) + ": " + std::string(static_cast<Constant*>(value)->str));
+      }
+    };
+    checkConstant(lhs.get(), isLhsConstant, rhsType);
+    checkConstant(rhs.get(), isRhsConstant, lhsType);
+  }
+
   bool evaluate(Tuple& tuple, Schema& schema) {
-    Constant lhsConstant = lhs->getConstant(tuple, schema);
-    Constant rhsConstant = rhs->getConstant(tuple, schema);
+    if (op == TermOperand::IN) {
+      return contains(lhs->getConstant(tuple, schema).getValue());
+    }
+    if (op == TermOperand::LIKE) {
+      return likePattern.matches(lhs->getConstant(tuple, schema).str);
+    }
+    return compare(lhs->getConstant(tuple, schema), rhs->getConstant(tuple, schema));
+  }
+
+  bool evaluate(TupleView& row, Schema& schema) {
+    if (op == TermOperand::IN) {
+      return contains(lhs->getValue(row, schema));
+    }
+    if (op == TermOperand::LIKE) {
+      return likePattern.matches(lhs->getValue(row, schema).getString());
+    }
+    Value lhsValue = lhs->getValue(row, schema);
+    Value rhsValue = rhs->getValue(row, schema);
+    if (isRhsConstant) {
+      rhsValue = convertConstant(lhsValue, rhsValue);
+    }
+    else if (isLhsConstant) {
+      lhsValue = convertConstant(rhsValue, lhsValue);
+    }
+    return compare(lhsValue, rhsValue);
+  }
+
+private:
+  // check the constants of an IN list like the rhs of a comparison, and keep them in the form the lhs is read in
+  void bindList(ConstantType lhsType) {
+    for (auto& constant : inList) {
+      bool isLhsString = lhsType == ConstantType::STRING && constant.constantType != lhsType;
+      if (!Constant::isComparable(lhsType, constant.constantType) || (isLhsString && !isLhsConstant)) {
+        throw BindError("Cannot compare " + constantTypeName(lhsType) + " with " + constantTypeName(constant.constantType));
+      }
+      if (!constant.isReadableAs(lhsType)) {
+        throw BindError("Invalid " + constantTypeName(lhsType) + ": " + std::string(constant.str));
+      }
+    }
+
+    if (lhsType == ConstantType::STRING) {
+      std::vector<std::string> strings;
+      for (auto& constant : inList) {
+        strings.emplace_back(constant.str);
+      }
+      inSet.assign(std::move(strings));
+    }
+    else if (lhsType == ConstantType::DOUBLE) {
+      std::vector<double> reals;
+      for (auto& constant : inList) {
+        reals.push_back(constant.constantType == ConstantType::DOUBLE ? constant.real : (double)constant.num);
+      }
+      inSet.assign(std::move(reals));
+    }
+    else {
+      std::vector<i64> integers;
+      for (auto& constant : inList) {
+        if (constant.constantType == ConstantType::STRING && lhsType == ConstantType::DATE) {
+          integers.push_back(*DateTime::parseDate(constant.str));
+        }
+        else if (constant.constantType == ConstantType::STRING) {
+          integers.push_back(*DateTime::parseTimestamp(constant.str));
+        }
+        else if (constant.constantType == ConstantType::DOUBLE) {
+          // an integer column only holds a double that is an integer, the others never match.
+          // 2^63 itself is not an i64, the comparison is exact as both bounds are powers of two
+          double real = constant.real;
+          if (std::trunc(real) == real && real >= -9223372036854775808.0 && real < 9223372036854775808.0) {
+            integers.push_back((i64)real);
+          }
+        }
+        else {
+          integers.push_back(constant.num);
+        }
+      }
+      inSet.assign(std::move(integers));
+    }
+  }
+
+  bool contains(const Value& value) const {
+    switch (inSet.getKind()) {
+    case ValueSet::Kind::STRING:
+      return value.getType() == ValueType::STRING && inSet.contains(value.getString());
+    case ValueSet::Kind::REAL:
+      return (value.getType() == ValueType::NUMBER || value.getType() == ValueType::DOUBLE) && inSet.contains(value.getDouble());
+    default:
+      return value.getType() != ValueType::STRING && value.getType() != ValueType::DOUBLE && inSet.contains(value.getNumber());
+    }
+  }
+
+  // the constant in the form of the column it is compared with: a DICT column is compared for
+  // equality by code and a string is read as a date or a timestamp once, not for every row.
+  Value convertConstant(const Value& column, const Value& constant) {
+    if (column.isCode()) {
+      if (op == TermOperand::EQUAL || op == TermOperand::NOT_EQUAL) {
+        return encodeConstant(column, constant);
+      }
+      return constant;
+    }
+    ValueType type = column.getType();
+    if ((type != ValueType::DATE && type != ValueType::TIMESTAMP) || constant.getType() != ValueType::STRING) {
+      return constant;
+    }
+    if (convertedType != type) {
+      convertedType = type;
+      if (type == ValueType::DATE) {
+        auto days = DateTime::parseDate(constant.getString());
+        convertedConstant = days ? Value::date(*days) : constant;
+      }
+      else {
+        auto microseconds = DateTime::parseTimestamp(constant.getString());
+        convertedConstant = microseconds ? Value::timestamp(*microseconds) : constant;
+      }
+    }
+    return convertedConstant;
+  }
+
+  // the constant as a code of the dictionary of the column, it is only looked up again for another
+  // dictionary, or when the constant was missing and the dictionary has grown since.
+  Value encodeConstant(const Value& column, const Value& constant) {
+    const Dictionary* dictionary = column.getDictionary();
+    bool isStale = encodedDictionary != dictionary ||
+      (encodedConstant.isCode() && encodedConstant.getCode() == Dictionary::NO_CODE && encodedDictionarySize != dictionary->size());
+    if (isStale) {
+      encodedDictionary = dictionary;
+      encodedDictionarySize = dictionary->size();
+      encodedConstant = constant.getType() == ValueType::STRING ? Value(*dictionary, dictionary->find(constant.getString())) : constant;
+    }
+    return encodedConstant;
+  }
+
+  template <typename T>
+  bool compare(const T& lhsConstant, const T& rhsConstant) const {
     switch (op) {
     case TermOperand::EQUAL:
       return lhsConstant == rhsConstant;
@@ -326,13 +1693,29 @@ public:
       return lhsConstant < rhsConstant;
     case TermOperand::LESS_EQUAL:
       return lhsConstant <= rhsConstant;
+    case TermOperand::IN:
+    case TermOperand::LIKE:
+      // matched against the list or the pattern of the term, never compared with a single value
+      return false;
     }
+    return false;
   }
 
-private:
   TermOperand op;
   std::unique_ptr<TableValue> lhs;
   std::unique_ptr<TableValue> rhs;
+  bool isLhsConstant;
+  bool isRhsConstant;
+  const Dictionary* encodedDictionary = nullptr;
+  u32 encodedDictionarySize = 0;
+  Value encodedConstant;
+  // the column type the string constant was last read as
+  std::optional<ValueType> convertedType;
+  Value convertedConstant;
+  // the constants of an IN term, and the set they are looked up in once the term is bound
+  std::vector<Constant> inList;
+  ValueSet inSet;
+  LikePattern likePattern;
 };
 
 enum class PredicateOperand {
@@ -340,6 +1723,8 @@ enum class PredicateOperand {
 };
 
 class Predicate {
+  friend class PredicateProgram;
+  friend class PredicateSimplifier;
 
 public:
   Predicate(PredicateOperand op, std::unique_ptr<Predicate>&& lhs, std::unique_ptr<Predicate>&& rhs) : op{ op }, lhs{ std::move(lhs) }, rhs{ std::move(rhs) } {}
@@ -363,6 +1748,16 @@ public:
     }
   }
 
+  void bind(Schema& schema) {
+    if (op == PredicateOperand::SINGLE) {
+      term->bind(schema);
+    }
+    else {
+      lhs->bind(schema);
+      rhs->bind(schema);
+    }
+  }
+
   bool evaluate(Tuple& tuple, Schema& schema) {
     if (op == PredicateOperand::SINGLE) {
       return term->evaluate(tuple, schema);
@@ -375,6 +1770,18 @@ public:
     }
   }
 
+  bool evaluate(TupleView& row, Schema& schema) {
+    if (op == PredicateOperand::SINGLE) {
+      return term->evaluate(row, schema);
+    }
+    else if (op == PredicateOperand::AND) {
+      return lhs->evaluate(row, schema) && rhs->evaluate(row, schema);
+    }
+    else {
+      return lhs->evaluate(row, schema) || rhs->evaluate(row, schema);
+    }
+  }
+
 private:
   PredicateOperand op;
   std::unique_ptr<Term> term;
@@ -411,6 +1818,9 @@ struct UpdateStmt {
   std::string table;
   std::vector<std::unique_ptr<Predicate>> predicate;
   std::unordered_map<std::unique_ptr<Field>, std::unique_ptr<TableValue>> setFields;
+
+  // resolve the columns that are set and check that their new values fit them.
+  void bind(Schema& schema);
 };
 
 struct DeleteStmt {
@@ -418,25 +1828,51 @@ struct DeleteStmt {
   std::vector<std::unique_ptr<Predicate>> predicate;
 };
 
+struct VacuumStmt {
+  std::string table;
+};
+
+struct TruncateStmt {
+  std::string table;
+};
+
 const std::string TABLE_NAME = "table_name";
 const std::string FIELD_NAME = "field_name";
 const std::string FIELD_TYPE = "field_type";
 const std::string ORDER = "order";
 const std::string SCHEMA_TABLE = "schema";
 
-struct Schema {
-  std::vector<std::string> tableList;
-  std::vector<std::string> fieldList;
-  std::unordered_map<std::string, std::unique_ptr<ReadField>> fieldMap;
+// how the rows of a table are laid out in its pages
+enum class PageLayout : u32 {
+  // rows are stored one after the other (NSM)
+  ROW,
+  // each page keeps the values of a column together, only for fixed width columns
+  PAX,
+};
+
+// options given to CREATE TABLE, they are kept in the heap file of the table.
+struct TableOptions {
+  // percentage of each tuple page that inserts fill, the rest is left for rows that grow
+  u32 fillFactor = 100;
+  PageLayout layout = PageLayout::ROW;
+};
 
-  Schema() {};
-  Schema(const Schema& other) : tableList{ other.tableList }, fieldList{ other.fieldList } {
+struct Schema {
+  // the schemas a statement reads and builds come from its arena, see ArenaScope::getResource
+  std::pmr::vector<std::pmr::string> tableList;
+  std::pmr::vector<std::pmr::string> fieldList;
+  std::pmr::unordered_map<std::pmr::string, std::unique_ptr<ReadField>> fieldMap;
+  TableOptions options;
+
+  Schema() : tableList{ ArenaScope::getResource() }, fieldList{ ArenaScope::getResource() }, fieldMap{ ArenaScope::getResource() } {};
+  Schema(const Schema& other) : tableList{ other.tableList, ArenaScope::getResource() }, fieldList{ other.fieldList, ArenaScope::getResource() },
+    fieldMap{ ArenaScope::getResource() }, options{ other.options } {
     for (auto& field : other.fieldMap) {
       fieldMap[field.first] = field.second->clone();
     }
   }
   Schema(Schema&& other) : tableList{ std::move(other.tableList) }, fieldList{ std::move(other.fieldList) },
-    fieldMap{ std::move(other.fieldMap) } {}
+    fieldMap{ std::move(other.fieldMap) }, options{ other.options } {}
 
   Schema& operator==(const Schema& other) {
     if (this == &other) {
@@ -444,6 +1880,7 @@ struct Schema {
     }
     tableList = other.tableList;
     fieldList = other.fieldList;
+    options = other.options;
     for (auto& field : other.fieldMap) {
       fieldMap[field.first] = field.second->clone();
     }
@@ -457,20 +1894,30 @@ struct Schema {
     tableList = std::move(other.tableList);
     fieldList = std::move(other.fieldList);
     fieldMap = std::move(other.fieldMap);
+    options = other.options;
     return *this;
   }
 
-  void addField(std::string tableName, std::string fieldName, std::unique_ptr<ReadField> field) {
-    fieldMap[fieldName] = std::move(field);
-    tableList.push_back(tableName);
-    fieldList.push_back(fieldName);
+  void addField(std::string_view tableName, std::string_view fieldName, std::unique_ptr<ReadField> field) {
+    tableList.emplace_back(tableName);
+    fieldList.emplace_back(fieldName);
+    fieldMap[fieldList.back()] = std::move(field);
   }
 
   Tuple createTuple(std::vector<Token>& token);
 
+  // readers of the columns in order, for decoding rows in place.
+  std::vector<ReadField*> getReadFields() {
+    std::vector<ReadField*> readFields;
+    for (auto& fieldName : fieldList) {
+      readFields.push_back(fieldMap.at(fieldName).get());
+    }
+    return readFields;
+  }
+
   std::vector<Tuple> createSchemaTuple() {
     std::vector<Tuple> tuples;
-    for (int i = 0; i < fieldList.size(); ++i) {
+    for (u32 i = 0; i < fieldList.size(); ++i) {
       std::vector<std::unique_ptr<WriteField>> writeFields;
       writeFields.push_back(std::make_unique<VarCharField>(tableList[i]));
       writeFields.push_back(std::make_unique<VarCharField>(fieldList[i]));
@@ -484,7 +1931,6 @@ struct Schema {
 };
 
 
-struct ResourceManager;
 std::unordered_map<std::string, Schema> getSchemaFromTableName(std::vector<std::string> tblNames, std::shared_ptr<ResourceManager> rm);
 
 // schema table
@@ -22,7 +22,7 @@ Tuple ProductScan::get()
 {
   auto lhs = leftScan->get();
   auto rhs = rightScan->get();
-  std::vector<std::unique_ptr<WriteField>> output;
+  Tuple::Fields output(ArenaScope::getResource());
   for (auto& field : lhs.fields) {
     output.push_back(std::move(field));
   }
@@ -33,6 +33,12 @@ Tuple ProductScan::get()
   return Tuple(std::move(output));
 }
 
+RID ProductScan::getRid()
+{
+  // a row of a product comes from two heap files
+  throw std::runtime_error("Product scan rows have no RID");
+}
+
 Schema& ProductScan::getSchema()
 {
   return this->schema;
@@ -65,7 +71,7 @@ Tuple ProductModifyScan::get()
 {
   auto lhs = leftScan->get();
   auto rhs = rightScan->get();
-  std::vector<std::unique_ptr<WriteField>> output;
+  Tuple::Fields output(ArenaScope::getResource());
   for (auto& field : lhs.fields) {
     output.push_back(std::move(field));
   }
@@ -76,6 +82,12 @@ Tuple ProductModifyScan::get()
   return Tuple(std::move(output));
 }
 
+RID ProductModifyScan::getRid()
+{
+  // only the left side is modified
+  return this->leftScan->getRid();
+}
+
 Schema& ProductModifyScan::getSchema()
 {
   return this->schema;
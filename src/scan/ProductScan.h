@@ -38,6 +38,8 @@ public:
 
   Tuple get() override;
 
+  RID getRid() override;
+
   Schema& getSchema() override;
 };
 
@@ -73,6 +75,8 @@ public:
 
   Tuple get() override;
 
+  RID getRid() override;
+
   Schema& getSchema() override;
 
   void update(UpdateStmt& tuple) override;
@@ -12,14 +12,20 @@ bool ProjectScan::next()
 
 Tuple ProjectScan::get()
 {
-  auto innerTuple = scan->get();
-  std::vector<std::unique_ptr<WriteField>> output;
+  // only the projected columns are decoded
+  auto innerRow = scan->getView();
+  Tuple::Fields output(ArenaScope::getResource());
   for (u32 index : mapToInnerSchema) {
-    output.push_back(std::move(innerTuple.fields[index]));
+    output.push_back(innerRow.getField(index));
   }
   return Tuple(std::move(output));
 }
 
+RID ProjectScan::getRid()
+{
+  return this->scan->getRid();
+}
+
 Schema& ProjectScan::getSchema()
 {
   return this->schema;
@@ -41,14 +47,20 @@ bool ProjectModifyScan::next()
 
 Tuple ProjectModifyScan::get()
 {
-  auto innerTuple = scan->get();
-  std::vector<std::unique_ptr<WriteField>> output;
+  // only the projected columns are decoded
+  auto innerRow = scan->getView();
+  Tuple::Fields output(ArenaScope::getResource());
   for (u32 index : mapToInnerSchema) {
-    output.push_back(std::move(innerTuple.fields[index]));
+    output.push_back(innerRow.getField(index));
   }
   return Tuple(std::move(output));
 }
 
+RID ProjectModifyScan::getRid()
+{
+  return this->scan->getRid();
+}
+
 Schema& ProjectModifyScan::getSchema()
 {
   return this->schema;
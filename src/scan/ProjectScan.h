@@ -15,21 +15,14 @@ public:
   ProjectScan(std::unique_ptr<Scan> inputScan, std::vector<std::unique_ptr<TableValue>>& fields) :
     scan{ std::move(inputScan) } {
     auto& innerSchema = this->scan->getSchema();
-    for (auto& field : fields) {
-      bool foundField = false;
-      for (u32 i = 0; i < innerSchema.fieldList.size(); ++i) {
-        std::unique_ptr<TableValue> fieldOnly = std::make_unique<Field>(innerSchema.tableList[i], innerSchema.fieldList[i]);
-        std::unique_ptr<TableValue> tableAndField = std::make_unique<Field>(innerSchema.fieldList[i], innerSchema.fieldList[i]);
-        if (*fieldOnly == field.get() || *tableAndField == field.get()) {
-          mapToInnerSchema.push_back(i);
-          schema.addField(innerSchema.tableList[i], innerSchema.fieldList[i], innerSchema.fieldMap[innerSchema.fieldList[i]]->clone());
-          foundField = true;
-          break;
-        }
-      }
-      if (!foundField) {
-        throw std::runtime_error("Field not found in inner schema");
+    for (auto& value : fields) {
+      auto field = dynamic_cast<Field*>(value.get());
+      if (!field) {
+        throw BindError("Only columns can be selected");
       }
+      u32 i = field->getIndex(innerSchema);
+      mapToInnerSchema.push_back(i);
+      schema.addField(innerSchema.tableList[i], innerSchema.fieldList[i], innerSchema.fieldMap[innerSchema.fieldList[i]]->clone());
     }
 
   }
@@ -42,6 +35,8 @@ public:
 
   Tuple get() override;
 
+  RID getRid() override;
+
   Schema& getSchema() override;
 };
 
@@ -54,21 +49,14 @@ public:
   ProjectModifyScan(std::unique_ptr<ModifyScan> inputScan, std::vector<std::unique_ptr<TableValue>>& fields) :
     scan{ std::move(inputScan) } {
     auto& innerSchema = this->scan->getSchema();
-    for (auto& field : fields) {
-      bool foundField = false;
-      for (u32 i = 0; i < innerSchema.fieldList.size(); ++i) {
-        std::unique_ptr<TableValue> fieldOnly = std::make_unique<Field>(innerSchema.tableList[i], innerSchema.fieldList[i]);
-        std::unique_ptr<TableValue> tableAndField = std::make_unique<Field>(innerSchema.fieldList[i], innerSchema.fieldList[i]);
-        if (*fieldOnly == field.get() || *tableAndField == field.get()) {
-          mapToInnerSchema.push_back(i);
-          schema.addField(innerSchema.tableList[i], innerSchema.fieldList[i], innerSchema.fieldMap[innerSchema.fieldList[i]]->clone());
-          foundField = true;
-          break;
-        }
-      }
-      if (!foundField) {
-        throw std::runtime_error("Field not found in inner schema");
+    for (auto& value : fields) {
+      auto field = dynamic_cast<Field*>(value.get());
+      if (!field) {
+        throw BindError("Only columns can be selected");
       }
+      u32 i = field->getIndex(innerSchema);
+      mapToInnerSchema.push_back(i);
+      schema.addField(innerSchema.tableList[i], innerSchema.fieldList[i], innerSchema.fieldMap[innerSchema.fieldList[i]]->clone());
     }
 
   }
@@ -81,6 +69,8 @@ public:
 
   Tuple get() override;
 
+  RID getRid() override;
+
   Schema& getSchema() override;
 
   void update(UpdateStmt& tuple) override;
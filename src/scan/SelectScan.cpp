@@ -3,14 +3,25 @@
 
 bool SelectScan::getFirst()
 {
+  // a predicate that is always false does not read the table
+  if (outcome == PredicateSimplifier::Outcome::ALWAYS_FALSE) {
+    return true;
+  }
   return this->scan->getFirst();
 }
 
 bool SelectScan::next()
 {
+  if (outcome != PredicateSimplifier::Outcome::FILTER) {
+    return outcome == PredicateSimplifier::Outcome::ALWAYS_TRUE && scan->next();
+  }
   while (scan->next()) {
-    auto tuple = scan->get();
-    if (predicate->evaluate(tuple, scan->getSchema())) {
+    // the rows of the page that are left already passed the whole predicate
+    if (usesBatches && batchFilter->isComplete() && scan->isBatchSelected()) {
+      return true;
+    }
+    auto row = scan->getView();
+    if (program->evaluate(row)) {
       return true;
     }
   }
@@ -22,6 +33,16 @@ Tuple SelectScan::get()
   return this->scan->get();
 }
 
+TupleView SelectScan::getView()
+{
+  return this->scan->getView();
+}
+
+RID SelectScan::getRid()
+{
+  return this->scan->getRid();
+}
+
 Schema& SelectScan::getSchema()
 {
   return this->scan->getSchema();
@@ -29,14 +50,21 @@ Schema& SelectScan::getSchema()
 
 bool SelectModifyScan::getFirst()
 {
+  // a predicate that is always false does not read the table
+  if (outcome == PredicateSimplifier::Outcome::ALWAYS_FALSE) {
+    return true;
+  }
   return this->scan->getFirst();
 }
 
 bool SelectModifyScan::next()
 {
+  if (outcome != PredicateSimplifier::Outcome::FILTER) {
+    return outcome == PredicateSimplifier::Outcome::ALWAYS_TRUE && scan->next();
+  }
   while (scan->next()) {
-    auto tuple = scan->get();
-    if (predicate->evaluate(tuple, scan->getSchema())) {
+    auto row = scan->getView();
+    if (program->evaluate(row)) {
       return true;
     }
   }
@@ -48,6 +76,16 @@ Tuple SelectModifyScan::get()
   return this->scan->get();
 }
 
+TupleView SelectModifyScan::getView()
+{
+  return this->scan->getView();
+}
+
+RID SelectModifyScan::getRid()
+{
+  return this->scan->getRid();
+}
+
 Schema& SelectModifyScan::getSchema()
 {
   return this->scan->getSchema();
@@ -3,16 +3,35 @@
 
 #include "../query.h"
 #include "../buffer.h"
+#include "../program.h"
+#include "../filter.h"
+#include "../simplify.h"
 #include "./scan.h"
 
 class SelectScan : public Scan {
 private:
   std::unique_ptr<Scan> scan;
   std::unique_ptr<Predicate> predicate;
+  PredicateSimplifier::Outcome outcome;
+  std::unique_ptr<PredicateProgram> program;
+  // filters PAX pages a column at a time before the rows are evaluated
+  std::unique_ptr<BatchFilter> batchFilter;
+  bool usesBatches;
 
 public:
   SelectScan(std::unique_ptr<Scan> scan, std::unique_ptr<Predicate> predicate) :
-    scan{ std::move(scan) }, predicate{ std::move(predicate) } {
+    scan{ std::move(scan) }, predicate{ std::move(predicate) }, usesBatches{ false } {
+    // the columns of the predicate are found once, rows are evaluated by the compiled program
+    this->predicate->bind(this->scan->getSchema());
+    outcome = PredicateSimplifier(this->scan->getSchema()).simplify(this->predicate);
+    if (outcome != PredicateSimplifier::Outcome::FILTER) {
+      return;
+    }
+    program = std::make_unique<PredicateProgram>(*this->predicate, this->scan->getSchema());
+    batchFilter = std::make_unique<BatchFilter>(*program);
+    if (!batchFilter->isEmpty()) {
+      usesBatches = this->scan->setBatchFilter(batchFilter.get());
+    }
   }
 
   ~SelectScan() = default;
@@ -23,6 +42,10 @@ public:
 
   Tuple get() override;
 
+  TupleView getView() override;
+
+  RID getRid() override;
+
   Schema& getSchema() override;
 };
 
@@ -30,10 +53,18 @@ class SelectModifyScan : public ModifyScan {
 private:
   std::unique_ptr<ModifyScan> scan;
   std::unique_ptr<Predicate> predicate;
+  PredicateSimplifier::Outcome outcome;
+  std::unique_ptr<PredicateProgram> program;
 
 public:
   SelectModifyScan(std::unique_ptr<ModifyScan> scan, std::unique_ptr<Predicate> predicate) :
     scan{ std::move(scan) }, predicate{ std::move(predicate) } {
+    // the columns of the predicate are found once, rows are evaluated by the compiled program
+    this->predicate->bind(this->scan->getSchema());
+    outcome = PredicateSimplifier(this->scan->getSchema()).simplify(this->predicate);
+    if (outcome == PredicateSimplifier::Outcome::FILTER) {
+      program = std::make_unique<PredicateProgram>(*this->predicate, this->scan->getSchema());
+    }
   }
 
   ~SelectModifyScan() = default;
@@ -44,6 +75,10 @@ public:
 
   Tuple get() override;
 
+  TupleView getView() override;
+
+  RID getRid() override;
+
   Schema& getSchema() override;
 
   void update(UpdateStmt& tuple) override;
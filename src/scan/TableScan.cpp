@@ -16,8 +16,9 @@ bool TableScan::findNextPage() {
     if (!this->currBuffer) break;
 
     this->currentSlot = -1;
+    this->isPageSelected = false;
     PageType* pt = (PageType*)currBuffer->bufferData.data();
-    if (*pt == PageType::TuplePage) {
+    if (*pt == PageType::TuplePage || *pt == PageType::PaxPage) {
       return true;
     }
     else {
@@ -34,6 +35,8 @@ bool TableScan::getFirst() {
     rm->bm.unpin(rm->fm, currentPageId);
   }
   currentPageId = PageId{ currentPageId.filename, 0 };
+  currentSlot = -1;
+  isPageSelected = false;
   currBuffer = rm->bm.pin(rm->fm, currentPageId);
   return true;
 }
@@ -44,6 +47,28 @@ bool TableScan::next() {
   }
   while (true) {
     TuplePage* pe = reinterpret_cast<TuplePage*>(currBuffer->bufferData.data());
+    if (pe->pageType == PageType::PaxPage) {
+      PaxPage* pp = reinterpret_cast<PaxPage*>(currBuffer->bufferData.data());
+      u32 nextRow;
+      if (batchFilter) {
+        if (!isPageSelected) {
+          batchFilter->select(pp, selection);
+          isPageSelected = true;
+        }
+        nextRow = nextSelectedRow(currentSlot + 1, pp->rowCapacity);
+      }
+      else {
+        nextRow = pp->nextOccupiedRow(currentSlot + 1);
+      }
+      if (nextRow < pp->rowCapacity) {
+        currentSlot = nextRow;
+        return true;
+      }
+      if (!findNextPage()) {
+        return false;
+      }
+      continue;
+    }
     if (pe->pageType != PageType::TuplePage) {
       bool foundNextPage = findNextPage();
       if (!foundNextPage) {
@@ -54,11 +79,9 @@ bool TableScan::next() {
       }
     }
     u32 numberOfSlots = pe->numberOfSlots;
-
-    Slot* slot = reinterpret_cast<Slot*>(currBuffer->bufferData.data() + sizeof(TuplePage));
-    i32 nextSlot = currentSlot + 1;
-    while (nextSlot < numberOfSlots && !slot[nextSlot].isOccupied()) {
-      nextSlot += 1;
+    u32 nextSlot = pe->nextOccupiedSlot(currentSlot + 1);
+    while (nextSlot < numberOfSlots && pe->slots()[nextSlot].isRelocated()) {
+      nextSlot = pe->nextOccupiedSlot(nextSlot + 1);
     }
 
     if (nextSlot < numberOfSlots) {
@@ -77,18 +100,24 @@ bool TableScan::next() {
 }
 
 Tuple TableScan::get() {
-  Slot* slot = reinterpret_cast<Slot*>(currBuffer->bufferData.data() + sizeof(TuplePage));
-
-  std::vector<std::unique_ptr<WriteField>> output;
-  u32 offset = slot[currentSlot].getOffset();
-  for (int i = 0; i < schema.fieldList.size(); ++i) {
-    auto wf = schema.fieldMap[schema.fieldList[i]]->get(currBuffer->bufferData.data(), offset);
-    offset += wf->getLength();
-    output.push_back(std::move(wf));
+  if (codec) {
+    TuplePage* tp = reinterpret_cast<TuplePage*>(currBuffer->bufferData.data());
+    if (tp->pageType == PageType::TuplePage && tp->rowFormat == TuplePage::ROW_FORMAT) {
+      Slot& slot = tp->slots()[currentSlot];
+      if (!slot.isForwarded()) {
+        return codec->decode(currBuffer->bufferData.data() + slot.getOffset());
+      }
+    }
   }
+  return HeapFile::readTuple(rm, schema, source, currBuffer, currentSlot);
+}
 
-  Tuple tuple(std::move(output));
-  return tuple;
+TupleView TableScan::getView() {
+  return HeapFile::viewTuple(rm, schema, readFields, source, currBuffer, currentSlot);
+}
+
+RID TableScan::getRid() {
+  return RID{ currentPageId.pageNumber, (u32)currentSlot };
 }
 
 Schema& TableScan::getSchema()
@@ -96,6 +125,36 @@ Schema& TableScan::getSchema()
   return this->schema;
 }
 
+bool TableScan::setBatchFilter(BatchFilter* filter)
+{
+  batchFilter = filter;
+  isPageSelected = false;
+  return true;
+}
+
+bool TableScan::isBatchSelected()
+{
+  return batchFilter && currBuffer && reinterpret_cast<PaxPage*>(currBuffer->bufferData.data())->pageType == PageType::PaxPage;
+}
+
+// first selected row at or after row, rowCapacity if there is none.
+u32 TableScan::nextSelectedRow(u32 row, u32 rowCapacity)
+{
+  u32 wordIdx = row / 64;
+  if (wordIdx >= selection.size()) {
+    return rowCapacity;
+  }
+  u64 word = selection[wordIdx] & (~u64(0) << (row % 64));
+  while (word == 0) {
+    wordIdx += 1;
+    if (wordIdx >= selection.size()) {
+      return rowCapacity;
+    }
+    word = selection[wordIdx];
+  }
+  return wordIdx * 64 + std::countr_zero(word);
+}
+
 /*
 * ModifyTableScan Implementation
 */
@@ -110,11 +169,17 @@ bool ModifyTableScan::next()
   bool hasPageBuffer = this->iter.getPageBuffer() != nullptr;
   bool nextSlotIsInSamePageBuffer = false;
   u32 nextSlot = this->currentSlot + 1;
-  if (hasPageBuffer) {
+  if (hasPageBuffer && reinterpret_cast<PaxPage*>(this->iter.getPageBuffer()->bufferData.data())->pageType == PageType::PaxPage) {
+    PaxPage* pp = reinterpret_cast<PaxPage*>(this->iter.getPageBuffer()->bufferData.data());
+    nextSlot = pp->nextOccupiedRow(nextSlot);
+    this->currentSlot = nextSlot;
+    nextSlotIsInSamePageBuffer = nextSlot < pp->rowCapacity;
+  }
+  else if (hasPageBuffer) {
     TuplePage* pe = reinterpret_cast<TuplePage*>(this->iter.getPageBuffer()->bufferData.data());
-    Slot* slot = reinterpret_cast<Slot*>(this->iter.getPageBuffer()->bufferData.data() + sizeof(TuplePage));
-    while (nextSlot < pe->numberOfSlots && !slot[nextSlot].isOccupied()) {
-      nextSlot += 1;
+    nextSlot = pe->nextOccupiedSlot(nextSlot);
+    while (nextSlot < pe->numberOfSlots && pe->slots()[nextSlot].isRelocated()) {
+      nextSlot = pe->nextOccupiedSlot(nextSlot + 1);
     }
     this->currentSlot = nextSlot;
     nextSlotIsInSamePageBuffer = nextSlot < pe->numberOfSlots;
@@ -148,19 +213,12 @@ bool ModifyTableScan::next()
 
 Tuple ModifyTableScan::get()
 {
-  auto buffer = this->iter.getPageBuffer();
-  Slot* slot = reinterpret_cast<Slot*>(buffer->bufferData.data() + sizeof(TuplePage));
-
-  std::vector<std::unique_ptr<WriteField>> output;
-  u32 offset = slot[currentSlot].getOffset();
-  for (int i = 0; i < schema.fieldList.size(); ++i) {
-    auto wf = schema.fieldMap[schema.fieldList[i]]->get(buffer->bufferData.data(), offset);
-    offset += wf->getLength();
-    output.push_back(std::move(wf));
-  }
+  return HeapFile::readTuple(rm, schema, source, this->iter.getPageBuffer(), currentSlot);
+}
 
-  Tuple tuple(std::move(output));
-  return tuple;
+TupleView ModifyTableScan::getView()
+{
+  return HeapFile::viewTuple(rm, schema, readFields, source, this->iter.getPageBuffer(), currentSlot);
 }
 
 // so fucking cooked.
@@ -169,34 +227,17 @@ Schema& ModifyTableScan::getSchema()
   return this->schema;
 }
 
-bool ModifyTableScan::deleteTuple() // delete tuple at current position
+RID ModifyTableScan::getRid()
 {
-  auto buffer = this->iter.getPageBuffer();
-  if (!buffer) {
-    return false;
-  }
+  return RID{ this->iter.getPageBuffer()->pageId.pageNumber, (u32)currentSlot };
+}
 
-  // Increase page entry free space size
-  BufferFrame* directoryFrame = iter.getPageDirBuffer();
-  PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(directoryFrame->bufferData.data() + sizeof(PageDirectory));
-  pageEntryList[iter.getPageEntryIndex()].freeSpace += this->get().recordSize;
-  directoryFrame->dirty = true;
-
-  // modify the page 
-  auto pageBuffer = this->iter.getPageBuffer();
-  TuplePage* pe = reinterpret_cast<TuplePage*>(pageBuffer->bufferData.data());
-  Slot* slot = reinterpret_cast<Slot*>(buffer->bufferData.data() + sizeof(TuplePage));
-  if (currentSlot >= pe->numberOfSlots) {
-    return false;
-  }
-  if (!slot[currentSlot].isOccupied()) {
+bool ModifyTableScan::deleteTuple() // delete tuple at current position
+{
+  if (!this->iter.getPageBuffer()) {
     return false;
   }
-
-  slot[currentSlot].setOccupied(false);
-  // reduce the size of the page entry. this->iter.getPageDirBuffer();
-  pageBuffer->dirty = true;
-  return true;
+  return HeapFile::eraseTuple(this->iter, this->getSchema(), currentSlot);
 }
 
 /*
@@ -206,57 +247,17 @@ void ModifyTableScan::update(UpdateStmt& updateData)
 {
   Schema& schema = this->getSchema();
   auto oldTuple = this->get();
-  u32 oldRecordSize = oldTuple.recordSize;
-
-  std::vector<Field> tableFieldList;
-  std::vector<Field> fieldList;
-  for (int i = 0; i < schema.fieldList.size(); ++i) {
-    tableFieldList.push_back(Field(schema.tableList[i], schema.fieldList[i]));
-    fieldList.push_back(Field(schema.fieldList[i]));
-  }
 
   for (auto& [k, v] : updateData.setFields) {
     Constant newValue = v->getConstant(oldTuple, schema);
-
-    // convert the constant into writeField
-    for (u32 i = 0; i < fieldList.size(); ++i) {
-      if (fieldList[i] == k.get() || tableFieldList[i] == k.get()) {
-        // HACK: this is a hack, we should not be using so much indirection but i'm fucking lazy.
-
-        oldTuple.set(i, schema.fieldMap.at(schema.fieldList[i])->get(newValue));
-      }
+    u32 i = k->getIndex(schema);
+    ReadField* column = schema.fieldMap.at(schema.fieldList[i]).get();
+    auto newField = column->get(newValue);
+    if (!newField) {
+      throw BindError("Cannot assign " + constantTypeName(newValue.constantType) + " to " + k->getName() + " " + column->serializeType());
     }
+    oldTuple.set(i, std::move(newField));
   }
 
-  auto pageBuffer = this->iter.getPageBuffer();
-  Slot* slot = reinterpret_cast<Slot*>(pageBuffer->bufferData.data() + sizeof(TuplePage));
-  u32 currSlotIdx = this->currentSlot;
-  if (oldRecordSize < oldTuple.recordSize) {
-    // if no more space left set to empty, write to next spot
-    slot[currSlotIdx].setOccupied(false);
-    pageBuffer->dirty = true;
-
-    // decrease page entry free space in current directory.
-    BufferFrame* directoryFrame = iter.getPageDirBuffer();
-    PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(directoryFrame->bufferData.data() + sizeof(PageDirectory));
-    pageEntryList[iter.getPageEntryIndex()].freeSpace += this->get().recordSize;
-    directoryFrame->dirty = true;
-
-    // Insert again
-    std::vector<Tuple> insertTuples;
-    insertTuples.emplace_back(std::move(oldTuple));
-    HeapFile::insertTuples(this->pushIter, insertTuples);
-
-  }
-  else {
-    // if has space, update the current spot.
-    u32 offset = slot[currSlotIdx].getOffset();
-    for (auto& field : oldTuple.fields) {
-      field->write(this->iter.getPageBuffer()->bufferData.data(), offset);
-      offset += field->getLength();
-    }
-    pageBuffer->dirty = true;
-  }
-
+  HeapFile::updateTuple(this->iter, this->pushIter, schema, currentSlot, oldTuple);
 }
-
@@ -2,6 +2,8 @@
 
 #include "../query.h"
 #include "../buffer.h"
+#include "../filter.h"
+#include "../codec.h"
 #include "./scan.h"
 
 class TableScan : public Scan {
@@ -12,13 +14,25 @@ private:
   BufferFrame* currBuffer;
   std::string filename;
   Schema schema;
+  std::shared_ptr<HeapFileSource> source;
+  std::vector<ReadField*> readFields;
+  // decodes rows of fixed width schemas, nullptr for other schemas
+  std::unique_ptr<RowCodec> codec;
+  // rows of PAX pages are selected by the filter a page at a time
+  BatchFilter* batchFilter;
+  std::vector<u64> selection;
+  bool isPageSelected;
 
   bool findNextPage();
 
+  u32 nextSelectedRow(u32 row, u32 rowCapacity);
+
 public:
   TableScan(std::string filename, std::shared_ptr<ResourceManager> rm, Schema schema) :
     currentPageId{ PageId{ filename, 0 } }, currentSlot{ -1 },
-    rm{ rm }, currBuffer{ nullptr }, filename{ filename }, schema{ schema } {
+    rm{ rm }, currBuffer{ nullptr }, filename{ filename }, schema{ schema },
+    source{ std::make_shared<HeapFileSource>(HeapFileSource{ rm, filename }) }, readFields{ this->schema.getReadFields() },
+    codec{ RowCodec::create(this->schema) }, batchFilter{ nullptr }, isPageSelected{ false } {
   }
   ~TableScan() = default;
 
@@ -28,7 +42,15 @@ public:
 
   Tuple get() override;
 
+  TupleView getView() override;
+
+  RID getRid() override;
+
   Schema& getSchema() override;
+
+  bool setBatchFilter(BatchFilter* filter) override;
+
+  bool isBatchSelected() override;
 };
 
 // update opens 4 buffers
@@ -41,11 +63,14 @@ protected:
   HeapFile::HeapFileIterator iter;
   HeapFile::HeapFileIterator pushIter;
   i32 currentSlot;
+  std::shared_ptr<HeapFileSource> source;
+  std::vector<ReadField*> readFields;
 
 public:
   ModifyTableScan(std::string filenameInput, std::shared_ptr<ResourceManager> rmInput, Schema schemaInput) :
     rm{ rmInput }, filename{ filenameInput }, schema{ schemaInput }, iter{ HeapFile::HeapFileIterator(filename, rm) },
-    pushIter{ filenameInput , rmInput }, currentSlot{ -1 } {
+    pushIter{ filenameInput , rmInput }, currentSlot{ -1 },
+    source{ std::make_shared<HeapFileSource>(HeapFileSource{ rmInput, filenameInput }) }, readFields{ schema.getReadFields() } {
 
   }
 
@@ -57,6 +82,10 @@ public:
 
   Tuple get() override;
 
+  TupleView getView() override;
+
+  RID getRid() override;
+
   Schema& getSchema() override;
 
   void update(UpdateStmt& tuple) override;
@@ -3,13 +3,30 @@
 #include "../query.h"
 #include "../buffer.h"
 
+class BatchFilter;
+
 class Scan {
 public:
   virtual ~Scan() {};
   virtual bool getFirst() = 0;
   virtual bool next() = 0;
   virtual Tuple get() = 0;
+  // the current row, read in place where the scan can. it is valid until the scan moves on.
+  virtual TupleView getView() {
+    return TupleView(get());
+  }
+  // RID of the current row in its heap file.
+  virtual RID getRid() = 0;
   virtual Schema& getSchema() = 0;
+  // skip the rows the filter rejects a page at a time, false if the scan does not read its rows in batches.
+  // the filter must outlive the scan.
+  virtual bool setBatchFilter(BatchFilter*) {
+    return false;
+  }
+  // whether the current row was selected by the batch filter
+  virtual bool isBatchSelected() {
+    return false;
+  }
 };
 
 class ModifyScan : public Scan {
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "query.h"
+
+/**
+A rewrite of a bound predicate before any row is read.
+
+Terms that only compare constants are folded to true or false, a true term is dropped from an
+AND and a false one from an OR, and a node that one of its children decides is decided. Nested
+ANDs, and nested ORs, become one node where a child that appears twice is kept once.
+
+The terms of an AND that compare the same column with a constant are merged: only the
+tightest lower and upper bounds are kept, an equality replaces the bounds it satisfies, and
+bounds that no value satisfies, such as a > 10 AND a < 5 or a = 1 AND a = 2, make the whole
+AND false. A scan whose predicate is always false reads no rows at all.
+*/
+class PredicateSimplifier {
+public:
+  enum class Outcome {
+    ALWAYS_TRUE, ALWAYS_FALSE,
+    // the predicate depends on the row
+    FILTER,
+  };
+
+  // the schema the predicate is bound to
+  PredicateSimplifier(Schema& schema) : schema{ &schema } {}
+
+  // the predicate is rewritten when it depends on the row. it is only simplified in parts when it
+  // does not, there is no need to evaluate it then.
+  Outcome simplify(std::unique_ptr<Predicate>& predicate) {
+    if (predicate->op == PredicateOperand::SINGLE) {
+      return fold(*predicate->term);
+    }
+
+    PredicateOperand op = predicate->op;
+    bool isAnd = op == PredicateOperand::AND;
+    std::vector<std::unique_ptr<Predicate>*> children;
+    flatten(predicate, op, children);
+
+    std::vector<std::unique_ptr<Predicate>*> kept;
+    for (auto child : children) {
+      Outcome outcome = simplify(*child);
+      if (outcome == (isAnd ? Outcome::ALWAYS_FALSE : Outcome::ALWAYS_TRUE)) {
+        return outcome;
+      }
+      bool isDuplicate = std::any_of(kept.begin(), kept.end(), [&](auto other) { return **other == **child; });
+      if (outcome == Outcome::FILTER && !isDuplicate) {
+        kept.push_back(child);
+      }
+    }
+    if (isAnd && !mergeRanges(kept)) {
+      return Outcome::ALWAYS_FALSE;
+    }
+    if (kept.empty()) {
+      return isAnd ? Outcome::ALWAYS_TRUE : Outcome::ALWAYS_FALSE;
+    }
+
+    // the children are moved out before the node that owns them is replaced
+    std::unique_ptr<Predicate> simplified = std::move(*kept[0]);
+    for (u32 i = 1; i < kept.size(); ++i) {
+      simplified = std::make_unique<Predicate>(op, std::move(simplified), std::move(*kept[i]));
+    }
+    predicate = std::move(simplified);
+    return Outcome::FILTER;
+  }
+
+private:
+  // the bounds an AND puts on one column, the term each of them comes from
+  struct Bounds {
+    std::unique_ptr<Predicate>* lower = nullptr;
+    std::unique_ptr<Predicate>* upper = nullptr;
+    std::unique_ptr<Predicate>* equal = nullptr;
+    Constant lowerValue{ 0 };
+    Constant upperValue{ 0 };
+    Constant equalValue{ 0 };
+    bool isLowerInclusive = false;
+    bool isUpperInclusive = false;
+    std::vector<std::pair<std::unique_ptr<Predicate>*, Constant>> notEqual;
+  };
+
+  Schema* schema;
+
+  // the children of the nodes with the operator below node, node itself if it has another one
+  static void flatten(std::unique_ptr<Predicate>& node, PredicateOperand op, std::vector<std::unique_ptr<Predicate>*>& children) {
+    if (node->op != op) {
+      children.push_back(&node);
+      return;
+    }
+    flatten(node->lhs, op, children);
+    flatten(node->rhs, op, children);
+  }
+
+  // a term of constants is true or false for every row
+  Outcome fold(Term& term) {
+    if (!term.isLhsConstant || (!term.isRhsConstant && term.op != TermOperand::IN)) {
+      return Outcome::FILTER;
+    }
+    Tuple noRow(std::vector<std::unique_ptr<WriteField>>{});
+    return term.evaluate(noRow, *schema) ? Outcome::ALWAYS_TRUE : Outcome::ALWAYS_FALSE;
+  }
+
+  // keep only the tightest bounds of every column among the terms of an AND, false if no row satisfies them
+  bool mergeRanges(std::vector<std::unique_ptr<Predicate>*>& terms) {
+    std::map<u32, Bounds> columns;
+    std::vector<std::unique_ptr<Predicate>*> dropped;
+    for (auto node : terms) {
+      Predicate& predicate = **node;
+      if (predicate.op != PredicateOperand::SINGLE) {
+        continue;
+      }
+      Term& term = *predicate.term;
+      if (term.op == TermOperand::IN || term.op == TermOperand::LIKE || term.isLhsConstant == term.isRhsConstant) {
+        continue;
+      }
+      auto field = dynamic_cast<Field*>(term.isLhsConstant ? term.rhs.get() : term.lhs.get());
+      if (!field) {
+        continue;
+      }
+      u32 column = field->getIndex(*schema);
+      ConstantType columnType = schema->fieldMap.at(schema->fieldList[column])->getConstantType();
+      Constant value = asColumnType(*static_cast<Constant*>(term.isLhsConstant ? term.lhs.get() : term.rhs.get()), columnType);
+      TermOperand op = term.isLhsConstant ? flip(term.op) : term.op;
+      Bounds& bounds = columns[column];
+
+      switch (op) {
+      case TermOperand::EQUAL:
+        if (bounds.equal) {
+          if (value != bounds.equalValue) {
+            return false;
+          }
+          dropped.push_back(node);
+        }
+        else {
+          bounds.equal = node;
+          bounds.equalValue = value;
+        }
+        break;
+      case TermOperand::NOT_EQUAL:
+        if (std::any_of(bounds.notEqual.begin(), bounds.notEqual.end(), [&](auto& other) { return other.second == value; })) {
+          dropped.push_back(node);
+        }
+        else {
+          bounds.notEqual.push_back({ node, value });
+        }
+        break;
+      case TermOperand::GREATER:
+      case TermOperand::GREATER_EQUAL: {
+        bool isInclusive = op == TermOperand::GREATER_EQUAL;
+        // a > 5 is tighter than a >= 5
+        if (!bounds.lower || value > bounds.lowerValue || (value == bounds.lowerValue && !isInclusive)) {
+          if (bounds.lower) {
+            dropped.push_back(bounds.lower);
+          }
+          bounds.lower = node;
+          bounds.lowerValue = value;
+          bounds.isLowerInclusive = isInclusive;
+        }
+        else {
+          dropped.push_back(node);
+        }
+        break;
+      }
+      default: {
+        bool isInclusive = op == TermOperand::LESS_EQUAL;
+        if (!bounds.upper || value < bounds.upperValue || (value == bounds.upperValue && !isInclusive)) {
+          if (bounds.upper) {
+            dropped.push_back(bounds.upper);
+          }
+          bounds.upper = node;
+          bounds.upperValue = value;
+          bounds.isUpperInclusive = isInclusive;
+        }
+        else {
+          dropped.push_back(node);
+        }
+        break;
+      }
+      }
+    }
+
+    for (auto& [column, bounds] : columns) {
+      if (bounds.lower && bounds.upper && (bounds.lowerValue > bounds.upperValue ||
+        (bounds.lowerValue == bounds.upperValue && !(bounds.isLowerInclusive && bounds.isUpperInclusive)))) {
+        return false;
+      }
+      if (!bounds.equal) {
+        continue;
+      }
+      // the equality is the only term left on the column if it satisfies the others
+      if (bounds.lower && (bounds.isLowerInclusive ? bounds.equalValue < bounds.lowerValue : bounds.equalValue <= bounds.lowerValue)) {
+        return false;
+      }
+      if (bounds.upper && (bounds.isUpperInclusive ? bounds.equalValue > bounds.upperValue : bounds.equalValue >= bounds.upperValue)) {
+        return false;
+      }
+      for (auto& [node, value] : bounds.notEqual) {
+        if (value == bounds.equalValue) {
+          return false;
+        }
+        dropped.push_back(node);
+      }
+      for (auto node : { bounds.lower, bounds.upper }) {
+        if (node) {
+          dropped.push_back(node);
+        }
+      }
+    }
+
+    std::erase_if(terms, [&](auto node) { return std::find(dropped.begin(), dropped.end(), node) != dropped.end(); });
+    return true;
+  }
+
+  // the constant as a value of the column, a string compared with a date or a timestamp is read as one
+  static Constant asColumnType(const Constant& constant, ConstantType columnType) {
+    if (constant.constantType == ConstantType::STRING && columnType == ConstantType::DATE) {
+      return Constant::date(*DateTime::parseDate(constant.str));
+    }
+    if (constant.constantType == ConstantType::STRING && columnType == ConstantType::TIMESTAMP) {
+      return Constant::timestamp(*DateTime::parseTimestamp(constant.str));
+    }
+    return constant;
+  }
+
+  // the operator with its sides swapped, 5 < a is a > 5
+  static TermOperand flip(TermOperand op) {
+    switch (op) {
+    case TermOperand::GREATER:
+      return TermOperand::LESS;
+    case TermOperand::GREATER_EQUAL:
+      return TermOperand::LESS_EQUAL;
+    case TermOperand::LESS:
+      return TermOperand::GREATER;
+    case TermOperand::LESS_EQUAL:
+      return TermOperand::GREATER_EQUAL;
+    default:
+      return op;
+    }
+  }
+};
@@ -0,0 +1,633 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <memory>
+
+#include "../src/scan/scan.h"
+#include "../src/scan/SelectScan.h"
+#include "../src/scan/ProductScan.h"
+#include "../src/scan/TableScan.h"
+#include "./test_utils.h"
+
+// benchmarks are hidden, run them with ./testsql [benchmark]
+
+static std::vector<Tuple> createBenchmarkTuples(Schema& schema, int numberOfTuples) {
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < numberOfTuples; ++i) {
+    std::vector<Token> tokens{ ttoken("citizen" + std::to_string(i)), ttoken("Engineer"), ttoken(i % 100) };
+    tuples.push_back(schema.createTuple(tokens));
+  }
+  return tuples;
+}
+
+static double rowsPerSecond(int numberOfTuples, std::chrono::steady_clock::time_point start) {
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return numberOfTuples / elapsed.count();
+}
+
+TEST_CASE("Benchmark insertTuples against bulkLoad", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+  schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+  schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+    auto tuples = createBenchmarkTuples(schema, numberOfTuples);
+
+    auto start = std::chrono::steady_clock::now();
+    HeapFile::insertTuples(rm, fileName, tuples);
+    std::cout << "insertTuples: " << rowsPerSecond(numberOfTuples, start) << " rows/sec\n";
+  }
+  std::filesystem::remove(fileName);
+
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+    auto tuples = createBenchmarkTuples(schema, numberOfTuples);
+
+    auto start = std::chrono::steady_clock::now();
+    HeapFile::bulkLoad(rm, fileName, tuples);
+    std::cout << "bulkLoad: " << rowsPerSecond(numberOfTuples, start) << " rows/sec\n";
+
+    u32 numberOfRows = 0;
+    TableScan scan(fileName, rm, schema);
+    scan.getFirst();
+    while (scan.next()) {
+      numberOfRows++;
+    }
+    REQUIRE(numberOfRows == numberOfTuples);
+  }
+}
+
+TEST_CASE("Benchmark single row inserts with and without the insert hint", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+  const int numberOfInserts = 2000;
+
+  Schema schema;
+  schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+  schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+  schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+  // fill through the normal insert path so every page directory is full
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 10);
+  HeapFile::createHeapFile(*rm, fileName);
+  auto tuples = createBenchmarkTuples(schema, numberOfTuples);
+  HeapFile::insertTuples(rm, fileName, tuples);
+
+  for (bool useHint : { false, true }) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numberOfInserts; ++i) {
+      if (!useHint) {
+        rm->invalidateInsertHint(fileName);
+      }
+      auto row = createBenchmarkTuples(schema, 1);
+      HeapFile::insertTuples(rm, fileName, row);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (useHint ? "with" : "without") << " insert hint: " << elapsed.count() / numberOfInserts << " us/insert\n";
+  }
+}
+
+TEST_CASE("Benchmark filtering materialized rows against tuple views", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+  schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+  schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 10);
+  HeapFile::createHeapFile(*rm, fileName);
+  auto tuples = createBenchmarkTuples(schema, numberOfTuples);
+  HeapFile::bulkLoad(rm, fileName, tuples);
+
+  // WHERE age = 42, one row in a hundred
+  Predicate predicate(std::make_unique<Term>(TermOperand::EQUAL, std::make_unique<Field>(fileName, "age"), std::make_unique<Constant>(42)));
+
+  for (bool useView : { false, true }) {
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    TableScan scan(fileName, rm, schema);
+    scan.getFirst();
+    while (scan.next()) {
+      if (useView) {
+        auto row = scan.getView();
+        numberOfRows += predicate.evaluate(row, schema);
+      }
+      else {
+        auto tuple = scan.get();
+        numberOfRows += predicate.evaluate(tuple, schema);
+      }
+    }
+    std::cout << (useView ? "tuple view" : "materialized") << " filter: " << rowsPerSecond(numberOfTuples, start) << " rows/sec\n";
+    REQUIRE(numberOfRows == numberOfTuples / 100);
+  }
+}
+
+TEST_CASE("Benchmark decoding fixed width rows with and without the row codec", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+  schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 10);
+  HeapFile::createHeapFile(*rm, fileName);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < numberOfTuples; ++i) {
+    std::vector<Token> tokens{ ttoken(i), ttoken("Engineer"), ttoken(i % 100) };
+    tuples.push_back(schema.createTuple(tokens));
+  }
+  auto codec = RowCodec::create(schema);
+  HeapFile::insertTuples(rm, fileName, tuples, codec.get());
+
+  auto readFields = schema.getReadFields();
+  std::shared_ptr<HeapFileSource> source = std::make_shared<HeapFileSource>(HeapFileSource{ rm, fileName });
+  // the codec decodes every row into the fields of this tuple
+  Tuple decoded = codec->makeTuple();
+  for (bool useCodec : { false, true }) {
+    u64 sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    HeapFile::HeapFileIterator iter(fileName, rm);
+    iter.findFirstDir();
+    do {
+      while (iter.nextPageInDir()) {
+        BufferFrame* frame = iter.getPageBuffer();
+        TuplePage* tp = reinterpret_cast<TuplePage*>(frame->bufferData.data());
+        for (u32 i = tp->nextOccupiedSlot(0); i < tp->numberOfSlots; i = tp->nextOccupiedSlot(i + 1)) {
+          if (useCodec) {
+            codec->decode(frame->bufferData.data() + tp->slots()[i].getOffset(), decoded);
+            sum += decoded.fields[2]->getConstant().num;
+          }
+          else {
+            Tuple tuple = HeapFile::readTuple(rm, schema, source, frame, i);
+            sum += tuple.fields[2]->getConstant().num;
+          }
+        }
+      }
+    } while (iter.nextDir());
+    std::cout << (useCodec ? "row codec" : "generic") << " decode: " << rowsPerSecond(numberOfTuples, start) << " rows/sec\n";
+    REQUIRE(sum == u64(numberOfTuples / 100) * 4950);
+  }
+}
+
+TEST_CASE("Benchmark scans and joins with and without the query arena", "[.][benchmark]") {
+  std::string employeeFile = "benchmark";
+  std::string jobFile = "benchmark_job";
+  DeferDeleteFile deferDeleteFile({ employeeFile, jobFile });
+  const int numberOfEmployees = 2000;
+  const int numberOfJobs = 100;
+
+  Schema employeeSchema;
+  employeeSchema.addField(employeeFile, "name", std::make_unique<ReadVarCharField>());
+  employeeSchema.addField(employeeFile, "employment", std::make_unique<ReadFixedCharField>(20));
+  employeeSchema.addField(employeeFile, "age", std::make_unique<ReadIntField>());
+  Schema jobSchema;
+  jobSchema.addField(jobFile, "title", std::make_unique<ReadVarCharField>());
+  jobSchema.addField(jobFile, "minimum_age", std::make_unique<ReadIntField>());
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+  HeapFile::createHeapFile(*rm, employeeFile);
+  HeapFile::createHeapFile(*rm, jobFile);
+  auto employees = createBenchmarkTuples(employeeSchema, numberOfEmployees);
+  HeapFile::bulkLoad(rm, employeeFile, employees);
+  std::vector<Tuple> jobs;
+  for (int i = 0; i < numberOfJobs; ++i) {
+    std::vector<Token> tokens{ ttoken("job title number " + std::to_string(i)), ttoken(i) };
+    jobs.push_back(jobSchema.createTuple(tokens));
+  }
+  HeapFile::bulkLoad(rm, jobFile, jobs);
+
+  // read every row the same way the executor drives a statement, the scans, schemas and rows of the
+  // statement come from the arena, which is released once the statement is done
+  auto run = [&](auto makeScan, bool useArena) {
+    QueryArena arena;
+    u32 numberOfRows = 0;
+    {
+      std::optional<ArenaScope> arenaScope;
+      if (useArena) {
+        arenaScope.emplace(arena);
+      }
+      std::unique_ptr<Scan> scan = makeScan();
+      scan->getFirst();
+      while (scan->next()) {
+        auto tuple = scan->get();
+        numberOfRows++;
+      }
+    }
+    arena.release();
+    return numberOfRows;
+  };
+
+  for (bool useArena : { false, true }) {
+    const int repeats = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) {
+      auto makeScan = [&]() { return std::make_unique<TableScan>(employeeFile, rm, employeeSchema); };
+      REQUIRE(run(makeScan, useArena) == numberOfEmployees);
+    }
+    std::cout << (useArena ? "with" : "without") << " arena scan: " << rowsPerSecond(numberOfEmployees * repeats, start) << " rows/sec\n";
+
+    // the join predicate is evaluated on every combination of rows
+    start = std::chrono::steady_clock::now();
+    auto makeJoin = [&]() {
+      auto product = std::make_unique<ProductScan>(std::make_unique<TableScan>(employeeFile, rm, employeeSchema),
+        std::make_unique<TableScan>(jobFile, rm, jobSchema));
+      auto predicate = std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::EQUAL,
+        std::make_unique<Field>(employeeFile, "age"), std::make_unique<Field>(jobFile, "minimum_age")));
+      return std::make_unique<SelectScan>(std::move(product), std::move(predicate));
+    };
+    REQUIRE(run(makeJoin, useArena) == numberOfEmployees);
+    std::cout << (useArena ? "with" : "without") << " arena join: " << rowsPerSecond(numberOfEmployees * numberOfJobs, start) << " combinations/sec\n";
+  }
+}
+
+TEST_CASE("Benchmark string predicates on tuple views", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+  schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+  schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+  HeapFile::createHeapFile(*rm, fileName);
+  // strings longer than the short string buffer of std::string
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < numberOfTuples; ++i) {
+    std::vector<Token> tokens{ ttoken("citizen_with_a_long_name_" + std::to_string(i)), ttoken(i % 2 ? "Software Engineer" : "Software Architect"), ttoken(i % 100) };
+    tuples.push_back(schema.createTuple(tokens));
+  }
+  HeapFile::bulkLoad(rm, fileName, tuples);
+
+  // WHERE employment = 'Software Engineer' AND name >= 'citizen_with_a_long_name_5'
+  Predicate predicate(PredicateOperand::AND,
+    std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::EQUAL, std::make_unique<Field>(fileName, "employment"), std::make_unique<Constant>("Software Engineer"))),
+    std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::GREATER_EQUAL, std::make_unique<Field>(fileName, "name"), std::make_unique<Constant>("citizen_with_a_long_name_5"))));
+
+  u32 numberOfRows = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < 5; ++repeat) {
+    TableScan scan(fileName, rm, schema);
+    scan.getFirst();
+    while (scan.next()) {
+      auto row = scan.getView();
+      numberOfRows += predicate.evaluate(row, schema);
+    }
+  }
+  std::cout << "string filter: " << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+  REQUIRE(numberOfRows > 0);
+}
+
+TEST_CASE("Benchmark filtering one column of row and PAX tables", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "sensor", std::make_unique<ReadFixedCharField>(40));
+  schema.addField(fileName, "reading", std::make_unique<ReadIntField>());
+
+  // WHERE reading > 90
+  Predicate predicate(std::make_unique<Term>(TermOperand::GREATER, std::make_unique<Field>(fileName, "reading"), std::make_unique<Constant>(90)));
+
+  for (bool pax : { false, true }) {
+    std::filesystem::remove(fileName);
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+    HeapFile::createHeapFile(*rm, fileName, 8, 100, pax ? HeapFile::paxColumnsOf(schema) : std::vector<u32>{});
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < numberOfTuples; ++i) {
+      std::vector<Token> tokens{ ttoken(i), ttoken("sensor_" + std::to_string(i % 50)), ttoken(i % 100) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, tuples);
+
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 5; ++repeat) {
+      TableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        auto row = scan.getView();
+        numberOfRows += predicate.evaluate(row, schema);
+      }
+    }
+    std::cout << (pax ? "PAX" : "row") << " layout, " << rm->fm.getNumberOfPages(fileName) << " pages, column filter: "
+      << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+    REQUIRE(numberOfRows == numberOfTuples / 100 * 9 * 5);
+  }
+}
+
+TEST_CASE("Benchmark equality on CHAR and dictionary encoded columns", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile({ fileName, HeapFile::dictionaryFilename(fileName) });
+  const int numberOfTuples = 200000;
+  std::vector<std::string> employments{ "Software Engineer", "Software Architect", "Doctor", "Teacher", "Civil Servant" };
+
+  for (bool dictionary : { false, true }) {
+    std::filesystem::remove(fileName);
+    std::filesystem::remove(HeapFile::dictionaryFilename(fileName));
+    Schema schema;
+    schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+    if (dictionary) {
+      schema.addField(fileName, "employment", std::make_unique<ReadDictField>());
+    }
+    else {
+      schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+    }
+
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+    HeapFile::createHeapFile(*rm, fileName);
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < numberOfTuples; ++i) {
+      std::vector<Token> tokens{ ttoken(i), ttoken(employments[i % employments.size()]) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::bulkLoad(rm, fileName, tuples);
+
+    // WHERE employment = 'Software Architect'
+    Predicate predicate(std::make_unique<Term>(TermOperand::EQUAL, std::make_unique<Field>(fileName, "employment"), std::make_unique<Constant>("Software Architect")));
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 5; ++repeat) {
+      TableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        auto row = scan.getView();
+        numberOfRows += predicate.evaluate(row, schema);
+      }
+    }
+    std::cout << (dictionary ? "DICT" : "CHAR(20)") << " column, " << rm->fm.getNumberOfPages(fileName) << " pages, equality filter: "
+      << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+    REQUIRE(numberOfRows == numberOfTuples / employments.size() * 5);
+  }
+}
+
+TEST_CASE("Benchmark a TIMESTAMP range filter against timestamps stored as strings", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+  const i64 firstEvent = *DateTime::parseTimestamp("2024-01-01");
+
+  for (bool timestamp : { false, true }) {
+    std::filesystem::remove(fileName);
+    Schema schema;
+    schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+    if (timestamp) {
+      schema.addField(fileName, "at", std::make_unique<ReadTimestampField>());
+    }
+    else {
+      schema.addField(fileName, "at", std::make_unique<ReadFixedCharField>(19));
+    }
+
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+    HeapFile::createHeapFile(*rm, fileName);
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < numberOfTuples; ++i) {
+      std::vector<Token> tokens{ ttoken(i), ttoken(DateTime::formatTimestamp(firstEvent + (i64)i * 60 * DateTime::MICROSECONDS_PER_SECOND)) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::bulkLoad(rm, fileName, tuples);
+
+    // WHERE at >= '2024-02-01 00:00:00' AND at < '2024-03-01 00:00:00', a minute apart so 29 days of rows
+    Predicate predicate(PredicateOperand::AND,
+      std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::GREATER_EQUAL, std::make_unique<Field>(fileName, "at"), std::make_unique<Constant>("2024-02-01 00:00:00"))),
+      std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::LESS, std::make_unique<Field>(fileName, "at"), std::make_unique<Constant>("2024-03-01 00:00:00"))));
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 5; ++repeat) {
+      TableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        auto row = scan.getView();
+        numberOfRows += predicate.evaluate(row, schema);
+      }
+    }
+    std::cout << (timestamp ? "TIMESTAMP" : "CHAR(19)") << " column, " << rm->fm.getNumberOfPages(fileName) << " pages, range filter: "
+      << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+    REQUIRE(numberOfRows == 29 * 24 * 60 * 5);
+  }
+}
+
+TEST_CASE("Benchmark a compiled WHERE clause against the predicate tree", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "reading", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "at", std::make_unique<ReadTimestampField>());
+  schema.addField(fileName, "sensor", std::make_unique<ReadFixedCharField>(12));
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+  HeapFile::createHeapFile(*rm, fileName);
+  const i64 firstReading = *DateTime::parseTimestamp("2024-01-01");
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < numberOfTuples; ++i) {
+    std::vector<Token> tokens{ ttoken(i), ttoken(i % 100), ttoken(DateTime::formatTimestamp(firstReading + (i64)i * 60 * DateTime::MICROSECONDS_PER_SECOND)),
+      ttoken("sensor" + std::to_string(i % 8)) };
+    tuples.push_back(schema.createTuple(tokens));
+  }
+  HeapFile::bulkLoad(rm, fileName, tuples);
+
+  Parser parser("SELECT * FROM benchmark WHERE benchmark.reading >= 20 AND benchmark.reading < 60 AND benchmark.sensor = \"sensor3\" "
+    "OR benchmark.at >= \"2024-04-01 00:00:00\";");
+  auto query = parser.parseQuery();
+  auto& predicate = *query.predicate.at(0);
+  predicate.bind(schema);
+  PredicateProgram program(predicate, schema);
+
+  u32 expectedRows = 0;
+  for (bool compiled : { false, true }) {
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 5; ++repeat) {
+      TableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        auto row = scan.getView();
+        numberOfRows += compiled ? program.evaluate(row) : predicate.evaluate(row, schema);
+      }
+    }
+    std::cout << (compiled ? "compiled program" : "predicate tree") << ": " << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+    if (!compiled) {
+      expectedRows = numberOfRows;
+    }
+    REQUIRE(numberOfRows == expectedRows);
+  }
+}
+
+TEST_CASE("Benchmark filter kernels on PAX pages against the compiled program", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "reading", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "level", std::make_unique<ReadDoubleField>());
+  schema.addField(fileName, "at", std::make_unique<ReadTimestampField>());
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+  HeapFile::createHeapFile(*rm, fileName, 8, 100, HeapFile::paxColumnsOf(schema));
+  const i64 firstReading = *DateTime::parseTimestamp("2024-01-01");
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < numberOfTuples; ++i) {
+    std::vector<Token> tokens{ ttoken(i), ttoken(i % 100), Token{ DECIMAL, 0, std::to_string(i % 40) + ".25" },
+      ttoken(DateTime::formatTimestamp(firstReading + (i64)i * 60 * DateTime::MICROSECONDS_PER_SECOND)) };
+    tuples.push_back(schema.createTuple(tokens));
+  }
+  HeapFile::insertTuples(rm, fileName, tuples);
+
+  std::string where = "benchmark.reading >= 20 AND benchmark.reading < 60 AND benchmark.level > 10 AND benchmark.at >= \"2024-02-01 00:00:00\"";
+  u32 expectedRows = 0;
+  for (bool kernels : { false, true }) {
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 5; ++repeat) {
+      Parser parser("SELECT * FROM benchmark WHERE " + where + ";");
+      auto query = parser.parseQuery();
+      if (kernels) {
+        SelectScan scan(std::make_unique<TableScan>(fileName, rm, schema), std::move(query.predicate.at(0)));
+        scan.getFirst();
+        while (scan.next()) {
+          numberOfRows += 1;
+        }
+        continue;
+      }
+      auto& predicate = *query.predicate.at(0);
+      predicate.bind(schema);
+      PredicateProgram program(predicate, schema);
+      TableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        auto row = scan.getView();
+        numberOfRows += program.evaluate(row);
+      }
+    }
+    std::cout << (kernels ? "filter kernels" : "compiled program") << ": " << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+    if (!kernels) {
+      expectedRows = numberOfRows;
+    }
+    REQUIRE(numberOfRows == expectedRows);
+  }
+}
+
+TEST_CASE("Benchmark a WHERE clause written in the worst order", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "reading", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "sensor", std::make_unique<ReadFixedCharField>(12));
+  schema.addField(fileName, "site", std::make_unique<ReadVarCharField>());
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+  HeapFile::createHeapFile(*rm, fileName);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < numberOfTuples; ++i) {
+    std::vector<Token> tokens{ ttoken(i), ttoken(i % 100), ttoken("sensor" + std::to_string(i % 8)), ttoken("site" + std::to_string(i % 3)) };
+    tuples.push_back(schema.createTuple(tokens));
+  }
+  HeapFile::bulkLoad(rm, fileName, tuples);
+
+  // the strings nearly always pass and the range that rejects most rows comes last
+  std::vector<std::pair<std::string, std::string>> clauses{
+    { "predicate tree, as written", "benchmark.site != \"site9\" AND benchmark.sensor >= \"sensor1\" AND benchmark.reading > 95" },
+    { "compiled program, as written", "benchmark.site != \"site9\" AND benchmark.sensor >= \"sensor1\" AND benchmark.reading > 95" },
+    { "compiled program, ordered by hand", "benchmark.reading > 95 AND benchmark.sensor >= \"sensor1\" AND benchmark.site != \"site9\"" },
+  };
+  u32 expectedRows = 0;
+  for (auto& [name, where] : clauses) {
+    Parser parser("SELECT * FROM benchmark WHERE " + where + ";");
+    auto query = parser.parseQuery();
+    auto& predicate = *query.predicate.at(0);
+    predicate.bind(schema);
+    PredicateProgram program(predicate, schema);
+    bool compiled = name != clauses[0].first;
+
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 5; ++repeat) {
+      TableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        auto row = scan.getView();
+        numberOfRows += compiled ? program.evaluate(row) : predicate.evaluate(row, schema);
+      }
+    }
+    std::cout << name << ": " << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+    if (!compiled) {
+      expectedRows = numberOfRows;
+    }
+    REQUIRE(numberOfRows == expectedRows);
+  }
+}
+
+TEST_CASE("Benchmark IN lists against OR chains and LIKE patterns", "[.][benchmark]") {
+  std::string fileName = "benchmark";
+  DeferDeleteFile deferDeleteFile(fileName);
+  const int numberOfTuples = 200000;
+
+  Schema schema;
+  schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "reading", std::make_unique<ReadIntField>());
+  schema.addField(fileName, "sensor", std::make_unique<ReadFixedCharField>(24));
+
+  std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(PAGE_SIZE_S, 64);
+  HeapFile::createHeapFile(*rm, fileName);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < numberOfTuples; ++i) {
+    std::vector<Token> tokens{ ttoken(i), ttoken(i % 1000), ttoken("site" + std::to_string(i % 7) + "_sensor" + std::to_string(i % 50)) };
+    tuples.push_back(schema.createTuple(tokens));
+  }
+  HeapFile::bulkLoad(rm, fileName, tuples);
+
+  std::string orChain;
+  std::string inList;
+  for (int i = 0; i < 40; ++i) {
+    orChain += (i > 0 ? " OR " : "") + std::string("benchmark.reading = ") + std::to_string(i * 7);
+    inList += (i > 0 ? ", " : "") + std::to_string(i * 7);
+  }
+  std::vector<std::pair<std::string, std::string>> clauses{
+    { "40 ORs", orChain }, { "IN list of 40", "benchmark.reading IN (" + inList + ")" },
+    { "LIKE substring", "benchmark.sensor LIKE \"%sensor4%\"" }, { "LIKE with _", "benchmark.sensor LIKE \"%sensor_4%\"" },
+    { "LIKE prefix", "benchmark.sensor LIKE \"site3%\"" },
+  };
+  std::vector<u32> expectedRows{ 40 * numberOfTuples / 1000, 40 * numberOfTuples / 1000, numberOfTuples / 50 * 11, numberOfTuples / 50 * 4, 28571 };
+  for (u32 i = 0; i < clauses.size(); ++i) {
+    u32 numberOfRows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 5; ++repeat) {
+      Parser parser("SELECT * FROM benchmark WHERE " + clauses[i].second + ";");
+      auto query = parser.parseQuery();
+      SelectScan scan(std::make_unique<TableScan>(fileName, rm, schema), std::move(query.predicate.at(0)));
+      scan.getFirst();
+      while (scan.next()) {
+        numberOfRows += 1;
+      }
+    }
+    std::cout << clauses[i].first << ": " << rowsPerSecond(numberOfTuples * 5, start) << " rows/sec\n";
+    INFO(clauses[i].first);
+    REQUIRE(numberOfRows == expectedRows[i] * 5);
+  }
+}
@@ -24,7 +24,7 @@ TEST_CASE("Check buffer works") {
   std::string testString = "Hello, world!";
   int testInt = 1234567;
   int offset = 50;
-  for (int i = 0; i < testString.size(); i++) {
+  for (u32 i = 0; i < testString.size(); i++) {
     writeTest[i] = testString[i % testString.size()];
   }
   std::memcpy(writeTest.data() + offset, &testInt, sizeof(int));
@@ -35,10 +35,41 @@ TEST_CASE("Check buffer works") {
   fileManager.read(PageId{ fileName, 2 }, readTest);
 
 
-  for (int i = 0; i < testString.size(); i++) {
+  for (u32 i = 0; i < testString.size(); i++) {
     REQUIRE(writeTest[i] == readTest[i]);
   }
   int readInt;
   std::memcpy(&readInt, readTest.data() + offset, sizeof(int));
   REQUIRE(readInt == testInt);
 }
+
+TEST_CASE("Tuple page slot free list and occupancy bitmap") {
+  std::vector<char> page(PAGE_SIZE_L, 0);
+  TuplePage header{ 0, PAGE_SIZE_L, 0, PAGE_SIZE_L };
+  std::memcpy(page.data(), &header, sizeof(TuplePage));
+  TuplePage* tp = reinterpret_cast<TuplePage*>(page.data());
+
+  // new slots are appended while the free list is empty
+  for (u32 i = 0; i < 200; ++i) {
+    REQUIRE(tp->allocateSlot() == i);
+  }
+  REQUIRE(tp->numberOfOccupiedSlots() == 200);
+
+  // free everything except a few slots spread over several bitmap words
+  for (u32 i = 0; i < 200; ++i) {
+    if (i != 3 && i != 64 && i != 150) {
+      tp->freeSlot(i);
+    }
+  }
+  REQUIRE(tp->numberOfOccupiedSlots() == 3);
+  REQUIRE(tp->nextOccupiedSlot(0) == 3);
+  REQUIRE(tp->nextOccupiedSlot(4) == 64);
+  REQUIRE(tp->nextOccupiedSlot(65) == 150);
+  REQUIRE(tp->nextOccupiedSlot(151) == tp->numberOfSlots);
+
+  // freed slots are reused before the page grows
+  REQUIRE(tp->allocateSlot() == 199);
+  REQUIRE(tp->allocateSlot() == 198);
+  REQUIRE(tp->numberOfSlots == 200);
+  REQUIRE(tp->nextOccupiedSlot(151) == 198);
+}
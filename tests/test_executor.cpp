@@ -185,6 +185,680 @@ TEST_CASE("Normal insert and then update") {
 
 
 
+TEST_CASE("Normal insert, delete and then vacuum") {
+  DeferDeleteFile deferDeleteFile({ "citizen", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    auto createTable = R"(
+    CREATE TABLE citizen(
+                  name VARCHAR(30),
+                  employment CHAR(20),
+                  age INT
+                );
+  )";
+
+    Executor executor(rm);
+    executor.execute(createTable);
+    for (int i = 0; i < 10; ++i) {
+      executor.execute(R"(
+      INSERT INTO citizen
+      VALUES
+        ("David", "Doctor", 27),
+        ("Brian", "Engineer", 34),
+        ("David", "Artist", 41),
+        ("Emma", "Nurse", 31),
+        ("Miles", "Carpenter", 41),
+        ("Sophia", "Scientist", 28),
+        ("James", "Lawyer", 39),
+        ("Olivia", "Chef", 25);
+      )");
+    }
+    executor.execute("DELETE FROM citizen WHERE citizen.age < 40;");
+    u32 pagesBefore = rm->fm.getNumberOfPages("citizen");
+
+    auto [vacuumTuples, vacuumMsg] = executor.execute("VACUUM citizen;");
+    u32 pagesAfter = rm->fm.getNumberOfPages("citizen");
+    REQUIRE(pagesAfter < pagesBefore);
+    REQUIRE(vacuumMsg.find("pages reclaimed") != std::string::npos);
+
+    auto [afterResultTuple, msg] = executor.execute("SELECT * FROM citizen;");
+    REQUIRE(afterResultTuple.size() == 20);
+    for (auto& tuple : afterResultTuple) {
+      REQUIRE(tuple.fields[2]->getConstant().num == 41);
+    }
+
+    // the rewritten table can still be modified
+    executor.execute(R"(INSERT INTO citizen VALUES ("Emma", "Nurse", 31);)");
+    executor.execute("DELETE FROM citizen WHERE citizen.name = \"Miles\";");
+    auto [finalResultTuple, finalMsg] = executor.execute("SELECT * FROM citizen;");
+    REQUIRE(finalResultTuple.size() == 11);
+  }
+}
+
+TEST_CASE("Vacuum rewrites a table larger than a page directory") {
+  DeferDeleteFile deferDeleteFile({ "citizen", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE citizen(name VARCHAR(30), age INT);");
+    for (int i = 0; i < 100; ++i) {
+      std::string values;
+      for (int j = 0; j < 20; ++j) {
+        values += std::string(values.empty() ? "" : ", ") + "(\"citizen" + std::to_string(i * 20 + j) + "\", " + std::to_string(j) + ")";
+      }
+      executor.execute("INSERT INTO citizen VALUES " + values + ";");
+    }
+    executor.execute("DELETE FROM citizen WHERE citizen.age < 5;");
+
+    // the rows are loaded in batches of a page directory each
+    executor.execute("VACUUM citizen;");
+    REQUIRE(HeapFile::numberOfPageDirectories(*rm, "citizen") > 1);
+
+    auto [resultTuple, msg] = executor.execute("SELECT * FROM citizen;");
+    REQUIRE(resultTuple.size() == 1500);
+    for (auto& tuple : resultTuple) {
+      REQUIRE(tuple.fields[1]->getConstant().num >= 5);
+    }
+  }
+}
+
+TEST_CASE("Insert, update and vacuum large values") {
+  DeferDeleteFile deferDeleteFile({ "notes", "notes.overflow", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE notes(id INT, body VARCHAR(2000));");
+
+    std::string longBody(1500, 'x');
+    for (int i = 0; i < 6; ++i) {
+      executor.execute("INSERT INTO notes VALUES (" + std::to_string(i) + ", \"" + longBody + "\");");
+    }
+    executor.execute("UPDATE notes SET body = \"short\" WHERE notes.id = 1;");
+    executor.execute("DELETE FROM notes WHERE notes.id > 3;");
+    executor.execute("VACUUM notes;");
+
+    auto [resultTuple, msg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(resultTuple.size() == 4);
+    for (auto& tuple : resultTuple) {
+      std::string expected = tuple.fields[0]->getConstant().num == 1 ? "short" : longBody;
+      REQUIRE(tuple.fields[1]->getConstant() == Constant(expected));
+    }
+  }
+}
+
+TEST_CASE("Rows returned by an insert of large values outlive the statement") {
+  DeferDeleteFile deferDeleteFile({ "notes", "notes.overflow", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE notes(id INT, body VARCHAR(2000));");
+
+    // the body goes to overflow pages, the returned row holds the field that points to them
+    std::string longBody(1500, 'x');
+    auto [insertedTuples, insertMsg] = executor.execute("INSERT INTO notes VALUES (1, \"" + longBody + "\");");
+    REQUIRE(insertedTuples.size() == 1);
+
+    // the next statements reuse the arenas the insert ran in
+    executor.execute("INSERT INTO notes VALUES (2, \"" + std::string(1500, 'y') + "\");");
+    executor.execute("UPDATE notes SET body = \"short\" WHERE notes.id = 2;");
+
+    REQUIRE(insertedTuples[0].fields[0]->getConstant().num == 1);
+    REQUIRE(insertedTuples[0].fields[1]->getConstant() == Constant(longBody));
+  }
+}
+
+TEST_CASE("Overflow pages of erased and replaced values are reused") {
+  DeferDeleteFile deferDeleteFile({ "notes", "notes.overflow", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE notes(id INT, body VARCHAR(2000));");
+    for (int i = 0; i < 6; ++i) {
+      executor.execute("INSERT INTO notes VALUES (" + std::to_string(i) + ", \"" + std::string(1500, 'x') + "\");");
+    }
+    u32 overflowPages = rm->fm.getNumberOfPages("notes.overflow");
+    u32 chainPages = (overflowPages - 1) / 6;
+
+    // a replaced value frees its chain for the next one, the file grows by one chain at most
+    for (char c : std::string("abcde")) {
+      executor.execute("UPDATE notes SET body = \"" + std::string(1500, c) + "\";");
+      REQUIRE(rm->fm.getNumberOfPages("notes.overflow") <= overflowPages + chainPages);
+    }
+    auto [updated, updateMsg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(updated.size() == 6);
+    for (auto& tuple : updated) {
+      REQUIRE(tuple.fields[1]->getConstant() == Constant(std::string(1500, 'e')));
+    }
+
+    // so does an erased value
+    u32 pagesAfterUpdate = rm->fm.getNumberOfPages("notes.overflow");
+    executor.execute("DELETE FROM notes WHERE notes.id < 3;");
+    for (int i = 0; i < 3; ++i) {
+      executor.execute("INSERT INTO notes VALUES (" + std::to_string(i) + ", \"" + std::string(1500, 'y') + "\");");
+    }
+    REQUIRE(rm->fm.getNumberOfPages("notes.overflow") == pagesAfterUpdate);
+    auto [inserted, insertMsg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(inserted.size() == 6);
+    for (auto& tuple : inserted) {
+      std::string expected(1500, tuple.fields[0]->getConstant().num < 3 ? 'y' : 'e');
+      REQUIRE(tuple.fields[1]->getConstant() == Constant(expected));
+    }
+
+    // truncate drops the overflow file with the heap file
+    executor.execute("TRUNCATE TABLE notes;");
+    REQUIRE(!rm->fm.doesFileExists("notes.overflow"));
+  }
+}
+
+// the RID and slot of the row with the id, ids are the first INT column of the table.
+static std::pair<RID, Slot> findRow(std::shared_ptr<ResourceManager>& rm, const std::string& table, int id) {
+  HeapFile::HeapFileIterator iter(table, rm);
+  iter.findFirstDir();
+  do {
+    while (iter.nextPageInDir()) {
+      BufferFrame* frame = iter.getPageBuffer();
+      TuplePage* tp = reinterpret_cast<TuplePage*>(frame->bufferData.data());
+      for (u32 i = tp->nextOccupiedSlot(0); i < tp->numberOfSlots; i = tp->nextOccupiedSlot(i + 1)) {
+        Slot slot = tp->slots()[i];
+        if (slot.isForwarded()) {
+          continue;
+        }
+        int rowId;
+        const char* row = frame->bufferData.data() + slot.getOffset();
+        std::memcpy(&rowId, row + RowHeader::columnOffset(row, 0), sizeof(int));
+        if (rowId == id) {
+          return { RID{ frame->pageId.pageNumber, i }, slot };
+        }
+      }
+    }
+  } while (iter.nextDir());
+  return { RID{ u64Max, u32Max }, Slot{} };
+}
+
+TEST_CASE("Updated rows keep their RID") {
+  DeferDeleteFile deferDeleteFile({ "notes", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE notes(id INT, body VARCHAR(200));");
+    for (int i = 0; i < 12; ++i) {
+      executor.execute("INSERT INTO notes VALUES (" + std::to_string(i) + ", \"" + std::string(30, 'a') + "\");");
+    }
+    auto [firstRid, firstSlot] = findRow(rm, "notes", 0);
+    auto [lastRid, lastSlot] = findRow(rm, "notes", 11);
+    REQUIRE(firstRid.pageNumber != lastRid.pageNumber);
+
+    // the first page is full, so the row is moved and a forwarding slot is left behind
+    executor.execute("UPDATE notes SET body = \"" + std::string(100, 'b') + "\" WHERE notes.id = 0;");
+    auto [movedRid, movedSlot] = findRow(rm, "notes", 0);
+    REQUIRE(movedRid.pageNumber != firstRid.pageNumber);
+    REQUIRE(movedSlot.isRelocated());
+    {
+      BufferFrame* frame = rm->bm.pin(rm->fm, PageId{ "notes", firstRid.pageNumber });
+      Slot homeSlot = reinterpret_cast<TuplePage*>(frame->bufferData.data())->slots()[firstRid.slotNumber];
+      REQUIRE(homeSlot.isForwarded());
+      REQUIRE(homeSlot.getForward().pageNumber == movedRid.pageNumber);
+      REQUIRE(homeSlot.getForward().slotNumber == movedRid.slotNumber);
+      rm->bm.unpin(rm->fm, PageId{ "notes", firstRid.pageNumber });
+    }
+
+    // growing again still takes a single hop from the original slot
+    executor.execute("UPDATE notes SET body = \"" + std::string(110, 'c') + "\" WHERE notes.id = 0;");
+    auto [movedAgainRid, movedAgainSlot] = findRow(rm, "notes", 0);
+    REQUIRE(movedAgainSlot.isRelocated());
+    REQUIRE(!movedAgainSlot.isForwarded());
+
+    // the last page has space, so the row grows in place
+    executor.execute("UPDATE notes SET body = \"" + std::string(100, 'd') + "\" WHERE notes.id = 11;");
+    auto [grownRid, grownSlot] = findRow(rm, "notes", 11);
+    REQUIRE(grownRid.pageNumber == lastRid.pageNumber);
+    REQUIRE(grownRid.slotNumber == lastRid.slotNumber);
+
+    // each row is seen exactly once
+    auto [resultTuple, msg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(resultTuple.size() == 12);
+    for (auto& tuple : resultTuple) {
+      int id = tuple.fields[0]->getConstant().num;
+      std::string expected = id == 0 ? std::string(110, 'c') : id == 11 ? std::string(100, 'd') : std::string(30, 'a');
+      REQUIRE(tuple.fields[1]->getConstant() == Constant(expected));
+    }
+
+    executor.execute("DELETE FROM notes WHERE notes.id = 0;");
+    REQUIRE(findRow(rm, "notes", 0).first.pageNumber == u64Max);
+    auto [afterDeleteTuple, deleteMsg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(afterDeleteTuple.size() == 11);
+  }
+}
+
+TEST_CASE("Fill factor leaves room for rows to grow in place") {
+  DeferDeleteFile deferDeleteFile({ "notes", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE notes(id INT, body VARCHAR(200)) WITH (FILLFACTOR = 70);");
+    REQUIRE(HeapFile::getFillFactor(*rm, "notes") == 70);
+    for (int i = 0; i < 30; ++i) {
+      executor.execute("INSERT INTO notes VALUES (" + std::to_string(i) + ", \"" + std::string(30, 'a') + "\");");
+    }
+
+    // every page keeps the reserved space free
+    u32 reserved = HeapFile::reservedSpace(TEST_PAGE_SIZE, 70);
+    {
+      HeapFile::HeapFileIterator iter("notes", rm);
+      iter.findFirstDir();
+      PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(iter.getPageDirBuffer()->bufferData.data() + sizeof(PageDirectory));
+      while (iter.nextPageInDir()) {
+        REQUIRE(pageEntryList[iter.getPageEntryIndex()].freeSpace >= reserved);
+      }
+    }
+
+    // so every row can grow without leaving its page
+    std::vector<std::pair<RID, Slot>> rowsBefore;
+    for (int i = 0; i < 30; ++i) {
+      rowsBefore.push_back(findRow(rm, "notes", i));
+    }
+    executor.execute("UPDATE notes SET body = \"" + std::string(40, 'b') + "\";");
+    for (int i = 0; i < 30; ++i) {
+      auto [rid, slot] = findRow(rm, "notes", i);
+      REQUIRE(rid.pageNumber == rowsBefore[i].first.pageNumber);
+      REQUIRE(rid.slotNumber == rowsBefore[i].first.slotNumber);
+      REQUIRE(!slot.isRelocated());
+    }
+
+    auto [resultTuple, msg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(resultTuple.size() == 30);
+    for (auto& tuple : resultTuple) {
+      REQUIRE(tuple.fields[1]->getConstant() == Constant(std::string(40, 'b')));
+    }
+  }
+}
+
+TEST_CASE("A low fill factor spreads rows over more pages") {
+  DeferDeleteFile deferDeleteFile({ "packed", "spread", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE packed(id INT, body VARCHAR(200));");
+    executor.execute("CREATE TABLE spread(id INT, body VARCHAR(200)) WITH (FILLFACTOR = 50);");
+    for (int i = 0; i < 200; ++i) {
+      std::string values = " VALUES (" + std::to_string(i) + ", \"" + std::string(20, 'a') + "\");";
+      executor.execute("INSERT INTO packed" + values);
+      executor.execute("INSERT INTO spread" + values);
+    }
+
+    // pages that hold at least one row
+    auto usedPages = [&rm](const std::string& table) {
+      u32 emptyPage = TEST_PAGE_SIZE - TuplePage::headerSize(TEST_PAGE_SIZE);
+      u32 numberOfPages = 0;
+      HeapFile::HeapFileIterator iter(table, rm);
+      iter.findFirstDir();
+      do {
+        while (iter.nextPageInDir()) {
+          PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(iter.getPageDirBuffer()->bufferData.data() + sizeof(PageDirectory));
+          numberOfPages += pageEntryList[iter.getPageEntryIndex()].freeSpace < emptyPage;
+        }
+      } while (iter.nextDir());
+      return numberOfPages;
+    };
+    u32 packedPages = usedPages("packed");
+    u32 spreadPages = usedPages("spread");
+    REQUIRE(spreadPages * 10 >= packedPages * 18);
+    REQUIRE(spreadPages * 10 <= packedPages * 22);
+
+    auto [resultTuple, msg] = executor.execute("SELECT * FROM spread;");
+    REQUIRE(resultTuple.size() == 200);
+  }
+}
+
+TEST_CASE("Truncate resets the table") {
+  DeferDeleteFile deferDeleteFile({ "notes", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    executor.execute("CREATE TABLE notes(id INT, body VARCHAR(2000)) WITH (FILLFACTOR = 80);");
+    u32 emptyPages = rm->fm.getNumberOfPages("notes");
+    for (int i = 0; i < 200; ++i) {
+      executor.execute("INSERT INTO notes VALUES (" + std::to_string(i) + ", \"" + std::string(i % 10 == 0 ? 1000 : 20, 'a') + "\");");
+    }
+    REQUIRE(rm->fm.getNumberOfPages("notes") > emptyPages);
+    REQUIRE(rm->fm.doesFileExists("notes.overflow"));
+
+    auto [truncateTuples, truncateMsg] = executor.execute("TRUNCATE TABLE notes;");
+    REQUIRE(truncateMsg == "");
+    REQUIRE(rm->fm.getNumberOfPages("notes") == emptyPages);
+    REQUIRE(!rm->fm.doesFileExists("notes.overflow"));
+    REQUIRE(rm->insertHints.count("notes") == 0);
+    REQUIRE(HeapFile::getFillFactor(*rm, "notes") == 80);
+
+    auto [emptyTuples, emptyMsg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(emptyTuples.size() == 0);
+
+    // the table is usable again
+    executor.execute("INSERT INTO notes VALUES (1, \"again\");");
+    auto [resultTuple, msg] = executor.execute("SELECT * FROM notes;");
+    REQUIRE(resultTuple.size() == 1);
+    REQUIRE(resultTuple[0].fields[1]->getConstant().str == "again");
+
+    auto [missingTuples, missingMsg] = executor.execute("TRUNCATE TABLE missing;");
+    REQUIRE(missingMsg == "Table does not exist\n");
+  }
+}
+
+TEST_CASE("PAX tables keep every column in its own minipage") {
+  DeferDeleteFile deferDeleteFile({ "readings", "readings.vacuum", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    Executor executor(rm);
+    auto [rejectedTuples, rejectedMsg] = executor.execute("CREATE TABLE notes(id INT, body VARCHAR(20)) WITH (LAYOUT = PAX);");
+    REQUIRE(rejectedMsg == "PAX layout needs fixed width columns\n");
+
+    executor.execute("CREATE TABLE readings(id INT, sensor CHAR(12)) WITH (FILLFACTOR = 70, LAYOUT = PAX);");
+    REQUIRE(HeapFile::getPaxColumns(*rm, "readings") == std::vector<u32>{ sizeof(i32), 12 });
+    for (int i = 0; i < 100; ++i) {
+      executor.execute("INSERT INTO readings VALUES (" + std::to_string(i) + ", \"s" + std::to_string(i % 4) + "\");");
+    }
+
+    // the ids of a page are stored one after the other
+    {
+      HeapFile::HeapFileIterator iter("readings", rm);
+      iter.findFirstDir();
+      REQUIRE(iter.nextPageInDir());
+      PaxPage* pp = reinterpret_cast<PaxPage*>(iter.getPageBuffer()->bufferData.data());
+      REQUIRE(pp->pageType == PageType::PaxPage);
+      REQUIRE(pp->numberOfRows == pp->rowCapacity);
+      for (u32 row = 0; row < pp->numberOfRows; ++row) {
+        i32 id;
+        std::memcpy(&id, iter.getPageBuffer()->bufferData.data() + pp->minipages()[0].offset + row * sizeof(i32), sizeof(i32));
+        REQUIRE(id == (i32)row);
+      }
+    }
+
+    auto [selected, selectMsg] = executor.execute("SELECT readings.id FROM readings WHERE readings.sensor = \"s1\";");
+    REQUIRE(selected.size() == 25);
+    for (auto& tuple : selected) {
+      REQUIRE(tuple.fields[0]->getConstant().num % 4 == 1);
+    }
+
+    executor.execute("UPDATE readings SET sensor = \"moved\" WHERE readings.id < 10;");
+    executor.execute("DELETE FROM readings WHERE readings.sensor = \"s2\";");
+    auto [moved, movedMsg] = executor.execute("SELECT * FROM readings WHERE readings.sensor = \"moved\";");
+    REQUIRE(moved.size() == 10);
+    auto [remaining, remainingMsg] = executor.execute("SELECT * FROM readings;");
+    REQUIRE(remaining.size() == 77);
+
+    // the first deleted row is reused, id 10 in row 10 of the first tuple page, and vacuum keeps the layout
+    executor.execute("INSERT INTO readings VALUES (100, \"s5\");");
+    Schema schema = getSchemaFromTableName({ "readings" }, rm).at("readings");
+    REQUIRE(HeapFile::fetch(rm, "readings", schema, RID{ 4, 10 }).fields[0]->getConstant().num == 100);
+    executor.execute("VACUUM readings;");
+    REQUIRE(HeapFile::getPaxColumns(*rm, "readings").size() == 2);
+    auto [vacuumed, vacuumedMsg] = executor.execute("SELECT * FROM readings;");
+    REQUIRE(vacuumed.size() == 78);
+
+    executor.execute("TRUNCATE TABLE readings;");
+    REQUIRE(HeapFile::getPaxColumns(*rm, "readings").size() == 2);
+    auto [emptyTuples, emptyMsg] = executor.execute("SELECT * FROM readings;");
+    REQUIRE(emptyTuples.size() == 0);
+  }
+}
+
+TEST_CASE("DICT columns store codes of a per table dictionary") {
+  DeferDeleteFile deferDeleteFile({ "staff", "staff.dict", "staff.vacuum", "staff.vacuum.dict", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    std::vector<std::string> jobs{ "Doctor", "Engineer", "Teacher", "Software Architect" };
+    {
+      Executor executor(rm);
+      executor.execute("CREATE TABLE staff(id INT, job DICT) WITH (LAYOUT = PAX);");
+      for (int i = 0; i < 200; ++i) {
+        executor.execute("INSERT INTO staff VALUES (" + std::to_string(i) + ", \"" + jobs[i % jobs.size()] + "\");");
+      }
+      REQUIRE(HeapFile::getDictionary(*rm, "staff")->size() == jobs.size());
+      REQUIRE(HeapFile::getPaxColumns(*rm, "staff") == std::vector<u32>{ sizeof(i32), sizeof(u16) });
+
+      auto [architects, architectsMsg] = executor.execute("SELECT * FROM staff WHERE staff.job = \"Software Architect\";");
+      REQUIRE(architects.size() == 50);
+      REQUIRE(architects[0].fields[1]->getConstant().str == "Software Architect");
+      auto [missing, missingMsg] = executor.execute("SELECT * FROM staff WHERE staff.job = \"Pilot\";");
+      REQUIRE(missing.size() == 0);
+      auto [others, othersMsg] = executor.execute("SELECT * FROM staff WHERE staff.job != \"Doctor\";");
+      REQUIRE(others.size() == 150);
+
+      // a new value is added to the dictionary, the constant that was missing matches it now
+      executor.execute("UPDATE staff SET job = \"Pilot\" WHERE staff.job = \"Teacher\";");
+      REQUIRE(HeapFile::getDictionary(*rm, "staff")->size() == jobs.size() + 1);
+      executor.execute("DELETE FROM staff WHERE staff.job = \"Engineer\";");
+      // a dictionary left behind by an interrupted vacuum is not used by the next one
+      rm->bm.flush(rm->fm, HeapFile::dictionaryFilename("staff"));
+      std::filesystem::copy_file(HeapFile::dictionaryFilename("staff"), HeapFile::dictionaryFilename("staff.vacuum"));
+      executor.execute("VACUUM staff;");
+    }
+
+    // the dictionary is read back from its file, vacuum only kept the values that are still used
+    rm->bm.flush(rm->fm, HeapFile::dictionaryFilename("staff"));
+    std::shared_ptr<ResourceManager> reopened = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    Executor executor(reopened);
+    REQUIRE(HeapFile::getDictionary(*reopened, "staff")->size() == 3);
+    auto [pilots, pilotsMsg] = executor.execute("SELECT * FROM staff WHERE staff.job = \"Pilot\";");
+    REQUIRE(pilots.size() == 50);
+    auto [remaining, remainingMsg] = executor.execute("SELECT * FROM staff;");
+    REQUIRE(remaining.size() == 150);
+
+    executor.execute("TRUNCATE TABLE staff;");
+    REQUIRE(!reopened->fm.doesFileExists(HeapFile::dictionaryFilename("staff")));
+    REQUIRE(HeapFile::getDictionary(*reopened, "staff")->size() == 0);
+  }
+}
+
+TEST_CASE("Typed columns are stored natively and filtered by range") {
+  DeferDeleteFile deferDeleteFile({ "events", "events.vacuum", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    Executor executor(rm);
+    executor.execute("CREATE TABLE events(id BIGINT, price DOUBLE, day DATE, at TIMESTAMP, done BOOLEAN) WITH (LAYOUT = PAX);");
+    REQUIRE(HeapFile::getPaxColumns(*rm, "events") == std::vector<u32>{ sizeof(i64), sizeof(double), sizeof(i32), sizeof(i64), sizeof(u8) });
+
+    // one event every hour from 2024-01-01, ids past the range of INT
+    for (int i = 0; i < 100; ++i) {
+      std::string at = DateTime::formatTimestamp(*DateTime::parseTimestamp("2024-01-01") + i * 3600 * DateTime::MICROSECONDS_PER_SECOND);
+      executor.execute("INSERT INTO events VALUES (" + std::to_string(5000000000LL + i) + ", " + std::to_string(i) + ".5, \"" +
+        at.substr(0, 10) + "\", \"" + at + "\", " + (i % 2 == 0 ? "TRUE" : "FALSE") + ");");
+    }
+
+    auto [all, allMsg] = executor.execute("SELECT * FROM events;");
+    REQUIRE(all.size() == 100);
+    REQUIRE(all[1].fields[0]->getConstant().num == 5000000001LL);
+    REQUIRE(all[1].fields[1]->getConstant().real == 1.5);
+    REQUIRE(all[1].fields[2]->getConstant() == Constant("2024-01-01"));
+    REQUIRE(all[1].fields[3]->getConstant() == Constant("2024-01-01 01:00:00"));
+    REQUIRE(all[1].fields[4]->getConstant() == Constant::boolean(false));
+
+    // the literals are read as timestamps and dates once, the rows are compared as integers
+    auto [morning, morningMsg] = executor.execute(
+      "SELECT * FROM events WHERE events.at >= \"2024-01-02 06:00:00\" AND events.at < \"2024-01-02 12:00:00\";");
+    REQUIRE(morning.size() == 6);
+    auto [secondDay, secondDayMsg] = executor.execute("SELECT * FROM events WHERE events.day = \"2024-01-02\";");
+    REQUIRE(secondDay.size() == 24);
+    auto [later, laterMsg] = executor.execute("SELECT * FROM events WHERE events.day > \"2024-01-03\";");
+    REQUIRE(later.size() == 28);
+
+    auto [cheap, cheapMsg] = executor.execute("SELECT * FROM events WHERE events.price < 10 AND events.done = TRUE;");
+    REQUIRE(cheap.size() == 5);
+    auto [big, bigMsg] = executor.execute("SELECT * FROM events WHERE events.id >= 5000000090;");
+    REQUIRE(big.size() == 10);
+
+    executor.execute("UPDATE events SET done = TRUE, price = 0.25 WHERE events.day = \"2024-01-01\";");
+    auto [done, doneMsg] = executor.execute("SELECT * FROM events WHERE events.done = TRUE;");
+    REQUIRE(done.size() == 62);
+    auto [updated, updatedMsg] = executor.execute("SELECT * FROM events WHERE events.price = 0.25;");
+    REQUIRE(updated.size() == 24);
+
+    // a DOUBLE in the IN list of a BIGINT column does not turn the ids past 2^53 into doubles
+    executor.execute("INSERT INTO events VALUES (9007199254740992, 1.5, \"2024-02-01\", \"2024-02-01 00:00:00\", FALSE);");
+    auto [collision, collisionMsg] = executor.execute("SELECT * FROM events WHERE events.id IN (9007199254740993, 0.5);");
+    REQUIRE(collisionMsg == "");
+    REQUIRE(collision.size() == 0);
+    auto [exact, exactMsg] = executor.execute("SELECT * FROM events WHERE events.id IN (9007199254740992, 0.5);");
+    REQUIRE(exact.size() == 1);
+    // a DOUBLE that is an integer still matches
+    auto [integral, integralMsg] = executor.execute("SELECT * FROM events WHERE events.id IN (5000000001.0, 0.5);");
+    REQUIRE(integralMsg == "");
+    REQUIRE(integral.size() == 1);
+  }
+}
+
+TEST_CASE("INT columns reject numbers past 32 bits") {
+  DeferDeleteFile deferDeleteFile({ "counts", "wide", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    Executor executor(rm);
+    executor.execute("CREATE TABLE counts(a INT, b INT);");
+    executor.execute("INSERT INTO counts VALUES (2147483647, -2147483648);");
+
+    auto [badInsert, badInsertMsg] = executor.execute("INSERT INTO counts VALUES (3000000000, 1);");
+    REQUIRE(badInsertMsg == "Cannot insert into a INT\n");
+    auto [badUpdate, badUpdateMsg] = executor.execute("UPDATE counts SET a = 5000000000;");
+    REQUIRE(badUpdateMsg == "Cannot assign NUMBER to a INT\n");
+
+    // only the row that fits was written, and it was not changed
+    auto [all, allMsg] = executor.execute("SELECT * FROM counts;");
+    REQUIRE(all.size() == 1);
+    REQUIRE(all[0].fields[0]->getConstant().num == 2147483647);
+    REQUIRE(all[0].fields[1]->getConstant().num == -2147483648LL);
+
+    // a BIGINT column is not narrowed into an INT column, the other way round is fine
+    executor.execute("CREATE TABLE wide(a INT, b BIGINT);");
+    executor.execute("INSERT INTO wide VALUES (1, 5000000000);");
+    auto [narrow, narrowMsg] = executor.execute("UPDATE wide SET a = b;");
+    REQUIRE(narrowMsg == "Cannot assign NUMBER to a INT\n");
+    auto [widen, widenMsg] = executor.execute("UPDATE wide SET b = a;");
+    REQUIRE(widenMsg == "");
+    auto [widened, widenedMsg] = executor.execute("SELECT * FROM wide;");
+    REQUIRE(widened.size() == 1);
+    REQUIRE(widened[0].fields[0]->getConstant().num == 1);
+    REQUIRE(widened[0].fields[1]->getConstant().num == 1);
+  }
+}
+
+TEST_CASE("Statements are bound to the columns of their table before they run") {
+  DeferDeleteFile deferDeleteFile({ "citizen", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    Executor executor(rm);
+    executor.execute("CREATE TABLE citizen(name CHAR(20), age INT, born DATE);");
+    for (int i = 0; i < 10; ++i) {
+      executor.execute("INSERT INTO citizen VALUES (\"citizen" + std::to_string(i) + "\", " + std::to_string(20 + i) + ", \"19" + std::to_string(90 + i) + "-01-01\");");
+    }
+
+    auto [unknown, unknownMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.height > 3;");
+    REQUIRE(unknownMsg == "Column does not exist: citizen.height\n");
+    auto [unknownSelect, unknownSelectMsg] = executor.execute("SELECT height FROM citizen;");
+    REQUIRE(unknownSelectMsg == "Column does not exist: height\n");
+    auto [mismatch, mismatchMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.name = 5;");
+    REQUIRE(mismatchMsg == "Cannot compare STRING with NUMBER\n");
+    auto [badDate, badDateMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.born < \"soon\";");
+    REQUIRE(badDateMsg == "Invalid DATE: soon\n");
+    auto [badUpdate, badUpdateMsg] = executor.execute("UPDATE citizen SET age = \"old\";");
+    REQUIRE(badUpdateMsg == "Cannot assign STRING to age INT\n");
+    auto [overflowUpdate, overflowUpdateMsg] = executor.execute("UPDATE citizen SET age = 5000000000;");
+    REQUIRE(overflowUpdateMsg == "Cannot assign NUMBER to age INT\n");
+    auto [badDelete, badDeleteMsg] = executor.execute("DELETE FROM citizen WHERE citizen.height > 3;");
+    REQUIRE(badDeleteMsg == "Column does not exist: citizen.height\n");
+
+    // nothing was changed, and a column without its table is found as well
+    auto [older, olderMsg] = executor.execute("SELECT name FROM citizen WHERE age >= 25;");
+    REQUIRE(olderMsg == "");
+    REQUIRE(older.size() == 5);
+    executor.execute("UPDATE citizen SET age = 50 WHERE born < \"1992-06-01\";");
+    auto [updated, updatedMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.age = 50;");
+    REQUIRE(updated.size() == 3);
+  }
+}
+
+TEST_CASE("Constant and contradictory WHERE clauses are decided before the scan") {
+  DeferDeleteFile deferDeleteFile({ "citizen", "schema" });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    Executor executor(rm);
+    executor.execute("CREATE TABLE citizen(name CHAR(20), age INT);");
+    for (int i = 0; i < 10; ++i) {
+      executor.execute("INSERT INTO citizen VALUES (\"citizen" + std::to_string(i) + "\", " + std::to_string(20 + i) + ");");
+    }
+
+    auto [all, allMsg] = executor.execute("SELECT * FROM citizen WHERE 1 = 1;");
+    REQUIRE(all.size() == 10);
+    auto [none, noneMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.age > 25 AND citizen.age < 22;");
+    REQUIRE(noneMsg == "");
+    REQUIRE(none.size() == 0);
+    auto [merged, mergedMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.age > 21 AND citizen.age > 24 AND citizen.age <= 27 AND 2 > 1;");
+    REQUIRE(merged.size() == 3);
+
+    executor.execute("DELETE FROM citizen WHERE citizen.age = 20 AND citizen.age = 21;");
+    executor.execute("UPDATE citizen SET age = 40 WHERE 1 = 2;");
+    auto [unchanged, unchangedMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.age < 40;");
+    REQUIRE(unchanged.size() == 10);
+    executor.execute("DELETE FROM citizen WHERE \"a\" < \"b\";");
+    auto [deleted, deletedMsg] = executor.execute("SELECT * FROM citizen;");
+    REQUIRE(deleted.size() == 0);
+  }
+}
+
+TEST_CASE("IN lists and LIKE patterns filter every column type") {
+  DeferDeleteFile deferDeleteFile({ "citizen", "schema", HeapFile::overflowFilename("citizen"), HeapFile::dictionaryFilename("citizen") });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    Executor executor(rm);
+    executor.execute("CREATE TABLE citizen(name CHAR(20), bio VARCHAR(2000), city DICT, age INT, height DOUBLE, born DATE);");
+    std::vector<std::string> cities{ "Oslo", "Lima", "Pune" };
+    for (int i = 0; i < 30; ++i) {
+      // some bios are stored in overflow pages
+      std::string bio = i % 10 == 0 ? std::string(1500, 'x') + "engineer" : "likes " + std::string(i % 2 == 0 ? "tea" : "coffee");
+      executor.execute("INSERT INTO citizen VALUES (\"citizen" + std::to_string(i) + "\", \"" + bio + "\", \"" + cities[i % 3] + "\", " +
+        std::to_string(20 + i) + ", " + std::to_string(150 + i) + ".5, \"19" + std::to_string(70 + i) + "-01-01\");");
+    }
+
+    auto count = [&](std::string where) {
+      auto [rows, message] = executor.execute("SELECT * FROM citizen WHERE " + where + ";");
+      INFO(where);
+      REQUIRE(message == "");
+      return rows.size();
+      };
+    REQUIRE(count("citizen.age IN (21, 25, 99)") == 2);
+    REQUIRE(count("citizen.height IN (150.5, 151, 160.5)") == 2);
+    REQUIRE(count("citizen.born IN (\"1975-01-01\", \"1999-01-01\")") == 2);
+    REQUIRE(count("citizen.name IN (\"citizen3\", \"citizen12\", \"nobody\")") == 2);
+    REQUIRE(count("citizen.city IN (\"Lima\", \"Pune\")") == 20);
+    REQUIRE(count("citizen.age IN (20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39) AND citizen.city IN (\"Oslo\")") == 7);
+    REQUIRE(count("citizen.name LIKE \"citizen1%\"") == 11);
+    REQUIRE(count("citizen.name LIKE \"%2\"") == 3);
+    REQUIRE(count("citizen.name LIKE \"citizen_\"") == 10);
+    REQUIRE(count("citizen.bio LIKE \"%coffee%\"") == 15);
+    REQUIRE(count("citizen.bio LIKE \"%engineer\"") == 3);
+    REQUIRE(count("citizen.city LIKE \"%i%\"") == 10);
+    REQUIRE(count("\"abc\" LIKE \"a%\" AND 3 IN (1, 3)") == 30);
+
+    auto [badList, badListMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.age IN (1, \"two\");");
+    REQUIRE(badListMsg == "Cannot compare NUMBER with STRING\n");
+    auto [badDate, badDateMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.born IN (\"soon\");");
+    REQUIRE(badDateMsg == "Invalid DATE: soon\n");
+    auto [badLike, badLikeMsg] = executor.execute("SELECT * FROM citizen WHERE citizen.age LIKE \"2%\";");
+    REQUIRE(badLikeMsg == "Cannot match NUMBER with LIKE\n");
+
+    executor.execute("DELETE FROM citizen WHERE citizen.city IN (\"Oslo\") OR citizen.name LIKE \"%9\";");
+    REQUIRE(count("citizen.age > 0") == 18);
+  }
+}
+
 TEST_CASE("Create two tables, populate them and query a join") {
   DeferDeleteFile deferDeleteFile({ "employees", "departments", "schema" });
   {
@@ -270,10 +944,10 @@ TEST_CASE("Create two tables, populate them and query a join") {
       expectedTuples.push_back(schema.createTuple(tokenList));
     }
 
-    for (int i = 0; i < expectedTuples.size(); i++) {
+    for (u32 i = 0; i < expectedTuples.size(); i++) {
       auto& expectedTuple = expectedTuples[i];
       auto& resultTuple = resultTuples[i];
-      for (int j = 0; j < expectedTuple.fields.size(); j++) {
+      for (u32 j = 0; j < expectedTuple.fields.size(); j++) {
         auto expected = expectedTuple.fields[j]->getConstant();
         auto result = resultTuple.fields[j]->getConstant();
         REQUIRE(expected == result);
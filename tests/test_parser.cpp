@@ -3,6 +3,7 @@
 #include "../src/parser.h"
 #include <vector>
 #include <memory>
+#include <limits>
 
 TEST_CASE("Lexer succeeds for normal query") {
   auto s = R"(SELECT * 
@@ -15,7 +16,7 @@ TEST_CASE("Lexer succeeds for normal query") {
   }
   std::vector<Token> expected = { Token{SELECT, 1}, Token{STAR, 1}, Token{FROM, 2}, Token{IDENTIFIER, 3, "table"}, Token{SEMI_COLON, 3} };
   REQUIRE(tokens.size() == expected.size());
-  for (int i = 0; i < tokens.size(); i++) {
+  for (u32 i = 0; i < tokens.size(); i++) {
     REQUIRE(tokens[i].tokenType == expected[i].tokenType);
     REQUIRE(tokens[i].line == expected[i].line);
     REQUIRE(tokens[i].lexeme == expected[i].lexeme);
@@ -38,7 +39,7 @@ TEST_CASE("Lexer succeeds for more complicated query") {
    Token{DOT, 4}, Token{IDENTIFIER, 4, "schoolId"}, Token{EQUAL, 4}, Token{IDENTIFIER, 4, "school"}, Token{DOT, 4}, Token{IDENTIFIER, 4, "id"}, Token{SEMI_COLON, 4}
   };
   REQUIRE(tokens.size() == expected.size());
-  for (int i = 0; i < tokens.size(); i++) {
+  for (u32 i = 0; i < tokens.size(); i++) {
     //REQUIRE(tokens[i].tokenType == expected[i].tokenType);
      //REQUIRE(tokens[i] == expected[i]);
      //REQUIRE(tokens[i] == expected[i]);
@@ -69,7 +70,7 @@ TEST_CASE("Parser succeeds for 3 table join without parenthesis") {
 
 
   REQUIRE(query.selectFields.size() == expectedSelectList.size());
-  for (int i = 0; i < query.selectFields.size(); i++) {
+  for (u32 i = 0; i < query.selectFields.size(); i++) {
     TableValue* lhs = query.selectFields[i].get();
     TableValue* rhs = expectedSelectList[i];
     REQUIRE(*lhs == rhs);
@@ -116,8 +117,8 @@ TEST_CASE("Parser succeeds for create table") {
   auto schema = parser.parseCreate();
   std::vector<std::string> expectedFieldNames{ "name", "employment", "age" };
   REQUIRE(schema.tableList.at(0) == "citizen");
-  for (int i = 0; i < schema.fieldList.size(); ++i) {
-    REQUIRE(schema.fieldList[i] == expectedFieldNames[i]);
+  for (u32 i = 0; i < schema.fieldList.size(); ++i) {
+    REQUIRE(schema.fieldList[i] == std::string_view(expectedFieldNames[i]));
   }
 
   REQUIRE(dynamic_cast<ReadVarCharField*>(schema.fieldMap["name"].get()) != nullptr);
@@ -140,4 +141,117 @@ TEST_CASE("Parser succeeds for insert into table") {
   REQUIRE(insert.fields[1] == "employment");
   REQUIRE(insert.fields[2] == "age");
   REQUIRE(insert.values.size() == 4);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Parser succeeds for vacuum") {
+  Parser parser("VACUUM citizen;");
+  auto stmt = parser.parseStatement();
+  REQUIRE(std::holds_alternative<VacuumStmt>(stmt));
+  REQUIRE(std::get<VacuumStmt>(stmt).table == "citizen");
+}
+
+TEST_CASE("Parser succeeds for create with fill factor") {
+  Parser parser("CREATE TABLE citizen(name VARCHAR(30), age INT) WITH (FILLFACTOR = 70);");
+  auto stmt = parser.parseStatement();
+  REQUIRE(std::holds_alternative<Schema>(stmt));
+  auto& schema = std::get<Schema>(stmt);
+  REQUIRE(schema.fieldList.size() == 2);
+  REQUIRE(schema.options.fillFactor == 70);
+
+  Parser defaultParser("CREATE TABLE citizen(name VARCHAR(30), age INT);");
+  auto defaultStmt = defaultParser.parseStatement();
+  REQUIRE(std::get<Schema>(defaultStmt).options.fillFactor == 100);
+}
+
+TEST_CASE("Parser succeeds for create with a page layout") {
+  Parser parser("CREATE TABLE readings(id INT, sensor CHAR(12)) WITH (LAYOUT = PAX, FILLFACTOR = 90);");
+  auto stmt = parser.parseStatement();
+  REQUIRE(std::holds_alternative<Schema>(stmt));
+  auto& schema = std::get<Schema>(stmt);
+  REQUIRE(schema.options.layout == PageLayout::PAX);
+  REQUIRE(schema.options.fillFactor == 90);
+
+  Parser rowParser("CREATE TABLE readings(id INT) WITH (LAYOUT = ROW);");
+  REQUIRE(std::get<Schema>(rowParser.parseStatement()).options.layout == PageLayout::ROW);
+
+  // an unknown layout keeps the row layout
+  Parser badParser("CREATE TABLE readings(id INT) WITH (LAYOUT = COLUMNS);");
+  REQUIRE(std::get<Schema>(badParser.parseStatement()).options.layout == PageLayout::ROW);
+}
+
+TEST_CASE("Parser succeeds for truncate") {
+  Parser parser("TRUNCATE TABLE citizen;");
+  auto stmt = parser.parseStatement();
+  REQUIRE(std::holds_alternative<TruncateStmt>(stmt));
+  REQUIRE(std::get<TruncateStmt>(stmt).table == "citizen");
+
+  Parser shortParser("TRUNCATE citizen;");
+  auto shortStmt = shortParser.parseStatement();
+  REQUIRE(std::get<TruncateStmt>(shortStmt).table == "citizen");
+}
+
+TEST_CASE("Parser succeeds for typed columns and literals") {
+  Parser parser("CREATE TABLE events(id BIGINT, price DOUBLE, day DATE, at TIMESTAMP, done BOOLEAN);");
+  auto stmt = parser.parseStatement();
+  REQUIRE(std::holds_alternative<Schema>(stmt));
+  auto& schema = std::get<Schema>(stmt);
+  REQUIRE(dynamic_cast<ReadBigIntField*>(schema.fieldMap["id"].get()) != nullptr);
+  REQUIRE(dynamic_cast<ReadDoubleField*>(schema.fieldMap["price"].get()) != nullptr);
+  REQUIRE(dynamic_cast<ReadDateField*>(schema.fieldMap["day"].get()) != nullptr);
+  REQUIRE(dynamic_cast<ReadTimestampField*>(schema.fieldMap["at"].get()) != nullptr);
+  REQUIRE(dynamic_cast<ReadBoolField*>(schema.fieldMap["done"].get()) != nullptr);
+
+  Lexer lexer("-12 3.25 -0.5 9000000000 TRUE FALSE - 1");
+  std::vector<Token> tokens;
+  while (!lexer.isEOF()) {
+    tokens.push_back(lexer.nextToken());
+  }
+  REQUIRE(tokens.size() == 8);
+  REQUIRE((tokens[0].tokenType == NUMBER && tokens[0].digit == -12));
+  REQUIRE((tokens[1].tokenType == DECIMAL && tokens[1].lexeme == "3.25"));
+  REQUIRE((tokens[2].tokenType == DECIMAL && tokens[2].lexeme == "-0.5"));
+  REQUIRE((tokens[3].tokenType == NUMBER && tokens[3].digit == 9000000000));
+  REQUIRE(tokens[4].tokenType == TRUE_TOKEN);
+  REQUIRE(tokens[5].tokenType == FALSE_TOKEN);
+  // a minus sign that is not in front of a number stays a minus sign
+  REQUIRE(tokens[6].tokenType == MINUS);
+  REQUIRE((tokens[7].tokenType == NUMBER && tokens[7].digit == 1));
+
+  // the whole BIGINT range is read, a literal past it is an error instead of wrapping around
+  Lexer rangeLexer("9223372036854775807 -9223372036854775808 9223372036854775808 123456789012345678901234");
+  std::vector<Token> rangeTokens;
+  while (!rangeLexer.isEOF()) {
+    rangeTokens.push_back(rangeLexer.nextToken());
+  }
+  REQUIRE(rangeTokens.size() == 4);
+  REQUIRE((rangeTokens[0].tokenType == NUMBER && rangeTokens[0].digit == std::numeric_limits<i64>::max()));
+  REQUIRE((rangeTokens[1].tokenType == NUMBER && rangeTokens[1].digit == std::numeric_limits<i64>::min()));
+  REQUIRE((rangeTokens[2].tokenType == ERROR_TOKEN && rangeTokens[2].lexeme == "9223372036854775808"));
+  REQUIRE((rangeTokens[3].tokenType == ERROR_TOKEN && rangeTokens[3].lexeme == "123456789012345678901234"));
+
+  Parser queryParser("SELECT * FROM events WHERE events.price >= 2.5 AND events.done = TRUE;");
+  auto query = queryParser.parseQuery();
+  auto expected = std::make_unique<Predicate>(PredicateOperand::AND,
+    std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::GREATER_EQUAL, std::make_unique<Field>("events", "price"), std::make_unique<Constant>(Constant::fromDouble(2.5)))),
+    std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::EQUAL, std::make_unique<Field>("events", "done"), std::make_unique<Constant>(Constant::boolean(true)))));
+  REQUIRE(query.predicate.size() == 1);
+  REQUIRE(*expected == *query.predicate[0]);
+}
+
+TEST_CASE("Parser succeeds for IN and LIKE") {
+  Parser parser("SELECT * FROM events WHERE events.id IN (1, 2, 3) AND events.name LIKE \"ab%\" OR events.day IN (\"2024-01-05\");");
+  auto query = parser.parseQuery();
+  std::vector<Constant> ids{ Constant(1), Constant(2), Constant(3) };
+  std::vector<Constant> days{ Constant(std::string("2024-01-05")) };
+  auto expected = std::make_unique<Predicate>(PredicateOperand::OR,
+    std::make_unique<Predicate>(PredicateOperand::AND,
+      std::make_unique<Predicate>(std::make_unique<Term>(std::make_unique<Field>("events", "id"), ids)),
+      std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::LIKE, std::make_unique<Field>("events", "name"), std::make_unique<Constant>("ab%")))),
+    std::make_unique<Predicate>(std::make_unique<Term>(std::make_unique<Field>("events", "day"), days)));
+  REQUIRE(query.predicate.size() == 1);
+  REQUIRE(*expected == *query.predicate[0]);
+
+  // the lists are compared value by value
+  std::vector<Constant> otherIds{ Constant(1), Constant(2), Constant(4) };
+  REQUIRE(!(Term(std::make_unique<Field>("events", "id"), ids) == Term(std::make_unique<Field>("events", "id"), otherIds)));
+}
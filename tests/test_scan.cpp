@@ -2,9 +2,11 @@
 
 #include "../src/scan/scan.h"
 #include "../src/scan/SelectScan.h"
+#include "../src/scan/ProjectScan.h"
 #include "../src/scan/TableScan.h"
 #include "./test_utils.h"
 #include "memory"
+#include <random>
 
 
 TEST_CASE("Insert tuple") {
@@ -58,10 +60,10 @@ TEST_CASE("Insert tuple") {
     REQUIRE(readTuples.size() == writeTuples.size());
 
 
-    for (int i = 0; i < writeTuples.size(); i++) {
+    for (u32 i = 0; i < writeTuples.size(); i++) {
       auto& writeTuple = writeTuples[i];
       auto& readTuple = readTuples[i];
-      for (int j = 0; j < writeTuple.fields.size(); j++) {
+      for (u32 j = 0; j < writeTuple.fields.size(); j++) {
         auto writtenConstant = writeTuple.fields[j]->getConstant();
         auto readConstant = readTuple.fields[j]->getConstant();
         REQUIRE(writtenConstant == readConstant);
@@ -86,4 +88,1203 @@ TEST_CASE("Insert tuple") {
   }
 }
 
-// i want to create tuples without the make_unique boiler plate bs.
\ No newline at end of file
+TEST_CASE("Bulk load tuples") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile(fileName);
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    // enough tuples to span several page directories
+    std::vector<Tuple> writeTuples;
+    for (int i = 0; i < 1000; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(i) };
+      writeTuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::bulkLoad(rm, fileName, writeTuples);
+
+    // bulk load keeps the order of the tuples
+    std::unique_ptr<Scan> tableScan = std::make_unique<TableScan>(fileName, rm, schema);
+    std::vector<Tuple> readTuples;
+    tableScan->getFirst();
+    while (tableScan->next()) {
+      readTuples.push_back(tableScan->get());
+    }
+    REQUIRE(readTuples.size() == writeTuples.size());
+    for (u32 i = 0; i < readTuples.size(); ++i) {
+      REQUIRE(readTuples[i].fields[1]->getConstant().num == i);
+    }
+
+    // the new page directories are reachable from the page directory index
+    u32 numberOfTuples = 0;
+    HeapFile::HeapFileIterator iter(fileName, rm);
+    iter.findFirstDir();
+    do {
+      while (iter.nextPageInDir()) {
+        TuplePage* tp = reinterpret_cast<TuplePage*>(iter.getPageBuffer()->bufferData.data());
+        numberOfTuples += tp->numberOfSlots;
+      }
+    } while (iter.nextDir());
+    REQUIRE(numberOfTuples == writeTuples.size());
+  }
+}
+
+TEST_CASE("Insert compacts a fragmented page") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile(fileName);
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    // a single tuple page
+    HeapFile::createHeapFile(*rm, fileName, 1);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadFixedCharField>(34));
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    // fill the page
+    std::vector<Tuple> writeTuples;
+    for (int i = 0; i < 9; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(i) };
+      writeTuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, writeTuples);
+    // the page directory root, the table metadata, the page directory index, the page directory and the tuple page
+    REQUIRE(rm->fm.getNumberOfPages(fileName) == 5);
+
+    // delete every even age, leaving holes between the live tuples
+    {
+      std::unique_ptr<ModifyScan> scan = std::make_unique<ModifyTableScan>(fileName, rm, schema);
+      scan->getFirst();
+      while (scan->next()) {
+        if (scan->get().fields[1]->getConstant().num % 2 == 0) {
+          scan->deleteTuple();
+        }
+      }
+    }
+
+    // the holes are only usable once the page is compacted
+    std::vector<Tuple> moreTuples;
+    for (int i = 9; i < 13; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(i) };
+      moreTuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, moreTuples);
+    REQUIRE(rm->fm.getNumberOfPages(fileName) == 5);
+
+    std::vector<int> ages;
+    TableScan tableScan(fileName, rm, schema);
+    tableScan.getFirst();
+    while (tableScan.next()) {
+      auto tuple = tableScan.get();
+      REQUIRE(tuple.fields[0]->getConstant() == Constant("employee" + std::to_string(tuple.fields[1]->getConstant().num)));
+      ages.push_back(tuple.fields[1]->getConstant().num);
+    }
+    std::sort(begin(ages), end(ages));
+    REQUIRE(ages == std::vector<int>{ 1, 3, 5, 7, 9, 10, 11, 12 });
+
+    // free space of the page matches the page directory
+    HeapFile::HeapFileIterator iter(fileName, rm);
+    iter.findFirstDir();
+    REQUIRE(iter.nextPageInDir());
+    TuplePage* tp = reinterpret_cast<TuplePage*>(iter.getPageBuffer()->bufferData.data());
+    PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(iter.getPageDirBuffer()->bufferData.data() + sizeof(PageDirectory));
+    REQUIRE(pageEntryList[0].freeSpace == tp->contiguousFreeSpace());
+  }
+}
+
+TEST_CASE("Repeated inserts continue from the insert hint") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile(fileName);
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadFixedCharField>(40));
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    // single row inserts, enough to need several page directories
+    for (int i = 0; i < 500; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(i) };
+      std::vector<Tuple> tuples;
+      tuples.push_back(schema.createTuple(tokens));
+      HeapFile::insertTuples(rm, fileName, tuples);
+    }
+
+    // the hint points at the page the last row went into
+    REQUIRE(rm->insertHints.count(fileName) == 1);
+    auto hint = rm->insertHints.at(fileName);
+    REQUIRE(hint.directoryIndex != 0);
+    {
+      HeapFile::HeapFileIterator iter(fileName, rm, hint);
+      PageEntry* pageEntryList = reinterpret_cast<PageEntry*>(iter.getPageDirBuffer()->bufferData.data() + sizeof(PageDirectory));
+      TableScan lastPage(fileName, rm, schema);
+      u32 numberOfRows = 0;
+      lastPage.getFirst();
+      while (lastPage.next()) {
+        numberOfRows++;
+      }
+      REQUIRE(numberOfRows == 500);
+      REQUIRE(pageEntryList[hint.pageEntryIndex].freeSpace < TEST_PAGE_SIZE - TuplePage::headerSize(TEST_PAGE_SIZE));
+    }
+
+    // deleting gives space back, so the hint is dropped and the space is reused
+    {
+      std::unique_ptr<ModifyScan> scan = std::make_unique<ModifyTableScan>(fileName, rm, schema);
+      scan->getFirst();
+      for (int i = 0; i < 2; ++i) {
+        scan->next();
+        scan->deleteTuple();
+      }
+    }
+    REQUIRE(rm->insertHints.count(fileName) == 0);
+
+    u32 numberOfPages = rm->fm.getNumberOfPages(fileName);
+    std::vector<Token> tokens{ ttoken("employee500"), ttoken(500) };
+    std::vector<Tuple> tuples;
+    tuples.push_back(schema.createTuple(tokens));
+    HeapFile::insertTuples(rm, fileName, tuples);
+    REQUIRE(rm->fm.getNumberOfPages(fileName) == numberOfPages);
+    REQUIRE(rm->insertHints.at(fileName).directoryIndex == 0);
+  }
+}
+
+// i want to create tuples without the make_unique boiler plate bs.
+TEST_CASE("Large values are stored in overflow pages") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile({ fileName, HeapFile::overflowFilename(fileName) });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "bio", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    // values larger than a page, larger than a quarter of a page and small ones
+    auto bio = [](int i) {
+      return std::string(i % 3 == 0 ? 2000 : i % 3 == 1 ? 200 : 10, 'a' + i % 26);
+      };
+    std::vector<Tuple> insertTuples;
+    std::vector<Tuple> loadTuples;
+    for (int i = 0; i < 30; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(bio(i)), ttoken(i) };
+      (i < 15 ? insertTuples : loadTuples).push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, insertTuples);
+    HeapFile::bulkLoad(rm, fileName, loadTuples);
+    REQUIRE(rm->fm.doesFileExists(HeapFile::overflowFilename(fileName)));
+
+    std::unique_ptr<Scan> tableScan = std::make_unique<TableScan>(fileName, rm, schema);
+    u32 numberOfTuples = 0;
+    tableScan->getFirst();
+    while (tableScan->next()) {
+      auto tuple = tableScan->get();
+      int age = tuple.fields[2]->getConstant().num;
+      REQUIRE(tuple.fields[0]->getConstant() == Constant("employee" + std::to_string(age)));
+      REQUIRE(tuple.fields[1]->getConstant() == Constant(bio(age)));
+      REQUIRE(tuple.recordSize < TEST_PAGE_SIZE);
+      numberOfTuples++;
+    }
+    REQUIRE(numberOfTuples == 30);
+  }
+}
+
+TEST_CASE("Page entries are reached through the page directory index") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile(fileName);
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadFixedCharField>(40));
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    // enough rows for several page directories, through both insert paths
+    std::vector<Tuple> insertTuples;
+    std::vector<Tuple> loadTuples;
+    for (int i = 0; i < 800; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(i) };
+      (i < 400 ? insertTuples : loadTuples).push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, insertTuples);
+    HeapFile::bulkLoad(rm, fileName, loadTuples);
+    REQUIRE(HeapFile::numberOfPageDirectories(*rm, fileName) > 2);
+
+    // every tuple page can be found from its page number and from its page index
+    u32 entriesPerDirectory = PageDirectory::entriesPerDirectory(TEST_PAGE_SIZE);
+    u32 numberOfTuplePages = 0;
+    HeapFile::HeapFileIterator seekIter(fileName, rm);
+    for (u64 pageNumber = 0; pageNumber < rm->fm.getNumberOfPages(fileName); ++pageNumber) {
+      BufferFrame* frame = rm->bm.pin(rm->fm, PageId{ fileName, pageNumber });
+      TuplePage tp = *reinterpret_cast<TuplePage*>(frame->bufferData.data());
+      rm->bm.unpin(rm->fm, PageId{ fileName, pageNumber });
+      if (tp.pageType != PageType::TuplePage) {
+        REQUIRE(!seekIter.seekPage(pageNumber));
+        continue;
+      }
+      numberOfTuplePages++;
+
+      REQUIRE(seekIter.seekPage(pageNumber));
+      REQUIRE(seekIter.getPageBuffer()->pageId.pageNumber == pageNumber);
+      REQUIRE(seekIter.getDirectoryIndex() * entriesPerDirectory + seekIter.getPageEntryIndex() == tp.pageIndex);
+
+      REQUIRE(seekIter.seekPageIndex(tp.pageIndex));
+      REQUIRE(seekIter.getPageBuffer()->pageId.pageNumber == pageNumber);
+    }
+
+    // the same pages the directory walk visits
+    u32 numberOfEntries = 0;
+    HeapFile::HeapFileIterator iter(fileName, rm);
+    iter.findFirstDir();
+    do {
+      while (iter.nextPageInDir()) {
+        numberOfEntries++;
+      }
+    } while (iter.nextDir());
+    REQUIRE(numberOfEntries == numberOfTuplePages);
+  }
+}
+
+TEST_CASE("Page directories are found through more than one page directory index") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile(fileName);
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName, 0);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadFixedCharField>(300));
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+    auto makeTuples = [&schema](int from, int to) {
+      std::vector<Tuple> tuples;
+      for (int i = from; i < to; ++i) {
+        std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(i) };
+        tuples.push_back(schema.createTuple(tokens));
+      }
+      return tuples;
+    };
+
+    // a bulk load fills the page directory that is only partly filled before adding another one
+    auto firstTuples = makeTuples(0, 3);
+    HeapFile::bulkLoad(rm, fileName, firstTuples);
+    auto secondTuples = makeTuples(3, 6);
+    HeapFile::bulkLoad(rm, fileName, secondTuples);
+    REQUIRE(HeapFile::numberOfPageDirectories(*rm, fileName) == 1);
+    {
+      HeapFile::HeapFileIterator iter(fileName, rm);
+      iter.findFirstDir();
+      REQUIRE(reinterpret_cast<PageDirectory*>(iter.getPageDirBuffer()->bufferData.data())->numberOfEntries == 6);
+    }
+
+    // one row per page, more page directories than a page directory index holds
+    u32 entriesPerDirectory = PageDirectory::entriesPerDirectory(TEST_PAGE_SIZE);
+    int numberOfRows = (int)((PageDirectoryIndex::capacity(TEST_PAGE_SIZE) + 2) * entriesPerDirectory);
+    auto manyTuples = makeTuples(6, numberOfRows);
+    HeapFile::bulkLoad(rm, fileName, manyTuples);
+    REQUIRE(HeapFile::numberOfPageDirectories(*rm, fileName) > PageDirectoryIndex::capacity(TEST_PAGE_SIZE));
+    auto insertedTuples = makeTuples(numberOfRows, numberOfRows + 40);
+    HeapFile::insertTuples(rm, fileName, insertedTuples);
+
+    // every page directory is full but the last one, and every row is found, the bulk loaded ones in order
+    u64 numberOfDirectories = HeapFile::numberOfPageDirectories(*rm, fileName);
+    for (u64 d = 0; d + 1 < numberOfDirectories; ++d) {
+      PageId directoryId{ fileName, HeapFile::getPageDirectory(*rm, fileName, d) };
+      BufferFrame* frame = rm->bm.pin(rm->fm, directoryId);
+      PageDirectory* pd = reinterpret_cast<PageDirectory*>(frame->bufferData.data());
+      REQUIRE(pd->directoryIndex == d);
+      REQUIRE(pd->numberOfEntries == entriesPerDirectory);
+      rm->bm.unpin(rm->fm, directoryId);
+    }
+    TableScan tableScan(fileName, rm, schema);
+    tableScan.getFirst();
+    int expected = 0;
+    while (tableScan.next()) {
+      int age = tableScan.get().fields[1]->getConstant().num;
+      REQUIRE((age == expected || (expected >= numberOfRows && age >= numberOfRows)));
+      expected++;
+    }
+    REQUIRE(expected == numberOfRows + 40);
+  }
+}
+
+TEST_CASE("Fetch, update and erase rows by RID") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile(fileName);
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    std::vector<Tuple> writeTuples;
+    for (int i = 0; i < 100; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken(i) };
+      writeTuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, writeTuples);
+
+    // scans report the RID of every row
+    std::vector<RID> rids(100);
+    {
+      TableScan tableScan(fileName, rm, schema);
+      tableScan.getFirst();
+      while (tableScan.next()) {
+        rids[tableScan.get().fields[1]->getConstant().num] = tableScan.getRid();
+      }
+    }
+    for (int i = 0; i < 100; ++i) {
+      auto tuple = HeapFile::fetch(rm, fileName, schema, rids[i]);
+      REQUIRE(tuple.fields[0]->getConstant() == Constant("employee" + std::to_string(i)));
+      REQUIRE(tuple.fields[1]->getConstant().num == i);
+    }
+
+    // a row that outgrows its page keeps its RID
+    std::vector<Token> grownTokens{ ttoken(std::string(100, 'x')), ttoken(7) };
+    auto grownTuple = schema.createTuple(grownTokens);
+    HeapFile::update(rm, fileName, schema, rids[7], grownTuple);
+    REQUIRE(HeapFile::fetch(rm, fileName, schema, rids[7]).fields[0]->getConstant() == Constant(std::string(100, 'x')));
+
+    std::vector<Token> shrunkTokens{ ttoken("e"), ttoken(8) };
+    auto shrunkTuple = schema.createTuple(shrunkTokens);
+    HeapFile::update(rm, fileName, schema, rids[8], shrunkTuple);
+    REQUIRE(HeapFile::fetch(rm, fileName, schema, rids[8]).fields[0]->getConstant().str == "e");
+
+    // the scan reports the original RID of the moved row
+    {
+      std::unique_ptr<ModifyScan> scan = std::make_unique<ModifyTableScan>(fileName, rm, schema);
+      scan->getFirst();
+      u32 numberOfRows = 0;
+      while (scan->next()) {
+        RID rid = scan->getRid();
+        int age = scan->get().fields[1]->getConstant().num;
+        REQUIRE(rid.pageNumber == rids[age].pageNumber);
+        REQUIRE(rid.slotNumber == rids[age].slotNumber);
+        numberOfRows++;
+      }
+      REQUIRE(numberOfRows == 100);
+    }
+
+    HeapFile::erase(rm, fileName, schema, rids[7]);
+    REQUIRE_THROWS(HeapFile::fetch(rm, fileName, schema, rids[7]));
+    REQUIRE_THROWS(HeapFile::erase(rm, fileName, schema, rids[7]));
+    REQUIRE_THROWS(HeapFile::fetch(rm, fileName, schema, RID{ 0, 0 }));
+    REQUIRE_THROWS(HeapFile::fetch(rm, fileName, schema, RID{ 1000, 0 }));
+
+    u32 numberOfRows = 0;
+    TableScan tableScan(fileName, rm, schema);
+    tableScan.getFirst();
+    while (tableScan.next()) {
+      numberOfRows++;
+    }
+    REQUIRE(numberOfRows == 99);
+
+    // the page entries were kept in sync with the pages they describe
+    HeapFile::HeapFileIterator iter(fileName, rm);
+    iter.findFirstDir();
+    do {
+      while (iter.nextPageInDir()) {
+        PageEntry pageEntry = reinterpret_cast<PageEntry*>(iter.getPageDirBuffer()->bufferData.data() + sizeof(PageDirectory))[iter.getPageEntryIndex()];
+        REQUIRE(HeapFile::compactTuplePage(iter.getPageBuffer()) == pageEntry.freeSpace);
+      }
+    } while (iter.nextDir());
+  }
+}
+
+TEST_CASE("Rows are filtered and projected in place through a tuple view") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile({ fileName, HeapFile::overflowFilename(fileName) });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+    schema.addField(fileName, "bio", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    auto bio = [](int i) {
+      return std::string(i % 10 == 0 ? 2000 : 10, 'a' + i % 26);
+      };
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 50; ++i) {
+      std::vector<Token> tokens{ ttoken("employee" + std::to_string(i)), ttoken("Engineer"), ttoken(bio(i)), ttoken(i) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, tuples);
+
+    // grow a row until it is forwarded to another page
+    RID forwardedRid;
+    {
+      TableScan tableScan(fileName, rm, schema);
+      tableScan.getFirst();
+      tableScan.next();
+      forwardedRid = tableScan.getRid();
+    }
+    Tuple grown = HeapFile::fetch(rm, fileName, schema, forwardedRid);
+    grown.set(0, std::make_unique<VarCharField>(std::string(100, 'z')));
+    HeapFile::update(rm, fileName, schema, forwardedRid, grown);
+
+    // the view decodes the same row as get
+    {
+      TableScan tableScan(fileName, rm, schema);
+      tableScan.getFirst();
+      while (tableScan.next()) {
+        RID rid = tableScan.getRid();
+        auto view = tableScan.getView();
+        REQUIRE(view.isInPlace() == !(rid.pageNumber == forwardedRid.pageNumber && rid.slotNumber == forwardedRid.slotNumber));
+        auto tuple = tableScan.get();
+        REQUIRE(view.getConstant(3) == tuple.fields[3]->getConstant());
+        REQUIRE(view.getConstant(2) == tuple.fields[2]->getConstant());
+        auto materialized = view.materialize();
+        REQUIRE(materialized.recordSize == tuple.recordSize);
+        for (u32 i = 0; i < tuple.fields.size(); ++i) {
+          REQUIRE(materialized.fields[i]->getConstant() == tuple.fields[i]->getConstant());
+        }
+      }
+    }
+
+    // SELECT bio, name FROM employee WHERE age >= 20 AND employment = 'Engineer'
+    std::unique_ptr<Scan> scan = std::make_unique<TableScan>(fileName, rm, schema);
+    auto predicate = std::make_unique<Predicate>(PredicateOperand::AND,
+      std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::GREATER_EQUAL, std::make_unique<Field>(fileName, "age"), std::make_unique<Constant>(20))),
+      std::make_unique<Predicate>(std::make_unique<Term>(TermOperand::EQUAL, std::make_unique<Field>(fileName, "employment"), std::make_unique<Constant>("Engineer"))));
+    scan = std::make_unique<SelectScan>(std::move(scan), std::move(predicate));
+    std::vector<std::unique_ptr<TableValue>> fields;
+    fields.push_back(std::make_unique<Field>(fileName, "bio"));
+    fields.push_back(std::make_unique<Field>(fileName, "name"));
+    scan = std::make_unique<ProjectScan>(std::move(scan), fields);
+
+    std::vector<int> ages;
+    scan->getFirst();
+    while (scan->next()) {
+      auto tuple = scan->get();
+      REQUIRE(tuple.fields.size() == 2);
+      std::string name(tuple.fields[1]->getConstant().str);
+      int age = std::stoi(name.substr(std::string("employee").size()));
+      REQUIRE(tuple.fields[0]->getConstant() == Constant(bio(age)));
+      ages.push_back(age);
+    }
+    REQUIRE(ages.size() == 30);
+    REQUIRE(*std::min_element(begin(ages), end(ages)) == 20);
+  }
+}
+
+TEST_CASE("Row header locates every column of a stored row") {
+  Schema schema;
+  schema.addField("wide", "id", std::make_unique<ReadIntField>());
+  for (int i = 0; i < 10; ++i) {
+    schema.addField("wide", "note" + std::to_string(i), std::make_unique<ReadVarCharField>());
+  }
+  schema.addField("wide", "code", std::make_unique<ReadFixedCharField>(8));
+  schema.addField("wide", "age", std::make_unique<ReadIntField>());
+
+  std::vector<Token> tokens{ ttoken(7) };
+  for (int i = 0; i < 10; ++i) {
+    tokens.push_back(ttoken(std::string(i * 3, 'n')));
+  }
+  tokens.push_back(ttoken("abc"));
+  tokens.push_back(ttoken(42));
+  Tuple tuple = schema.createTuple(tokens);
+
+  u32 numberOfColumns = (u32)tuple.fields.size();
+  u32 dataSize = 0;
+  for (auto& field : tuple.fields) {
+    dataSize += field->getLength();
+  }
+  REQUIRE(tuple.recordSize == RowHeader::size(numberOfColumns) + dataSize);
+
+  std::vector<char> buffer(tuple.recordSize + 10, 'x');
+  tuple.write(buffer.data(), 10);
+  const char* row = buffer.data() + 10;
+
+  // columns are laid out in order right after the header
+  u32 expectedOffset = RowHeader::size(numberOfColumns);
+  for (u32 i = 0; i < numberOfColumns; ++i) {
+    REQUIRE(RowHeader::columnOffset(row, i) == expectedOffset);
+    REQUIRE_FALSE(RowHeader::isNull(row, numberOfColumns, i));
+    expectedOffset += tuple.fields[i]->getLength();
+  }
+
+  // the last column is read directly
+  std::shared_ptr<HeapFileSource> source;
+  auto readFields = schema.getReadFields();
+  TupleView view(buffer.data(), 10, readFields, source);
+  REQUIRE(view.getConstant(numberOfColumns - 1) == Constant(42));
+  REQUIRE(view.getConstant(numberOfColumns - 2) == Constant("abc"));
+  REQUIRE(view.getConstant(5) == Constant(std::string(12, 'n')));
+}
+
+TEST_CASE("Fixed width schemas are read and written through a row codec") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile(fileName);
+  {
+    Schema schema;
+    schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+    schema.addField(fileName, "employment", std::make_unique<ReadFixedCharField>(20));
+    schema.addField(fileName, "age", std::make_unique<ReadIntField>());
+
+    // only schemas of fixed width columns get a codec
+    auto codec = RowCodec::create(schema);
+    REQUIRE(codec != nullptr);
+    Schema varCharSchema;
+    varCharSchema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+    varCharSchema.addField(fileName, "age", std::make_unique<ReadIntField>());
+    REQUIRE(RowCodec::create(varCharSchema) == nullptr);
+
+    // the codec writes the same bytes as the generic row format
+    std::vector<Token> tokens{ ttoken(1), ttoken("Engineer"), ttoken(30) };
+    Tuple tuple = schema.createTuple(tokens);
+    REQUIRE(codec->getRecordSize() == tuple.recordSize);
+    std::vector<char> generic(tuple.recordSize), encoded(tuple.recordSize);
+    tuple.write(generic.data(), 0);
+    codec->encode(tuple, encoded.data(), 0);
+    REQUIRE(generic == encoded);
+
+    Tuple decoded = codec->decode(encoded.data());
+    REQUIRE(decoded.recordSize == tuple.recordSize);
+    for (u32 i = 0; i < tuple.fields.size(); ++i) {
+      REQUIRE(decoded.fields[i]->getConstant() == tuple.fields[i]->getConstant());
+    }
+
+    // a codec with every column kind and length in its type writes the same rows, and decodes them in
+    // place into the fields of one tuple
+    FixedRowCodec<Int, Char<20>, Int> staticCodec;
+    REQUIRE(staticCodec.getRecordSize() == tuple.recordSize);
+    std::vector<char> staticEncoded(tuple.recordSize);
+    staticCodec.encode(tuple, staticEncoded.data(), 0);
+    REQUIRE(staticEncoded == generic);
+
+    Tuple reused = staticCodec.makeTuple();
+    WriteField* firstField = reused.fields[0].get();
+    for (int i = 0; i < 3; ++i) {
+      std::vector<Token> rowTokens{ ttoken(i), ttoken("Manager" + std::to_string(i)), ttoken(40 + i) };
+      Tuple row = schema.createTuple(rowTokens);
+      staticCodec.encode(row, staticEncoded.data(), 0);
+      staticCodec.decode(staticEncoded.data(), reused);
+      REQUIRE(reused.fields[0].get() == firstField);
+      REQUIRE(reused.fields[0]->getConstant().num == i);
+      REQUIRE(reused.fields[1]->getConstant() == Constant("Manager" + std::to_string(i)));
+      REQUIRE(reused.fields[2]->getConstant().num == 40 + i);
+    }
+
+    // rows inserted with the codec are read back by the scan
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 100; ++i) {
+      std::vector<Token> rowTokens{ ttoken(i), ttoken("job" + std::to_string(i % 7)), ttoken(i * 2) };
+      tuples.push_back(schema.createTuple(rowTokens));
+    }
+    HeapFile::insertTuples(rm, fileName, tuples, codec.get());
+
+    std::vector<int> ids;
+    TableScan tableScan(fileName, rm, schema);
+    tableScan.getFirst();
+    while (tableScan.next()) {
+      auto row = tableScan.get();
+      int id = row.fields[0]->getConstant().num;
+      REQUIRE(row.fields[1]->getConstant() == Constant("job" + std::to_string(id % 7)));
+      REQUIRE(row.fields[2]->getConstant().num == id * 2);
+      ids.push_back(id);
+    }
+    REQUIRE(ids.size() == 100);
+  }
+}
+
+TEST_CASE("Every schema of INT and CHAR columns gets a row codec") {
+  std::string fileName = "employee";
+  std::vector<std::vector<u32>> shapes{
+    { 0, 0 },
+    { 8, 0, 4, 0 },
+    { 3 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+  };
+  // 0 is an INT column, any other length a CHAR column of that length
+  for (auto& shape : shapes) {
+    Schema schema;
+    std::vector<Token> tokens;
+    for (u32 i = 0; i < shape.size(); ++i) {
+      std::string name = "c" + std::to_string(i);
+      if (shape[i] == 0) {
+        schema.addField(fileName, name, std::make_unique<ReadIntField>());
+        tokens.push_back(ttoken((int)i * 7 - 3));
+      }
+      else {
+        schema.addField(fileName, name, std::make_unique<ReadFixedCharField>(shape[i]));
+        tokens.push_back(ttoken(std::string(shape[i] - 1, 'a' + i)));
+      }
+    }
+    auto codec = RowCodec::create(schema);
+    REQUIRE(codec != nullptr);
+
+    Tuple tuple = schema.createTuple(tokens);
+    REQUIRE(codec->getRecordSize() == tuple.recordSize);
+    std::vector<char> generic(tuple.recordSize), encoded(tuple.recordSize);
+    tuple.write(generic.data(), 0);
+    codec->encode(tuple, encoded.data(), 0);
+    REQUIRE(generic == encoded);
+
+    // rows are decoded into the fields of one tuple
+    Tuple decoded = codec->makeTuple();
+    WriteField* firstField = decoded.fields[0].get();
+    codec->decode(encoded.data(), decoded);
+    REQUIRE(decoded.fields[0].get() == firstField);
+    for (u32 i = 0; i < tuple.fields.size(); ++i) {
+      REQUIRE(decoded.fields[i]->getConstant() == tuple.fields[i]->getConstant());
+    }
+  }
+}
+
+TEST_CASE("Fields created in an arena scope live in the arena") {
+  QueryArena arena;
+  std::unique_ptr<WriteField> heapField = std::make_unique<IntField>(-1);
+
+  for (int round = 0; round < 3; ++round) {
+    {
+      ArenaScope arenaScope(arena);
+      REQUIRE(ArenaScope::getCurrent() == &arena);
+      std::vector<std::unique_ptr<WriteField>> fields;
+      for (int i = 0; i < 10000; ++i) {
+        fields.push_back(std::make_unique<VarCharField>("value" + std::to_string(i)));
+      }
+      Tuple tuple(std::move(fields));
+      REQUIRE(tuple.fields[9999]->getConstant() == Constant("value9999"));
+
+      // the containers of rows, constants and schemas take their memory from the arena too
+      REQUIRE(tuple.fields.get_allocator().resource() == arena.getResource());
+      Constant constant("a string too long to be stored inline");
+      REQUIRE(constant.str.get_allocator().resource() == arena.getResource());
+      REQUIRE(Constant(constant).str.get_allocator().resource() == arena.getResource());
+      Schema schema;
+      schema.addField("employee", "name", std::make_unique<ReadVarCharField>());
+      REQUIRE(schema.fieldList.get_allocator().resource() == arena.getResource());
+      REQUIRE(Schema(schema).fieldMap.get_allocator().resource() == arena.getResource());
+
+      // objects that outlive the arena are made from the heap
+      ArenaScope heapScope(nullptr);
+      Tuple heapTuple(std::vector<std::unique_ptr<WriteField>>{});
+      REQUIRE(heapTuple.fields.get_allocator().resource() == std::pmr::get_default_resource());
+    }
+    REQUIRE(ArenaScope::getCurrent() == nullptr);
+    arena.release();
+  }
+
+  // fields made outside of the scope are freed normally, no field carries a header
+  REQUIRE(heapField->getConstant() == Constant(-1));
+  heapField.reset();
+  REQUIRE(sizeof(IntField) == 16);
+}
+
+TEST_CASE("Values compare like the constants they stand for") {
+  REQUIRE(sizeof(Value) == 16);
+
+  // short, exactly inline, long and strings sharing a prefix
+  std::vector<Constant> constants{ Constant(-5), Constant(0), Constant(42), Constant(""), Constant("a"), Constant("abcd"),
+    Constant("abcde"), Constant("abcdefghijkl"), Constant("abcdefghijkm"), Constant("abcdefghijklm"),
+    Constant("abcdefghijklmnopqrstuvwxyz"), Constant("abcdefghijklmnopqrstuvwxyZ"), Constant("b") };
+
+  for (auto& lhs : constants) {
+    for (auto& rhs : constants) {
+      Value lhsValue = lhs.getValue();
+      Value rhsValue = rhs.getValue();
+      REQUIRE((lhsValue == rhsValue) == (lhs == rhs));
+      REQUIRE((lhsValue != rhsValue) == (lhs != rhs));
+      REQUIRE((lhsValue < rhsValue) == (lhs < rhs));
+      REQUIRE((lhsValue <= rhsValue) == (lhs <= rhs));
+      REQUIRE((lhsValue > rhsValue) == (lhs > rhs));
+      REQUIRE((lhsValue >= rhsValue) == (lhs >= rhs));
+    }
+  }
+
+  // long strings point to their owner, short ones are copied
+  std::string longString(40, 'x');
+  Value longValue(longString);
+  REQUIRE(longValue.getString().data() == longString.data());
+  std::string shortString = "short";
+  Value shortValue(shortString);
+  shortString[0] = 'S';
+  REQUIRE(shortValue.getString() == "short");
+  REQUIRE(Value(7).getType() == ValueType::NUMBER);
+  REQUIRE(Value(7).getNumber() == 7);
+}
+
+TEST_CASE("Dictionary values are stored and compared as codes") {
+  std::string fileName = "employee";
+  DeferDeleteFile deferDeleteFile({ fileName, HeapFile::dictionaryFilename(fileName) });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "name", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "employment", std::make_unique<ReadDictField>());
+
+    // more values than fit in one dictionary page
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 300; ++i) {
+      std::vector<Token> tokens{ ttoken("citizen" + std::to_string(i)), ttoken("employment number " + std::to_string(i % 60)) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, tuples);
+    REQUIRE(rm->fm.getNumberOfPages(HeapFile::dictionaryFilename(fileName)) > 1);
+    auto dictionary = HeapFile::getDictionary(*rm, fileName);
+    REQUIRE(dictionary->size() == 60);
+
+    // the row holds the 2 byte code
+    TableScan scan(fileName, rm, schema);
+    scan.getFirst();
+    REQUIRE(scan.next());
+    auto row = scan.getView();
+    Value employment = row.getValue(1);
+    REQUIRE(employment.isCode());
+    REQUIRE(employment.getDictionary() == dictionary.get());
+    REQUIRE(employment.getString() == row.getConstant(1).str);
+
+    // codes of one dictionary compare by code, anything else by the string
+    u32 code = dictionary->find("employment number 7");
+    REQUIRE(Value(*dictionary, code) == Value(*dictionary, code));
+    REQUIRE(Value(*dictionary, code) != Value(*dictionary, dictionary->find("employment number 8")));
+    REQUIRE(Value(*dictionary, code) != Value(*dictionary, Dictionary::NO_CODE));
+    REQUIRE(Value(*dictionary, code) == Value(std::string_view("employment number 7")));
+    REQUIRE(Value(*dictionary, code) < Value(std::string_view("employment number 8")));
+    REQUIRE(Value(*dictionary, code) != Value(7));
+
+    // the dictionary is read back from its file in the same order
+    rm->bm.flush(rm->fm, HeapFile::dictionaryFilename(fileName));
+    rm->dictionaries.clear();
+    auto reloaded = HeapFile::getDictionary(*rm, fileName);
+    REQUIRE(reloaded.get() != dictionary.get());
+    REQUIRE(reloaded->size() == 60);
+    for (u32 i = 0; i < reloaded->size(); ++i) {
+      REQUIRE(reloaded->decode(i) == dictionary->decode(i));
+    }
+  }
+}
+
+TEST_CASE("Dates and timestamps are stored as integers") {
+  REQUIRE(DateTime::parseDate("1970-01-01") == 0);
+  REQUIRE(DateTime::parseDate("2024-02-29") == 19782);
+  REQUIRE(!DateTime::parseDate("2023-02-29"));
+  REQUIRE(!DateTime::parseDate("2024-1-01"));
+  REQUIRE(DateTime::parseTimestamp("1970-01-02") == DateTime::MICROSECONDS_PER_DAY);
+  REQUIRE(DateTime::parseTimestamp("1970-01-01 00:00:01.5") == 1500000);
+  REQUIRE(DateTime::parseTimestamp("1970-01-01T01:00:00") == 3600 * DateTime::MICROSECONDS_PER_SECOND);
+  REQUIRE(!DateTime::parseTimestamp("1970-01-01 24:00:00"));
+  REQUIRE(!DateTime::parseTimestamp("1970-01-01 00:00:00."));
+
+  for (std::string text : { "1969-12-31 23:59:59.999999", "2024-02-29 13:45:07", "2038-01-19 03:14:08.000250" }) {
+    REQUIRE(DateTime::formatTimestamp(*DateTime::parseTimestamp(text)) == text);
+  }
+  REQUIRE(DateTime::formatDate(-1) == "1969-12-31");
+
+  // a string is read as the date or timestamp it is compared with
+  Constant day = Constant::date(*DateTime::parseDate("2024-03-01"));
+  REQUIRE(day == Constant("2024-03-01"));
+  REQUIRE(day > Constant("2024-02-29"));
+  REQUIRE(Constant("2024-03-02") > day);
+  REQUIRE(!(day == Constant("not a date")));
+  REQUIRE(day != Constant(19783));
+  REQUIRE(Constant::timestamp(1500000) < Constant("1970-01-01 00:00:02"));
+
+  // numbers and doubles compare with each other, booleans only with booleans
+  REQUIRE(Constant(3) < Constant::fromDouble(3.5));
+  REQUIRE(Constant::fromDouble(3.0) == Constant(3));
+  REQUIRE(Value(3) < Value::fromDouble(3.5));
+  REQUIRE(Value::fromDouble(3.0) == Value(3));
+  REQUIRE(Constant::boolean(true) != Constant(1));
+  REQUIRE(Value::boolean(true) != Value(1));
+  REQUIRE(Value::boolean(false) < Value::boolean(true));
+
+  // dates and timestamps are tagged integers, never equal to a plain number
+  REQUIRE(day.getValue().getType() == ValueType::DATE);
+  REQUIRE(day.getValue().getNumber() == day.num);
+  REQUIRE(day.getValue() != Value(day.num));
+  REQUIRE(Value::timestamp(5) < Value::timestamp(6));
+  REQUIRE(Value::fromDouble(-0.25).getDouble() == -0.25);
+}
+
+TEST_CASE("Fields are resolved to a column index once per schema") {
+  Schema schema;
+  schema.addField("employee", "name", std::make_unique<ReadVarCharField>());
+  schema.addField("employee", "age", std::make_unique<ReadIntField>());
+  schema.addField("company", "name", std::make_unique<ReadVarCharField>());
+
+  REQUIRE(Field("employee", "age").resolve(schema) == 1u);
+  REQUIRE(Field("company", "name").resolve(schema) == 2u);
+  // without a table the first column of that name is taken
+  REQUIRE(Field("name").resolve(schema) == 0u);
+  REQUIRE(!Field("employee", "salary").resolve(schema));
+
+  Field age("employee", "age");
+  REQUIRE(age.bind(schema) == ConstantType::NUMBER);
+  std::vector<Token> tokens{ ttoken("citizen"), ttoken(42), ttoken("toy") };
+  Tuple tuple = schema.createTuple(tokens);
+  REQUIRE(age.getConstant(tuple, schema).num == 42);
+  Field salary("employee", "salary");
+  REQUIRE_THROWS_AS(salary.getConstant(tuple, schema), BindError);
+
+  Predicate mismatch(std::make_unique<Term>(TermOperand::EQUAL, std::make_unique<Field>("employee", "age"), std::make_unique<Constant>("old")));
+  REQUIRE_THROWS_AS(mismatch.bind(schema), BindError);
+  Predicate join(std::make_unique<Term>(TermOperand::EQUAL, std::make_unique<Field>("employee", "name"), std::make_unique<Field>("company", "name")));
+  REQUIRE_NOTHROW(join.bind(schema));
+}
+
+TEST_CASE("Compiled predicates agree with the predicate tree") {
+  std::string fileName = "readings";
+  DeferDeleteFile deferDeleteFile({ fileName, HeapFile::overflowFilename(fileName), HeapFile::dictionaryFilename(fileName) });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+    schema.addField(fileName, "big", std::make_unique<ReadBigIntField>());
+    schema.addField(fileName, "level", std::make_unique<ReadDoubleField>());
+    schema.addField(fileName, "day", std::make_unique<ReadDateField>());
+    schema.addField(fileName, "at", std::make_unique<ReadTimestampField>());
+    schema.addField(fileName, "sensor", std::make_unique<ReadFixedCharField>(8));
+    schema.addField(fileName, "note", std::make_unique<ReadVarCharField>());
+    schema.addField(fileName, "site", std::make_unique<ReadDictField>());
+
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 60; ++i) {
+      std::string day = "2024-01-" + std::string(i % 28 < 9 ? "0" : "") + std::to_string(i % 28 + 1);
+      // some notes are stored in overflow pages
+      std::string note = i % 10 == 0 ? std::string(2000, 'a' + i % 26) : "note" + std::to_string(i % 7);
+      std::vector<Token> tokens{ ttoken(i), ttoken(i * 1000), Token{ DECIMAL, 0, std::to_string(i % 10) + ".5" }, ttoken(day),
+        ttoken(day + " 0" + std::to_string(i % 10) + ":30:00"), ttoken("s" + std::to_string(i % 4)), ttoken(note), ttoken("site" + std::to_string(i % 3)) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, tuples);
+
+    std::vector<std::string> whereClauses{
+      "readings.id < 30", "25 <= readings.id", "readings.id != 7", "readings.big >= 20000 AND readings.big < 41000",
+      "readings.level > 4.5 OR readings.level = 1", "readings.day = \"2024-01-05\"", "readings.at > \"2024-01-10 03:00:00\"",
+      "readings.sensor = \"s1\" AND readings.id > 10 OR readings.sensor >= \"s3\"", "readings.note = \"note3\"",
+      "readings.note > \"b\"", "readings.site = \"site2\" AND readings.id < 40", "(readings.id < 10 OR readings.id > 50) AND readings.sensor != \"s0\"",
+      "readings.id = readings.id AND 1 = 1",
+    };
+    for (auto& where : whereClauses) {
+      Parser parser("SELECT * FROM readings WHERE " + where + ";");
+      auto query = parser.parseQuery();
+      auto& predicate = *query.predicate.at(0);
+      predicate.bind(schema);
+      PredicateProgram program(predicate, schema);
+
+      u32 matches = 0;
+      TableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        auto row = scan.getView();
+        bool expected = predicate.evaluate(row, schema);
+        REQUIRE(program.evaluate(row) == expected);
+        matches += expected;
+      }
+      INFO(where);
+      REQUIRE(matches > 0);
+    }
+
+    // typed instructions for fixed width, date and string columns, the rest evaluates its term
+    auto compile = [&](std::string where) {
+      Parser parser("SELECT * FROM readings WHERE " + where + ";");
+      auto query = parser.parseQuery();
+      query.predicate.at(0)->bind(schema);
+      PredicateProgram program(*query.predicate.at(0), schema);
+      std::vector<PredicateProgram::Opcode> opcodes;
+      for (auto& instruction : program.getInstructions()) {
+        opcodes.push_back(instruction.opcode);
+      }
+      return opcodes;
+      };
+    using Opcode = PredicateProgram::Opcode;
+    REQUIRE(compile("5 < readings.id") == std::vector<Opcode>{ Opcode::I32_GT });
+    REQUIRE(compile("readings.at <= \"2024-01-10\" OR readings.level = 2") == std::vector<Opcode>{ Opcode::I64_LE, Opcode::JUMP_IF_TRUE, Opcode::F64_EQ });
+    REQUIRE(compile("readings.sensor = \"s1\" AND readings.site = \"site1\"") == std::vector<Opcode>{ Opcode::STR_EQ, Opcode::JUMP_IF_FALSE, Opcode::TERM });
+  }
+}
+
+TEST_CASE("Filter kernels agree with the scalar kernel") {
+  std::mt19937 random(7);
+  std::vector<TermOperand> ops{ TermOperand::EQUAL, TermOperand::NOT_EQUAL, TermOperand::LESS,
+    TermOperand::LESS_EQUAL, TermOperand::GREATER, TermOperand::GREATER_EQUAL };
+  // a few values so equality matches, the count ends in a partial word
+  const u32 count = 64 * 5 + 13;
+  std::vector<i32> ints(count);
+  std::vector<i64> bigs(count);
+  std::vector<double> reals(count);
+  for (u32 i = 0; i < count; ++i) {
+    ints[i] = (i32)(random() % 16) - 8;
+    bigs[i] = ((i64)(random() % 16) - 8) << 40;
+    reals[i] = ((double)(random() % 16) - 8) / 2;
+  }
+
+  for (auto isa : { FilterKernels::Isa::SSE4, FilterKernels::Isa::AVX2 }) {
+    if (!FilterKernels::isSupported(isa)) {
+      continue;
+    }
+    for (auto op : ops) {
+      for (auto type : { FilterKernels::Type::I32, FilterKernels::Type::I64, FilterKernels::Type::F64 }) {
+        FilterKernels::ColumnFilter filter{ 0, type, op, type == FilterKernels::Type::I64 ? (i64)3 << 40 : 3, 1.5 };
+        const char* values = type == FilterKernels::Type::I32 ? reinterpret_cast<const char*>(ints.data()) :
+          type == FilterKernels::Type::I64 ? reinterpret_cast<const char*>(bigs.data()) : reinterpret_cast<const char*>(reals.data());
+        // the second word starts empty and stays empty
+        std::vector<u64> expected(PaxPage::bitmapWords(count), ~u64(0));
+        expected[1] = 0;
+        std::vector<u64> selection = expected;
+        FilterKernels::apply(FilterKernels::Isa::SCALAR, filter, values, count, expected.data());
+        FilterKernels::apply(isa, filter, values, count, selection.data());
+        REQUIRE(selection == expected);
+        REQUIRE(selection[0] != 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("PAX pages are selected a column at a time") {
+  std::string fileName = "readings";
+  DeferDeleteFile deferDeleteFile({ fileName, HeapFile::overflowFilename(fileName) });
+  {
+    Schema schema;
+    schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+    schema.addField(fileName, "big", std::make_unique<ReadBigIntField>());
+    schema.addField(fileName, "level", std::make_unique<ReadDoubleField>());
+    schema.addField(fileName, "sensor", std::make_unique<ReadFixedCharField>(8));
+
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName, 8, 100, HeapFile::paxColumnsOf(schema));
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 500; ++i) {
+      std::vector<Token> tokens{ ttoken(i), Token{ NUMBER, 0, "", (i64)i * 3000000000 }, Token{ DECIMAL, 0, std::to_string(i % 10) + ".5" }, ttoken("s" + std::to_string(i % 4)) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, tuples);
+    // rows that were deleted are not selected
+    {
+      ModifyTableScan scan(fileName, rm, schema);
+      scan.getFirst();
+      while (scan.next()) {
+        if (scan.get().fields[0]->getConstant().num % 7 == 0) {
+          scan.deleteTuple();
+        }
+      }
+    }
+
+    std::vector<std::string> whereClauses{
+      "readings.id >= 100 AND readings.id < 300", "readings.big > 600000000000 AND readings.level <= 4.5",
+      "readings.id != 3 AND readings.sensor = \"s1\"", "readings.id < 20 OR readings.level = 9.5",
+    };
+    for (auto& where : whereClauses) {
+      Parser parser("SELECT * FROM readings WHERE " + where + ";");
+      auto query = parser.parseQuery();
+      auto& predicate = *query.predicate.at(0);
+      predicate.bind(schema);
+
+      std::vector<i64> expected;
+      TableScan tableScan(fileName, rm, schema);
+      tableScan.getFirst();
+      while (tableScan.next()) {
+        auto row = tableScan.getView();
+        if (predicate.evaluate(row, schema)) {
+          expected.push_back(row.getValue(0).getNumber());
+        }
+      }
+
+      std::vector<i64> selected;
+      SelectScan selectScan(std::make_unique<TableScan>(fileName, rm, schema), std::move(query.predicate.at(0)));
+      selectScan.getFirst();
+      while (selectScan.next()) {
+        selected.push_back(selectScan.getView().getValue(0).getNumber());
+      }
+      INFO(where);
+      REQUIRE(!expected.empty());
+      REQUIRE(selected == expected);
+    }
+  }
+}
+
+TEST_CASE("Terms of a WHERE clause are ordered by cost and selectivity") {
+  std::string fileName = "readings";
+  DeferDeleteFile deferDeleteFile({ fileName, HeapFile::overflowFilename(fileName) });
+  {
+    std::shared_ptr<ResourceManager> rm = std::make_shared<ResourceManager>(TEST_PAGE_SIZE, 10);
+    HeapFile::createHeapFile(*rm, fileName);
+
+    Schema schema;
+    schema.addField(fileName, "id", std::make_unique<ReadIntField>());
+    schema.addField(fileName, "big", std::make_unique<ReadBigIntField>());
+    schema.addField(fileName, "sensor", std::make_unique<ReadFixedCharField>(8));
+
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 100; ++i) {
+      std::vector<Token> tokens{ ttoken(i), ttoken(i * 1000), ttoken("s" + std::to_string(i % 4)) };
+      tuples.push_back(schema.createTuple(tokens));
+    }
+    HeapFile::insertTuples(rm, fileName, tuples);
+
+    using Opcode = PredicateProgram::Opcode;
+    auto opcodes = [](PredicateProgram& program) {
+      std::vector<Opcode> opcodes;
+      for (auto& instruction : program.getInstructions()) {
+        opcodes.push_back(instruction.opcode);
+      }
+      return opcodes;
+      };
+    // the order of the program before and after the rows are evaluated repeat times
+    auto evaluate = [&](std::string where, u32 repeat) {
+      Parser parser("SELECT * FROM readings WHERE " + where + ";");
+      auto query = parser.parseQuery();
+      auto& predicate = *query.predicate.at(0);
+      predicate.bind(schema);
+      PredicateProgram program(predicate, schema);
+      std::vector<Opcode> written = opcodes(program);
+      for (u32 i = 0; i < repeat; ++i) {
+        TableScan scan(fileName, rm, schema);
+        scan.getFirst();
+        while (scan.next()) {
+          auto row = scan.getView();
+          bool expected = predicate.evaluate(row, schema);
+          REQUIRE(program.evaluate(row) == expected);
+          // a row that is not in place evaluates the terms in the same order
+          TupleView copy(scan.get());
+          REQUIRE(program.evaluate(copy) == expected);
+        }
+      }
+      return std::make_pair(written, opcodes(program));
+      };
+
+    // integers before strings, an AND starts with the term most likely to fail and an OR with the one most likely to pass
+    REQUIRE(evaluate("readings.sensor != \"s9\" AND readings.id = 3", 0).first ==
+      std::vector<Opcode>{ Opcode::I32_EQ, Opcode::JUMP_IF_FALSE, Opcode::STR_NE });
+    REQUIRE(evaluate("readings.id = 3 OR readings.big != 5000", 0).first ==
+      std::vector<Opcode>{ Opcode::I64_NE, Opcode::JUMP_IF_TRUE, Opcode::I32_EQ });
+    // nested ANDs are one conjunction
+    REQUIRE(evaluate("(readings.sensor = \"s1\" AND readings.id > 5) AND readings.big = 7000", 0).first ==
+      std::vector<Opcode>{ Opcode::I64_EQ, Opcode::JUMP_IF_FALSE, Opcode::I32_GT, Opcode::JUMP_IF_FALSE, Opcode::STR_EQ });
+
+    // both ranges are estimated alike, the rows show that the second one fails far more often
+    auto [before, after] = evaluate("readings.id >= 2 AND readings.big < 3000", 30);
+    REQUIRE(before == std::vector<Opcode>{ Opcode::I32_GE, Opcode::JUMP_IF_FALSE, Opcode::I64_LT });
+    REQUIRE(after == std::vector<Opcode>{ Opcode::I64_LT, Opcode::JUMP_IF_FALSE, Opcode::I32_GE });
+    evaluate("readings.sensor = \"s2\" OR readings.id < 10 AND readings.big > 5000", 30);
+  }
+}
+
+TEST_CASE("Predicates are simplified before any row is read") {
+  Schema schema;
+  schema.addField("readings", "id", std::make_unique<ReadIntField>());
+  schema.addField("readings", "day", std::make_unique<ReadDateField>());
+  schema.addField("readings", "sensor", std::make_unique<ReadFixedCharField>(8));
+
+  auto parse = [&](std::string where) {
+    Parser parser("SELECT * FROM readings WHERE " + where + ";");
+    auto query = parser.parseQuery();
+    auto predicate = std::move(query.predicate.at(0));
+    predicate->bind(schema);
+    return predicate;
+    };
+  using Outcome = PredicateSimplifier::Outcome;
+  auto simplify = [&](std::string where) {
+    auto predicate = parse(where);
+    Outcome outcome = PredicateSimplifier(schema).simplify(predicate);
+    return std::make_pair(outcome, std::move(predicate));
+    };
+  // the predicate the where clause is simplified to
+  auto requireSimplified = [&](std::string where, std::string expected) {
+    INFO(where);
+    auto [outcome, predicate] = simplify(where);
+    REQUIRE(outcome == Outcome::FILTER);
+    REQUIRE(*predicate == *parse(expected));
+    };
+
+  // constants
+  REQUIRE(simplify("1 = 1").first == Outcome::ALWAYS_TRUE);
+  REQUIRE(simplify("\"a\" > \"b\"").first == Outcome::ALWAYS_FALSE);
+  REQUIRE(simplify("readings.id < 5 OR 2 >= 1").first == Outcome::ALWAYS_TRUE);
+  REQUIRE(simplify("readings.id < 5 AND 1 != 1").first == Outcome::ALWAYS_FALSE);
+  requireSimplified("1 = 1 AND readings.id < 5", "readings.id < 5");
+  requireSimplified("readings.id < 5 OR 1 = 2", "readings.id < 5");
+
+  // duplicates and bounds on one column
+  requireSimplified("readings.id = 1 AND readings.id = 1", "readings.id = 1");
+  requireSimplified("readings.sensor = \"s1\" OR readings.sensor = \"s1\"", "readings.sensor = \"s1\"");
+  requireSimplified("readings.id > 5 AND readings.id > 10", "readings.id > 10");
+  requireSimplified("readings.id >= 10 AND 1 = 1 AND readings.id > 10", "readings.id > 10");
+  requireSimplified("5 < readings.id AND readings.id >= 6", "readings.id >= 6");
+  requireSimplified("readings.id = 3 AND readings.id > 1 AND readings.id != 4 AND readings.id <= 3", "readings.id = 3");
+  requireSimplified("readings.id >= 2 AND readings.id <= 2", "readings.id >= 2 AND readings.id <= 2");
+  requireSimplified("readings.day > \"2024-01-02\" AND readings.day >= \"2024-01-05\"", "readings.day >= \"2024-01-05\"");
+  requireSimplified("(readings.id > 1 AND readings.id > 2) OR readings.sensor = \"s1\"", "readings.id > 2 OR readings.sensor = \"s1\"");
+  requireSimplified("readings.id > 1 AND (readings.sensor = \"s1\" AND readings.id < 9)", "readings.id > 1 AND readings.sensor = \"s1\" AND readings.id < 9");
+
+  // bounds no value satisfies
+  for (std::string where : { "readings.id > 10 AND readings.id < 5", "readings.id = 3 AND readings.id = 4", "readings.id = 3 AND readings.id != 3",
+    "readings.id > 2 AND readings.id <= 2", "readings.id = 1 AND readings.id >= 2", "readings.day = \"2024-01-05\" AND readings.day < \"2024-01-05\"",
+    "readings.sensor = \"s1\" AND (readings.id < 1 AND readings.id > 1)" }) {
+    INFO(where);
+    REQUIRE(simplify(where).first == Outcome::ALWAYS_FALSE);
+  }
+}
+
+// LIKE by backtracking, to check the matcher against
+static bool likeReference(std::string_view text, std::string_view pattern) {
+  if (pattern.empty()) {
+    return text.empty();
+  }
+  if (pattern[0] == '%') {
+    for (size_t i = 0; i <= text.size(); ++i) {
+      if (likeReference(text.substr(i), pattern.substr(1))) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return !text.empty() && (pattern[0] == '_' || pattern[0] == text[0]) && likeReference(text.substr(1), pattern.substr(1));
+}
+
+TEST_CASE("IN lists and LIKE patterns match without the predicate tree") {
+  std::vector<std::string> patterns{ "", "%", "%%", "abc", "ab%", "%bc", "%b%", "a_c", "_", "%_", "a%c", "a%b%c", "%a%a%",
+    "ab%ab", "_b%", "%c_", "a%%c", "%aa%", "__" };
+  std::vector<std::string> texts{ "", "a", "b", "ab", "abc", "aac", "abcabc", "abab", "aabbcc", "cab", "xabcx", "aaa", "ac", "abac" };
+  for (auto& pattern : patterns) {
+    LikePattern matcher(pattern);
+    for (auto& text : texts) {
+      INFO(text << " LIKE " << pattern);
+      REQUIRE(matcher.matches(text) == likeReference(text, pattern));
+    }
+  }
+
+  // short lists are searched, long ones hashed
+  for (u32 size : { 3u, ValueSet::SORTED_SIZE + 5 }) {
+    std::vector<i64> integers;
+    std::vector<double> reals;
+    std::vector<std::string> strings;
+    for (u32 i = 0; i < size; ++i) {
+      integers.push_back(i * 3);
+      reals.push_back(i * 1.5);
+      strings.push_back("v" + std::to_string(i * 3));
+    }
+    ValueSet integerSet, realSet, stringSet;
+    integerSet.assign(integers);
+    realSet.assign(reals);
+    stringSet.assign(strings);
+    for (u32 i = 0; i < size * 3 + 2; ++i) {
+      bool isMember = i % 3 == 0 && i < size * 3;
+      REQUIRE(integerSet.contains((i64)i) == isMember);
+      REQUIRE(realSet.contains(i * 0.5) == isMember);
+      REQUIRE(stringSet.contains(std::string_view("v" + std::to_string(i))) == isMember);
+    }
+  }
+}
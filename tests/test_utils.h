@@ -20,10 +20,10 @@ struct DeferDeleteFile {
 
 // convenience functions for creating tokens
 
-static Token ttoken(std::string lexeme) {
+inline Token ttoken(std::string lexeme) {
   return Token{ STRING, 0, lexeme };
 }
 
-static Token ttoken(int number) {
+inline Token ttoken(int number) {
   return Token{ NUMBER, 0, "", number };
 }
\ No newline at end of file